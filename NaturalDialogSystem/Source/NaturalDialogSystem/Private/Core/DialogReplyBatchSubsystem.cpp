@@ -0,0 +1,220 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Core/DialogReplyBatchSubsystem.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "FunctionalClasses/DialogReplyFunction.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+
+
+DEFINE_LOG_CATEGORY(LogDialogReplyBatchSubsystem);
+
+void UDialogReplyBatchSubsystem::Deinitialize()
+{
+	// Worker task reads matchers of player components
+	if (ActiveBatchTask.IsValid())
+	{
+		ActiveBatchTask.Wait();
+	}
+
+	ActiveBatch.Reset();
+	PendingRequests.Reset();
+
+	Super::Deinitialize();
+}
+
+void UDialogReplyBatchSubsystem::EnqueueReplyRequest(UPlayerNaturalDialogComponent* PlayerComponent, const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const FOnDialogReplyGenerated& OnReplyGenerated)
+{
+	check(IsInGameThread());
+
+	FBatchedReplyRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.PlayerComponent = PlayerComponent;
+	Request.NpcComponent = NpcNaturalDialogComponent;
+	Request.Input = Input;
+	Request.OnReplyGenerated = OnReplyGenerated;
+	Request.EnqueueTime = FPlatformTime::Seconds();
+}
+
+void UDialogReplyBatchSubsystem::CancelPlayerRequests(const UPlayerNaturalDialogComponent* PlayerComponent)
+{
+	check(IsInGameThread());
+
+	const TWeakObjectPtr<const UPlayerNaturalDialogComponent> WeakPlayerComponent(PlayerComponent);
+
+	for (int32 i = PendingRequests.Num() - 1; i >= 0; i--)
+	{
+		if (PendingRequests[i].PlayerComponent == WeakPlayerComponent)
+		{
+			const FOnDialogReplyGenerated OnReplyGenerated = PendingRequests[i].OnReplyGenerated;
+			PendingRequests.RemoveAt(i, 1, false);
+			OnReplyGenerated.ExecuteIfBound(TArray<FNaturalDialogAnswer>(), true);
+		}
+	}
+
+	// Matchers of active batch point to reply function and its objects, which can be collected after the player is removed
+	if (ActiveBatch.IsValid() && ActiveBatchTask.IsValid())
+	{
+		const bool bIsInActiveBatch = ActiveBatch->Requests.ContainsByPredicate([&WeakPlayerComponent](const FBatchedReplyRequest& Request)
+		{
+			return Request.PlayerComponent == WeakPlayerComponent;
+		});
+
+		if (bIsInActiveBatch)
+		{
+			ActiveBatchTask.Wait();
+		}
+	}
+}
+
+void UDialogReplyBatchSubsystem::Tick(float DeltaTime)
+{
+	if (PendingRequests.Num() > 0 && !ActiveBatch.IsValid())
+	{
+		StartBatch();
+	}
+}
+
+void UDialogReplyBatchSubsystem::StartBatch()
+{
+	const TSharedRef<FDialogReplyBatch, ESPMode::ThreadSafe> Batch = MakeShared<FDialogReplyBatch, ESPMode::ThreadSafe>();
+	Batch->Requests = MoveTemp(PendingRequests);
+	PendingRequests.Reset();
+
+	// Candidates of shareable matchers depend only on reply function class, sharing key of matcher and normalized words of sentence
+	TMap<FString, int32> QueryIds;
+
+	for (FBatchedReplyRequest& Request : Batch->Requests)
+	{
+		UPlayerNaturalDialogComponent* PlayerComponent = Request.PlayerComponent.Get();
+		const UNpcNaturalDialogComponent* NpcComponent = Request.NpcComponent.Get();
+
+		if (!PlayerComponent || !PlayerComponent->PrepareReplyGeneration(NpcComponent))
+		{
+			continue;
+		}
+
+		TSharedPtr<FDialogReplyMatcher, ESPMode::ThreadSafe> Matcher = PlayerComponent->ReplyFunctionInstance->CreateReplyMatcher(NpcComponent);
+		if (!Matcher.IsValid())
+		{
+			// Reply function doesn't support matching on worker thread, so the request is resolved right now
+			Request.OnReplyGenerated.ExecuteIfBound(PlayerComponent->GenerateDialogReply(Request.Input, NpcComponent), false);
+			Request.OnReplyGenerated.Unbind();
+			continue;
+		}
+
+		// Candidates, which depend on the player, are matched only by matcher of the player
+		FString SharingKey;
+		const bool bCanShare = Matcher->GetSharingKey(SharingKey);
+		const FString KeyPrefix = PlayerComponent->ReplyFunctionInstance->GetClass()->GetPathName() + TEXT("|") + SharingKey + TEXT("|");
+
+		Request.Sentences = UNaturalDialogSystemLibrary::SplitToSentences(Request.Input.ToString());
+		Request.SentenceQueries.Reserve(Request.Sentences.Num());
+
+		for (const FString& Sentence : Request.Sentences)
+		{
+			FString Key = KeyPrefix;
+			const FScopedNormalizedText Terms(Sentence);
+			Terms->JoinTo(Key, TEXT(' '));
+
+			const int32* QueryId = bCanShare ? QueryIds.Find(Key) : nullptr;
+			if (QueryId)
+			{
+				Request.SentenceQueries.Add(*QueryId);
+				continue;
+			}
+
+			FBatchedReplyQuery& Query = Batch->Queries.AddDefaulted_GetRef();
+			Query.Matcher = Matcher;
+			Query.Sentence = Sentence;
+			Request.SentenceQueries.Add(Batch->Queries.Num() - 1);
+
+			if (bCanShare)
+			{
+				QueryIds.Add(Key, Batch->Queries.Num() - 1);
+			}
+		}
+	}
+
+	ActiveBatch = Batch;
+
+	const TWeakObjectPtr<UDialogReplyBatchSubsystem> WeakThis(this);
+	ActiveBatchTask = Async(EAsyncExecution::ThreadPool, [Batch, WeakThis]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		// Every query writes only its own candidates
+		ParallelFor(Batch->Queries.Num(), [&Batch](const int32 QueryIndex)
+		{
+			FBatchedReplyQuery& Query = Batch->Queries[QueryIndex];
+			Query.Candidates = Query.Matcher->FindReplyCandidates(Query.Sentence);
+		});
+
+		Batch->MatchingTime = FPlatformTime::Seconds() - StartTime;
+
+		AsyncTask(ENamedThreads::GameThread, [Batch, WeakThis]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->FinishBatch(Batch);
+			}
+		});
+	});
+}
+
+void UDialogReplyBatchSubsystem::FinishBatch(const TSharedRef<FDialogReplyBatch, ESPMode::ThreadSafe>& Batch)
+{
+	const double FinishTime = FPlatformTime::Seconds();
+	double SumOfLatency = 0.0;
+	double MaxLatency = 0.0;
+	int32 NumOfSentences = 0;
+
+	for (const FBatchedReplyRequest& Request : Batch->Requests)
+	{
+		UPlayerNaturalDialogComponent* PlayerComponent = Request.PlayerComponent.Get();
+		const UNpcNaturalDialogComponent* NpcComponent = Request.NpcComponent.Get();
+
+		if (Request.OnReplyGenerated.IsBound())
+		{
+			TArray<FNaturalDialogAnswer> Answers;
+
+			if (PlayerComponent && NpcComponent)
+			{
+				TArray<TArray<FReplyData>> SentenceCandidates;
+				SentenceCandidates.Reserve(Request.SentenceQueries.Num());
+				for (const int32 QueryId : Request.SentenceQueries)
+				{
+					SentenceCandidates.Add(Batch->Queries[QueryId].Candidates);
+				}
+
+				// Metric values, tasks and table actions are applied by player component in sentence order
+				Answers = PlayerComponent->ResolveDialogReply(Request.Sentences, SentenceCandidates, NpcComponent);
+			}
+			else if (PlayerComponent)
+			{
+				Answers = PlayerComponent->ResolveDialogReply(TArray<FString>(), TArray<TArray<FReplyData>>(), NpcComponent);
+			}
+
+			Request.OnReplyGenerated.ExecuteIfBound(Answers, PlayerComponent == nullptr);
+		}
+
+		const double Latency = FinishTime - Request.EnqueueTime;
+		SumOfLatency += Latency;
+		MaxLatency = FMath::Max(MaxLatency, Latency);
+		NumOfSentences += Request.Sentences.Num();
+	}
+
+	Stats.NumOfRequests = Batch->Requests.Num();
+	Stats.NumOfSentences = NumOfSentences;
+	Stats.NumOfQueries = Batch->Queries.Num();
+	Stats.MatchingTime = Batch->MatchingTime;
+	Stats.AverageQueueLatency = Stats.NumOfRequests > 0 ? SumOfLatency / Stats.NumOfRequests : 0.f;
+	Stats.MaxQueueLatency = MaxLatency;
+	Stats.TotalRequests += Stats.NumOfRequests;
+	Stats.TotalBatches++;
+
+	UE_LOG(LogDialogReplyBatchSubsystem, Verbose, TEXT("Batch resolved %d requests (%d sentences, %d unique), matching %.2f ms, average latency %.2f ms, max latency %.2f ms"),
+	       Stats.NumOfRequests, Stats.NumOfSentences, Stats.NumOfQueries, Stats.MatchingTime * 1000.f, Stats.AverageQueueLatency * 1000.f, Stats.MaxQueueLatency * 1000.f);
+
+	ActiveBatch.Reset();
+}
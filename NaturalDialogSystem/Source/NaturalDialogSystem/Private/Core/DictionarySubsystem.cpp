@@ -1,236 +1,592 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "Core/DictionarySubsystem.h"
-#include "Module/NaturalDialogSystemSettings.h"
-#include "DefaultClasses/DefaultDictionaryPickerFunction.h"
-#include "DefaultClasses/DefaultDictionaryRepresentation.h"
-#include "DefaultClasses/LevenshteinDistanceFunction.h"
-#include "DefaultClasses/Tf_idf_PickerFunction.h"
-#include "FunctionalClasses/DictionaryWordPickerFunction.h"
-#include "Logging/MessageLog.h"
-#include "Misc/UObjectToken.h"
-#include "Resources/DictionaryRepresentation.h"
-#include "Resources/NaturalDialogSystemLibrary.h"
-#include "Resources/Resources.h"
-
-
-DEFINE_LOG_CATEGORY(LogDictSubsystem);
-
-void UDictionarySubsystem::Initialize(FSubsystemCollectionBase& Collection)
-{
-	Super::Initialize(Collection);
-
-	// Create an instance for string distance function, we will use it for words correction
-	const UNaturalDialogSystemSettings* Settings = GetDefault<UNaturalDialogSystemSettings>();
-
-	// DICTIONARY REPRESENTATION ----------------------------------------------------------------------------------------------------------------------------------
-
-	// Create dictionary representation object instance
-	const TSubclassOf<UDictionaryRepresentation> DictRepresentationClass = Settings->GetDictionaryRepresentationClass();
-	if (DictRepresentationClass)
-	{
-		ConstructDictObject(DictRepresentationClass);
-		UE_LOG(LogDictSubsystem, Log, TEXT("For dictionary representation is used %s class"), *DictRepresentationClass->GetName());
-	}
-	else
-	{
-		UClass* DefaultClass = UDefaultDictionaryRepresentation::StaticClass();
-		ConstructDictObject(DefaultClass);
-		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
-	}
-
-	// DICTIONARY WORD PICKER ----------------------------------------------------------------------------------------------------------------------------------
-
-	// Create dictionary word picker instance
-	const TSubclassOf<UDictionaryWordPickerFunction> DictionaryWordPickerClass = Settings->GetDictionaryWordPickerFunctionClass();
-	if (DictionaryWordPickerClass)
-	{
-		ConstructDictionaryWordPickerFunctionObject(DictionaryWordPickerClass);
-		UE_LOG(LogDictSubsystem, Log, TEXT("For string distance function was used %s class"), *DictionaryWordPickerClass->GetName());
-	}
-	else
-	{
-		UClass* DefaultClass = UDefaultDictionaryPickerFunction::StaticClass();
-		ConstructDictionaryWordPickerFunctionObject(DefaultClass);
-		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
-	}
-
-	// KEYWORD PICKER ----------------------------------------------------------------------------------------------------------------------------------
-
-	// Create keyword picker function instance
-	const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass = Settings->GetKeywordPickerFunctionClass();
-	if (KeywordPickerClass)
-	{
-		ConstructKeywordPickerObject(KeywordPickerClass);
-		UE_LOG(LogDictSubsystem, Log, TEXT("For keyword picker was used %s class"), *KeywordPickerClass->GetName());
-	}
-	else
-	{
-		UClass* DefaultClass = UTf_idf_PickerFunction::StaticClass();
-		ConstructKeywordPickerObject(DefaultClass);
-		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
-	}
-
-	// OTHER ----------------------------------------------------------------------------------------------------------------------------------
-
-	// Cache all dialog tables to subsystem after game start
-	GameNaturalDialogTables = UNaturalDialogSystemLibrary::GetListOfDialogDataTables();
-	FDictionaryData::ResetNumOfWords();
-
-	// Iterate all tables and register all words from them
-	for (const UDataTable* Table : GameNaturalDialogTables)
-	{
-		RegisterWordsFromTable(Table);
-	}
-}
-
-void UDictionarySubsystem::Deinitialize()
-{
-	Super::Deinitialize();
-
-#if WITH_EDITOR
-
-	const UNaturalDialogSystemSettings* Settings = GetDefault<UNaturalDialogSystemSettings>();
-
-	FMessageLog Log = FMessageLog(TEXT("PIE"));
-
-	if (!Settings->GetDictionaryRepresentationClass())
-	{
-		const FString Warning = TEXT("Natural dialog system: Set DictionaryRepresentation class in project settings");
-		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
-	}
-
-	if (!Settings->GetDictionaryWordPickerFunctionClass())
-	{
-		const FString Warning = TEXT("Natural dialog system: Set StringDistanceFunction class in project settings");
-		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
-	}
-
-	if (!Settings->GetKeywordPickerFunctionClass())
-	{
-		const FString Warning = TEXT("Natural dialog system: Set KeywordPickerFunction class in project settings");
-		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
-	}
-
-	Log.Open(EMessageSeverity::Info);
-
-#endif
-}
-
-TArray<FString> UDictionarySubsystem::GenerateKeywords(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText)
-{
-	TArray<FString> Result;
-
-	if (!DictionaryWordPickerFunctionInstance)
-	{
-		UClass* DefaultClass = ULevenshteinDistanceFunction::StaticClass();
-		ConstructDictionaryWordPickerFunctionObject(DefaultClass);
-		UE_LOG(LogDictSubsystem, Warning, TEXT("Strig metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
-	}
-
-	if (!KeywordPickerFunctionInstance)
-	{
-		UClass* DefaultClass = UTf_idf_PickerFunction::StaticClass();
-		ConstructKeywordPickerObject(DefaultClass);
-		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
-	}
-
-	TArray<FString> FixedWords;
-	for (const FString& InputWord : UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(InputText))
-	{
-		const FString FixedWord = DictionaryWordPickerFunctionInstance->PickWordFromDictionary(InputWord);
-		if (FixedWord.Len() > 0)
-		{
-			FixedWords.Add(FixedWord);
-			UE_LOG(LogDictSubsystem, Log, TEXT("Word (%s) was fixed to (%s)"), *InputWord, *FixedWord);
-		}
-		else
-		{
-			UE_LOG(LogDictSubsystem, Warning, TEXT("Word (%s) was not recognized"), *InputWord);
-		}
-	}
-
-	// The result array of keywords
-	const TArray<FString> PickedKeyWords = KeywordPickerFunctionInstance->PickKeyWords(DialogComponent, FixedWords);
-	return PickedKeyWords;
-}
-
-void UDictionarySubsystem::ConstructDictObject(const TSubclassOf<UDictionaryRepresentation> DictClass)
-{
-	DictionaryData = NewObject<UDictionaryRepresentation>(this, DictClass);
-	DictionaryData->InitializeDictionary();
-
-	// Check if instance has overriden abstract function
-	DictionaryData->RegisterWord(TEXT(""), nullptr);
-}
-
-void UDictionarySubsystem::ConstructKeywordPickerObject(const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass)
-{
-	KeywordPickerFunctionInstance = NewObject<UKeywordPickerFunction>(this, KeywordPickerClass);
-	KeywordPickerFunctionInstance->InitializeKeywordPicker();
-
-	// Check if instance has overriden abstract function
-	KeywordPickerFunctionInstance->PickKeyWords(nullptr, TArray<FString>());
-}
-
-void UDictionarySubsystem::ConstructDictionaryWordPickerFunctionObject(const TSubclassOf<UDictionaryWordPickerFunction> StringFunctionClass)
-{
-	DictionaryWordPickerFunctionInstance = NewObject<UDictionaryWordPickerFunction>(this, StringFunctionClass);
-	DictionaryWordPickerFunctionInstance->InitializeWordPicker();
-
-	// Check if instance has overriden abstract function
-	DictionaryWordPickerFunctionInstance->PickWordFromDictionary(TEXT(""));
-}
-
-void UDictionarySubsystem::RegisterWordsFromTable(const UDataTable* InTable)
-{
-	if (ensure(InTable))
-	{
-		if (!ensure(DictionaryData))
-		{
-			ConstructDictObject(UDefaultDictionaryRepresentation::StaticClass());
-		}
-
-		// Iterate all rows from table and register all words into system
-		if (InTable->GetRowStruct()->IsChildOf(FNaturalDialogRow_Keyword::StaticStruct()))
-		{
-			InTable->ForeachRow<FNaturalDialogRow_Keyword>(TEXT("Words registration"), [=](const FName& Key, const FNaturalDialogRow_Keyword& Value)
-			{
-				TArray<FString> AllWords = UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(Value.Ask.ToString());
-				
-				for(int32 i = 0 ; i < Value.Answer.Num() ; i++)
-				{
-					AllWords.Append(UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(Value.Answer[i].Answer.ToString()));
-				}
-				
-				for(const FText& Keyword : Value.Keywords)
-				{
-					AllWords.Add(UNaturalDialogSystemLibrary::NormalizeTerm(Keyword.ToString()));
-				}
-			
-				for (const FString& Word : AllWords)
-				{
-					DictionaryData->RegisterWord(Word, InTable);
-				}
-			});
-		}
-		else
-		{
-			InTable->ForeachRow<FNaturalDialogRow>(TEXT("Words registration"), [=](const FName& Key, const FNaturalDialogRow& Value)
-			{
-				TArray<FString> AllWords = UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(Value.Ask.ToString());
-
-				for(int32 i = 0 ; i < Value.Answer.Num() ; i++)
-				{
-					AllWords.Append(UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(Value.Answer[i].Answer.ToString()));
-				}
-			
-				for (const FString& Word : AllWords)
-				{
-					DictionaryData->RegisterWord(Word, InTable);
-				}
-			});
-		}
-	}
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Core/DictionarySubsystem.h"
+#include "Async/Async.h"
+#include "HAL/ThreadSingleton.h"
+#include "Module/NaturalDialogSystemSettings.h"
+#include "DefaultClasses/DefaultDictionaryPickerFunction.h"
+#include "DefaultClasses/DefaultDictionaryRepresentation.h"
+#include "DefaultClasses/Tf_idf_PickerFunction.h"
+#include "Engine/GameInstance.h"
+#include "FunctionalClasses/DictionaryWordPickerFunction.h"
+#include "Logging/MessageLog.h"
+#include "Misc/UObjectToken.h"
+#include "Resources/DictionaryIndex.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+#include "Resources/Resources.h"
+
+
+DEFINE_LOG_CATEGORY(LogDictSubsystem);
+
+/** Key of word correction memo is built in buffer of the current thread, so lookup doesn't allocate memory */
+struct FWordCorrectionKeyBuffer : TThreadSingleton<FWordCorrectionKeyBuffer>
+{
+	FString Key;
+};
+
+void UDictionarySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Create an instance for string distance function, we will use it for words correction
+	const UNaturalDialogSystemSettings* Settings = GetDefault<UNaturalDialogSystemSettings>();
+
+	// DICTIONARY REPRESENTATION ----------------------------------------------------------------------------------------------------------------------------------
+
+	// Select dictionary representation class, object instance is created for every dictionary snapshot
+	TSubclassOf<UDictionaryRepresentation> DictRepresentationClass = Settings->GetDictionaryRepresentationClass();
+	if (DictRepresentationClass)
+	{
+		UE_LOG(LogDictSubsystem, Log, TEXT("For dictionary representation is used %s class"), *DictRepresentationClass->GetName());
+	}
+	else
+	{
+		DictRepresentationClass = UDefaultDictionaryRepresentation::StaticClass();
+		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DictRepresentationClass->GetName());
+	}
+
+	// DICTIONARY WORD PICKER ----------------------------------------------------------------------------------------------------------------------------------
+
+	// Create dictionary word picker instance
+	const TSubclassOf<UDictionaryWordPickerFunction> DictionaryWordPickerClass = Settings->GetDictionaryWordPickerFunctionClass();
+	if (DictionaryWordPickerClass)
+	{
+		ConstructDictionaryWordPickerFunctionObject(DictionaryWordPickerClass);
+		UE_LOG(LogDictSubsystem, Log, TEXT("For string distance function was used %s class"), *DictionaryWordPickerClass->GetName());
+	}
+	else
+	{
+		UClass* DefaultClass = UDefaultDictionaryPickerFunction::StaticClass();
+		ConstructDictionaryWordPickerFunctionObject(DefaultClass);
+		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
+	}
+
+	// KEYWORD PICKER ----------------------------------------------------------------------------------------------------------------------------------
+
+	// Create keyword picker function instance
+	const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass = Settings->GetKeywordPickerFunctionClass();
+	if (KeywordPickerClass)
+	{
+		ConstructKeywordPickerObject(KeywordPickerClass);
+		UE_LOG(LogDictSubsystem, Log, TEXT("For keyword picker was used %s class"), *KeywordPickerClass->GetName());
+	}
+	else
+	{
+		UClass* DefaultClass = UTf_idf_PickerFunction::StaticClass();
+		ConstructKeywordPickerObject(DefaultClass);
+		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
+	}
+
+	// OTHER ----------------------------------------------------------------------------------------------------------------------------------
+
+	// Corrections are cached only if capacity is set
+	WordCorrections.Empty(Settings->GetWordCorrectionCacheCapacity());
+	WordCorrectionsSize = 0;
+	WordCorrectionsVersion = 0;
+	NumOfCorrectionHits = 0;
+	NumOfCorrectionMisses = 0;
+
+	// Cache all dialog tables to subsystem after game start
+	int32 NumOfScannedAssets = 0;
+	int32 NumOfLoadedAssets = 0;
+	GameNaturalDialogTables = UNaturalDialogSystemLibrary::GetListOfDialogDataTables(NumOfScannedAssets, NumOfLoadedAssets);
+	UE_LOG(LogDictSubsystem, Log, TEXT("Dialog tables discovery scanned %d data table assets, loaded %d assets, found %d dialog tables"), NumOfScannedAssets, NumOfLoadedAssets, GameNaturalDialogTables.Num());
+
+	// Try to load dictionary from prebuilt index, it is valid only if dialog tables have not changed since index build
+	const TArray<const UDataTable*> SortedTables = FDictionaryIndex::GetSortedTables(GameNaturalDialogTables);
+
+	// Cooked tables are packaged together with the index, so cooked game doesn't read all texts at startup to check it
+	TOptional<uint32> ContentHash;
+	if (Settings->GetUsePrebuiltDictionary() && !FPlatformProperties::RequiresCookedData())
+	{
+		ContentHash = FDictionaryIndex::ComputeContentHash(SortedTables);
+	}
+
+	TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe> NewSnapshot = CreateSnapshot(DictRepresentationClass, nullptr);
+
+	if (Settings->GetUsePrebuiltDictionary() && FDictionaryIndex::Load(Settings->GetPrebuiltDictionaryFilePath(), *NewSnapshot, SortedTables, ContentHash))
+	{
+		UE_LOG(LogDictSubsystem, Log, TEXT("Dictionary was loaded from prebuilt index %s"), *Settings->GetPrebuiltDictionaryFilePath());
+	}
+	else
+	{
+		// Index could partially fill the dictionary, so we start with a clean one
+		if (Settings->GetUsePrebuiltDictionary())
+		{
+			SnapshotDictionaries.Remove(NewSnapshot->Dictionary);
+			NewSnapshot = CreateSnapshot(DictRepresentationClass, nullptr);
+		}
+
+		// Iterate all tables and register all words from them
+		for (const UDataTable* Table : GameNaturalDialogTables)
+		{
+			NewSnapshot->RegisterWordsFromTable(Table);
+		}
+
+#if WITH_EDITOR
+
+		// Rebuild outdated index, so next game session can use it
+		if (Settings->GetUsePrebuiltDictionary())
+		{
+			FDictionaryIndex::Save(Settings->GetPrebuiltDictionaryFilePath(), *NewSnapshot, SortedTables, ContentHash.IsSet() ? ContentHash.GetValue() : FDictionaryIndex::ComputeContentHash(SortedTables));
+		}
+
+#endif
+	}
+
+	NewSnapshot->FinishBuild();
+	PublishSnapshot(NewSnapshot);
+}
+
+void UDictionarySubsystem::Deinitialize()
+{
+	// Worker task fills dictionary object of this subsystem
+	if (DictionaryUpdateTask.IsValid())
+	{
+		DictionaryUpdateTask.Wait();
+	}
+
+	if (GetGameInstance())
+	{
+		GetGameInstance()->GetTimerManager().ClearTimer(RetiredSnapshotsHandle);
+	}
+
+	Super::Deinitialize();
+
+#if WITH_EDITOR
+
+	const UNaturalDialogSystemSettings* Settings = GetDefault<UNaturalDialogSystemSettings>();
+
+	FMessageLog Log = FMessageLog(TEXT("PIE"));
+
+	if (!Settings->GetDictionaryRepresentationClass())
+	{
+		const FString Warning = TEXT("Natural dialog system: Set DictionaryRepresentation class in project settings");
+		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
+	}
+
+	if (!Settings->GetDictionaryWordPickerFunctionClass())
+	{
+		const FString Warning = TEXT("Natural dialog system: Set StringDistanceFunction class in project settings");
+		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
+	}
+
+	if (!Settings->GetKeywordPickerFunctionClass())
+	{
+		const FString Warning = TEXT("Natural dialog system: Set KeywordPickerFunction class in project settings");
+		Log.SuppressLoggingToOutputLog().Warning()->AddToken(FUObjectToken::Create(this))->AddToken(FTextToken::Create(FText::AsCultureInvariant(Warning)));
+	}
+
+	Log.Open(EMessageSeverity::Info);
+
+#endif
+}
+
+TArray<FString> UDictionarySubsystem::GenerateKeywords(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText)
+{
+	TArray<FString> Result;
+
+	const TArray<uint32> KeywordTerms = GenerateKeywordTerms(DialogComponent, InputText);
+	const FDictionarySnapshotPtr Snapshot = GetSnapshot();
+
+	if (Snapshot.IsValid())
+	{
+		for (const uint32 TermId : KeywordTerms)
+		{
+			Result.Add(Snapshot->TermTable.GetTerm(TermId));
+		}
+	}
+
+	return Result;
+}
+
+FDictionarySnapshotPtr UDictionarySubsystem::GetSnapshot() const
+{
+	// Lock guards only copy of the pointer, snapshot data are read without locks
+	FRWScopeLock Lock(SnapshotLock, SLT_ReadOnly);
+	return CurrentSnapshot;
+}
+
+void UDictionarySubsystem::AddDialogTables(const TArray<UDataTable*>& InTables)
+{
+	for (UDataTable* Table : InTables)
+	{
+		AddDialogTable(Table);
+	}
+}
+
+void UDictionarySubsystem::AddDialogTable(UDataTable* InTable)
+{
+	check(IsInGameThread());
+
+	if (InTable && !GameNaturalDialogTables.Contains(InTable))
+	{
+		GameNaturalDialogTables.Add(InTable);
+		QueueTableUpdate(InTable, false);
+		StartDictionaryUpdate();
+	}
+}
+
+void UDictionarySubsystem::RemoveDialogTable(UDataTable* InTable)
+{
+	check(IsInGameThread());
+
+	if (InTable && GameNaturalDialogTables.Remove(InTable) > 0)
+	{
+		QueueTableUpdate(InTable, true);
+		StartDictionaryUpdate();
+	}
+}
+
+void UDictionarySubsystem::EnsureFunctionInstances()
+{
+	check(IsInGameThread());
+
+	if (!DictionaryWordPickerFunctionInstance)
+	{
+		UClass* DefaultClass = UDefaultDictionaryPickerFunction::StaticClass();
+		ConstructDictionaryWordPickerFunctionObject(DefaultClass);
+		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
+	}
+
+	if (!KeywordPickerFunctionInstance)
+	{
+		UClass* DefaultClass = UTf_idf_PickerFunction::StaticClass();
+		ConstructKeywordPickerObject(DefaultClass);
+		UE_LOG(LogDictSubsystem, Warning, TEXT("String metric function is not set in project settings, using default %s"), *DefaultClass->GetName());
+	}
+}
+
+bool UDictionarySubsystem::IsKeywordPickingPlayerIndependent() const
+{
+	return KeywordPickerFunctionInstance && KeywordPickerFunctionInstance->IsPlayerIndependent();
+}
+
+TArray<uint32> UDictionarySubsystem::GenerateKeywordTerms(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText)
+{
+	// Function instances are created on game thread, worker threads expect them to be valid
+	if (IsInGameThread())
+	{
+		EnsureFunctionInstances();
+	}
+
+	// The same snapshot is used for whole sentence, even if new one is published in the meantime
+	const FDictionarySnapshotPtr Snapshot = GetSnapshot();
+	if (!Snapshot.IsValid())
+	{
+		UE_LOG(LogDictSubsystem, Error, TEXT("Dictionary is not built yet"));
+		return TArray<uint32>();
+	}
+
+	const FScopedNormalizedText InputWords(InputText);
+
+	TArray<uint32> FixedTerms;
+	FixedTerms.Reserve(InputWords->Num());
+
+	FString FixedWord;
+	for (int32 i = 0; i < InputWords->Num(); i++)
+	{
+		const FStringView InputWord = InputWords->GetWord(i);
+		CorrectWord(InputWord, FixedWord);
+
+		const uint32 TermId = FixedWord.Len() > 0 ? Snapshot->TermTable.Find(FixedWord) : INVALID_TERM_ID;
+		if (TermId != INVALID_TERM_ID)
+		{
+			FixedTerms.Add(TermId);
+			UE_LOG(LogDictSubsystem, Verbose, TEXT("Word (%.*s) was fixed to (%s)"), InputWord.Len(), InputWord.GetData(), *FixedWord);
+		}
+		else
+		{
+			// Logged for every word on worker threads too, so only verbose and without copy of word
+			UE_LOG(LogDictSubsystem, Verbose, TEXT("Word (%.*s) was not recognized"), InputWord.Len(), InputWord.GetData());
+		}
+	}
+
+	// The result array of keywords
+	return KeywordPickerFunctionInstance->PickKeyTerms(DialogComponent, FixedTerms);
+}
+
+FString UDictionarySubsystem::CorrectWord(const FString& NormalizedWord) const
+{
+	FString FixedWord;
+	CorrectWord(NormalizedWord, FixedWord);
+	return FixedWord;
+}
+
+void UDictionarySubsystem::CorrectWord(const FStringView& NormalizedWord, FString& OutFixedWord) const
+{
+	OutFixedWord.Reset();
+
+	if (!DictionaryWordPickerFunctionInstance)
+	{
+		return;
+	}
+
+	FString& Key = FWordCorrectionKeyBuffer::Get().Key;
+	Key.Reset();
+	Key.AppendChars(NormalizedWord.GetData(), NormalizedWord.Len());
+
+	if (WordCorrections.Max() == 0)
+	{
+		OutFixedWord.Append(DictionaryWordPickerFunctionInstance->PickWordFromDictionary(Key));
+		return;
+	}
+
+	{
+		FScopeLock Lock(&WordCorrectionsLock);
+
+		if (const FWordCorrection* CachedCorrection = WordCorrections.FindAndTouch(Key))
+		{
+			NumOfCorrectionHits++;
+			OutFixedWord.Append(CachedCorrection->Word);
+			return;
+		}
+
+		NumOfCorrectionMisses++;
+	}
+
+	// Word picker searches the current snapshot, so its version is taken before the search
+	const FDictionarySnapshotPtr Snapshot = GetSnapshot();
+	const FString FixedWord = DictionaryWordPickerFunctionInstance->PickWordFromDictionary(Key);
+
+	{
+		FScopeLock Lock(&WordCorrectionsLock);
+
+		// Other thread could correct the same word meanwhile
+		if (Snapshot.IsValid() && Snapshot->Version == WordCorrectionsVersion && !WordCorrections.Contains(Key))
+		{
+			// Cache entry holds key, value and links of recency list, lookup set holds pointer to entry with hash links
+			constexpr int32 EntryOverhead = sizeof(FString) + sizeof(FWordCorrection) + sizeof(void*) * 3 + sizeof(int32) * 2;
+
+			FWordCorrection Correction;
+			Correction.Word = FixedWord;
+			Correction.EntrySize = EntryOverhead + (Key.Len() + 1) * sizeof(TCHAR) + Correction.Word.GetAllocatedSize();
+
+			// Evicted entry is removed here, so its size is known
+			if (WordCorrections.Num() == WordCorrections.Max())
+			{
+				WordCorrectionsSize -= WordCorrections.RemoveLeastRecent().EntrySize;
+			}
+
+			WordCorrectionsSize += Correction.EntrySize;
+			WordCorrections.Add(Key, MoveTemp(Correction));
+		}
+	}
+
+	OutFixedWord.Append(FixedWord);
+}
+
+FWordCorrectionCacheStats UDictionarySubsystem::GetWordCorrectionCacheStats() const
+{
+	FScopeLock Lock(&WordCorrectionsLock);
+
+	FWordCorrectionCacheStats Stats;
+	Stats.NumOfHits = NumOfCorrectionHits;
+	Stats.NumOfMisses = NumOfCorrectionMisses;
+	Stats.HitRate = NumOfCorrectionHits + NumOfCorrectionMisses > 0 ? static_cast<float>(NumOfCorrectionHits) / (NumOfCorrectionHits + NumOfCorrectionMisses) : 0.f;
+	Stats.NumOfEntries = WordCorrections.Num();
+	Stats.AllocatedSize = WordCorrectionsSize;
+
+	return Stats;
+}
+
+void UDictionarySubsystem::QueueTableUpdate(const UDataTable* InTable, const bool bIsRemoved)
+{
+	// Table is parsed on game thread, it is O(table size), so only the dictionary copy is left for worker thread
+	FDictionaryTableUpdate& Update = PendingTableUpdates.AddDefaulted_GetRef();
+	Update.Table = InTable;
+	Update.Words = UNaturalDialogSystemLibrary::GetTableTerms(InTable);
+	Update.bIsRemoved = bIsRemoved;
+
+	UE_LOG(LogDictSubsystem, Log, TEXT("Dialog table %s is queued for %s dictionary (%d words)"), *InTable->GetName(), bIsRemoved ? TEXT("removing from") : TEXT("adding into"), Update.Words.Num());
+}
+
+void UDictionarySubsystem::StartDictionaryUpdate()
+{
+	check(IsInGameThread());
+
+	if (bIsDictionaryUpdating || PendingTableUpdates.Num() == 0 || !CurrentSnapshot.IsValid() || !CurrentSnapshot->GetDictionary())
+	{
+		return;
+	}
+
+	// Only the dictionary object is created on game thread, terms and tables of current snapshot are copied on worker thread
+	const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe> NewSnapshot = CreateSnapshot(CurrentSnapshot->GetDictionary()->GetClass(), nullptr);
+	const FDictionarySnapshotPtr BaseSnapshot = CurrentSnapshot;
+	TArray<FDictionaryTableUpdate> Updates = MoveTemp(PendingTableUpdates);
+	PendingTableUpdates.Reset();
+
+	// Tables are referenced until the update is finished, so the worker can parse them again when dictionary is rebuilt
+	UpdatedTables = GameNaturalDialogTables.Array();
+	const TArray<const UDataTable*> Tables(UpdatedTables);
+	const bool bCanUpdateIncrementally = bSupportsIncrementalUpdate;
+
+	bIsDictionaryUpdating = true;
+
+	// Dictionary object of new snapshot is referenced by SnapshotDictionaries, so it is safe to fill it on worker thread
+	const TWeakObjectPtr<UDictionarySubsystem> WeakThis(this);
+	DictionaryUpdateTask = Async(EAsyncExecution::ThreadPool, [NewSnapshot, BaseSnapshot, Updates = MoveTemp(Updates), Tables, bCanUpdateIncrementally, WeakThis]()
+	{
+		// Terms and tables of current snapshot are kept, so already generated keyword ids are still valid
+		NewSnapshot->InitializeFrom(BaseSnapshot.Get());
+
+		// Copy of words data is O(dictionary size), but only words of changed tables are registered
+		bool bWasUpdated = bCanUpdateIncrementally && NewSnapshot->CopyDictionaryFrom(BaseSnapshot.Get());
+
+		for (int32 i = 0; i < Updates.Num() && bWasUpdated; i++)
+		{
+			if (Updates[i].bIsRemoved)
+			{
+				bWasUpdated = NewSnapshot->UnregisterTableTerms(Updates[i].Table, Updates[i].Words);
+			}
+			else
+			{
+				NewSnapshot->RegisterTableTerms(Updates[i].Table, Updates[i].Words);
+			}
+		}
+
+		// Representation without incremental update is built again from all current tables, the rebuild contains all applied updates too
+		if (!bWasUpdated)
+		{
+			NewSnapshot->InitializeFrom(BaseSnapshot.Get());
+			NewSnapshot->Dictionary->InitializeDictionary();
+
+			for (const UDataTable* Table : Tables)
+			{
+				NewSnapshot->RegisterWordsFromTable(Table);
+			}
+		}
+
+		// Counts of terms are updated only for words of changed tables, but all tables and words dividers are changed
+		NewSnapshot->FinishBuild();
+
+		AsyncTask(ENamedThreads::GameThread, [NewSnapshot, bWasUpdated, WeakThis]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->FinishDictionaryUpdate(NewSnapshot, bWasUpdated);
+			}
+		});
+	});
+}
+
+void UDictionarySubsystem::FinishDictionaryUpdate(const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe>& NewSnapshot, const bool bWasUpdated)
+{
+	check(IsInGameThread());
+
+	bIsDictionaryUpdating = false;
+	UpdatedTables.Reset();
+
+	// Next updates of the same representation go straight to rebuild, copy of dictionary would be wasted
+	if (!bWasUpdated && bSupportsIncrementalUpdate)
+	{
+		bSupportsIncrementalUpdate = false;
+		UE_LOG(LogDictSubsystem, Warning, TEXT("Dictionary representation %s doesn't support incremental update, all dialog tables are registered again"), *NewSnapshot->GetDictionary()->GetClass()->GetName());
+	}
+
+	PublishSnapshot(NewSnapshot);
+
+	// Queries of old snapshot could end while worker was updating
+	ReleaseRetiredSnapshots();
+
+	// Tables queued during update
+	StartDictionaryUpdate();
+}
+
+TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe> UDictionarySubsystem::CreateSnapshot(const TSubclassOf<UDictionaryRepresentation> DictClass, const FDictionarySnapshot* BaseSnapshot)
+{
+	const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FDictionarySnapshot, ESPMode::ThreadSafe>();
+	NewSnapshot->InitializeFrom(BaseSnapshot);
+
+	UDictionaryRepresentation* Dictionary = NewObject<UDictionaryRepresentation>(this, DictClass);
+	SnapshotDictionaries.Add(Dictionary);
+	NewSnapshot->BindDictionary(Dictionary);
+	Dictionary->InitializeDictionary();
+
+	// Check if instance has overriden abstract function
+	Dictionary->RegisterWord(TEXT(""), nullptr);
+
+	return NewSnapshot;
+}
+
+void UDictionarySubsystem::PublishSnapshot(const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe>& NewSnapshot)
+{
+	check(IsInGameThread());
+
+	FDictionarySnapshotPtr OldSnapshot;
+	{
+		FRWScopeLock Lock(SnapshotLock, SLT_Write);
+		OldSnapshot = CurrentSnapshot;
+		CurrentSnapshot = NewSnapshot;
+	}
+
+	// Words could be corrected to the new terms
+	{
+		FScopeLock Lock(&WordCorrectionsLock);
+		WordCorrections.Empty(WordCorrections.Max());
+		WordCorrectionsSize = 0;
+		WordCorrectionsVersion = NewSnapshot->Version;
+	}
+
+	if (OldSnapshot.IsValid())
+	{
+		RetiredSnapshots.Add(OldSnapshot);
+		OldSnapshot.Reset();
+	}
+
+	ReleaseRetiredSnapshots();
+
+	UE_LOG(LogDictSubsystem, Log, TEXT("Dictionary snapshot %u was published (%d terms, %d tables, %d words, dictionary uses %.1f KB)"), NewSnapshot->Version, NewSnapshot->TermTable.Num(), NewSnapshot->GetNumOfTables(), NewSnapshot->NumOfWords,
+	       NewSnapshot->Dictionary ? NewSnapshot->Dictionary->GetResourceSizeBytes(EResourceSizeMode::Exclusive) / 1024.f : 0.f);
+	OnSnapshotChanged.Broadcast(CurrentSnapshot);
+}
+
+void UDictionarySubsystem::ReleaseRetiredSnapshots()
+{
+	check(IsInGameThread());
+
+	// Dictionary object of retired snapshot can be released, when no query holds the snapshot
+	for (int32 i = RetiredSnapshots.Num() - 1; i >= 0; i--)
+	{
+		if (RetiredSnapshots[i].IsUnique())
+		{
+			SnapshotDictionaries.Remove(RetiredSnapshots[i]->Dictionary);
+			RetiredSnapshots.RemoveAtSwap(i);
+		}
+	}
+
+	// Long queries can hold snapshot after publish, so the rest is checked by timer until all snapshots are released
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		FTimerManager& TimerManager = GameInstance->GetTimerManager();
+
+		if (RetiredSnapshots.Num() == 0)
+		{
+			TimerManager.ClearTimer(RetiredSnapshotsHandle);
+		}
+		else if (!TimerManager.IsTimerActive(RetiredSnapshotsHandle))
+		{
+			TimerManager.SetTimer(RetiredSnapshotsHandle, this, &UDictionarySubsystem::ReleaseRetiredSnapshots, RetiredSnapshotsCheckInterval, true);
+		}
+	}
+}
+
+void UDictionarySubsystem::ConstructKeywordPickerObject(const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass)
+{
+	KeywordPickerFunctionInstance = NewObject<UKeywordPickerFunction>(this, KeywordPickerClass);
+	KeywordPickerFunctionInstance->InitializeKeywordPicker();
+
+	// Check if instance has overriden abstract function
+	KeywordPickerFunctionInstance->PickKeyWords(nullptr, TArray<FString>());
+}
+
+void UDictionarySubsystem::ConstructDictionaryWordPickerFunctionObject(const TSubclassOf<UDictionaryWordPickerFunction> StringFunctionClass)
+{
+	DictionaryWordPickerFunctionInstance = NewObject<UDictionaryWordPickerFunction>(this, StringFunctionClass);
+	DictionaryWordPickerFunctionInstance->InitializeWordPicker();
+
+	// Check if instance has overriden abstract function
+	DictionaryWordPickerFunctionInstance->PickWordFromDictionary(TEXT(""));
+}
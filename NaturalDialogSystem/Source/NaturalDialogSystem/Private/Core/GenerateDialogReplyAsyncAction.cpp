@@ -0,0 +1,46 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Core/GenerateDialogReplyAsyncAction.h"
+#include "Core/PlayerNaturalDialogComponent.h"
+
+UGenerateDialogReplyAsyncAction* UGenerateDialogReplyAsyncAction::GenerateDialogReplyAsync(UPlayerNaturalDialogComponent* PlayerNaturalDialogComponent, const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent)
+{
+	UGenerateDialogReplyAsyncAction* Action = NewObject<UGenerateDialogReplyAsyncAction>();
+	Action->PlayerNaturalDialogComponent = PlayerNaturalDialogComponent;
+	Action->NpcNaturalDialogComponent = NpcNaturalDialogComponent;
+	Action->Input = Input;
+
+	if (PlayerNaturalDialogComponent)
+	{
+		Action->RegisterWithGameInstance(PlayerNaturalDialogComponent);
+	}
+
+	return Action;
+}
+
+void UGenerateDialogReplyAsyncAction::Activate()
+{
+	if (!PlayerNaturalDialogComponent)
+	{
+		UE_LOG(LogPlayerNaturalDialogComponent, Error, TEXT("Invalid player component for async dialog reply"));
+		HandleReplyGenerated(TArray<FNaturalDialogAnswer>(), true);
+		return;
+	}
+
+	PlayerNaturalDialogComponent->GenerateDialogReplyAsync(Input, NpcNaturalDialogComponent, FOnDialogReplyGenerated::CreateUObject(this, &UGenerateDialogReplyAsyncAction::HandleReplyGenerated));
+}
+
+void UGenerateDialogReplyAsyncAction::HandleReplyGenerated(const TArray<FNaturalDialogAnswer>& Answers, const bool bWasCancelled)
+{
+	if (bWasCancelled)
+	{
+		OnCancelled.Broadcast(Answers);
+	}
+	else
+	{
+		OnCompleted.Broadcast(Answers);
+	}
+
+	SetReadyToDestroy();
+}
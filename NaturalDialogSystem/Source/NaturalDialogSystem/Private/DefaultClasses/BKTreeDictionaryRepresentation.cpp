@@ -0,0 +1,203 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/BKTreeDictionaryRepresentation.h"
+#include "DefaultClasses/BitParallelLevenshteinDistanceFunction.h"
+
+
+void UBKTreeDictionaryRepresentation::InitializeDictionary()
+{
+	Super::InitializeDictionary();
+
+	Nodes.Reset();
+}
+
+void UBKTreeDictionaryRepresentation::RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	const bool bIsNewWord = Word.Len() > 0 && !GetWordData(Word);
+
+	Super::RegisterTerm(Word, TermId, FromDataTable);
+
+	// Only unique words are in the tree, occurences are stored in buckets
+	if (bIsNewWord)
+	{
+		InsertNode(Word);
+	}
+}
+
+bool UBKTreeDictionaryRepresentation::UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	Super::UnregisterTerm(Word, TermId, FromDataTable);
+
+	// Tree can't remove node without rebuild of its subtree, so the node is only marked
+	if (Word.Len() > 0 && !GetWordData(Word))
+	{
+		const int32 NodeIndex = FindNode(Word);
+		if (NodeIndex != INDEX_NONE)
+		{
+			Nodes[NodeIndex].bIsRemoved = true;
+		}
+	}
+
+	return true;
+}
+
+bool UBKTreeDictionaryRepresentation::CopyDictionary(const UDictionaryRepresentation* Other)
+{
+	if (!Super::CopyDictionary(Other))
+	{
+		return false;
+	}
+
+	Nodes = CastChecked<UBKTreeDictionaryRepresentation>(Other)->Nodes;
+	return true;
+}
+
+bool UBKTreeDictionaryRepresentation::FindNearestWord(const FString& Word, const int32 MaxDistance, FString& OutWord, int32& OutDistance) const
+{
+	if (Nodes.Num() == 0 || Word.Len() == 0)
+	{
+		return false;
+	}
+
+	int32 BestNode = INDEX_NONE;
+	int32 BestDistance = MaxDistance + 1;
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+
+	while (Stack.Num() > 0)
+	{
+		const int32 NodeIndex = Stack.Pop(false);
+		const FBKTreeNode& Node = Nodes[NodeIndex];
+
+		const int32 Distance = UBitParallelLevenshteinDistanceFunction::ComputeDistance(Word, Node.Word);
+		if (Distance < BestDistance && !Node.bIsRemoved)
+		{
+			BestNode = NodeIndex;
+			BestDistance = Distance;
+
+			if (Distance == 0)
+			{
+				break; // <==== End here, found correct word
+			}
+		}
+
+		// By triangle inequality, only children with distance in range <Distance - Bound, Distance + Bound> can be closer than found word
+		const int32 Bound = FMath::Min(BestDistance - 1, MaxDistance);
+		for (int32 Child = Node.FirstChild; Child != INDEX_NONE; Child = Nodes[Child].NextSibling)
+		{
+			if (FMath::Abs(Nodes[Child].ParentDistance - Distance) <= Bound)
+			{
+				Stack.Add(Child);
+			}
+		}
+	}
+
+	if (BestNode != INDEX_NONE)
+	{
+		OutWord = Nodes[BestNode].Word;
+		OutDistance = BestDistance;
+		return true;
+	}
+
+	return false;
+}
+
+bool UBKTreeDictionaryRepresentation::SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const
+{
+	if (!Super::SaveDictionary(Ar, Tables))
+	{
+		return false;
+	}
+
+	// Tree is stored with dictionary, so it is not rebuilt at startup
+	Ar << const_cast<TArray<FBKTreeNode>&>(Nodes);
+	return !Ar.IsError();
+}
+
+bool UBKTreeDictionaryRepresentation::LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables)
+{
+	if (!Super::LoadDictionary(Ar, Tables))
+	{
+		return false;
+	}
+
+	Ar << Nodes;
+	return !Ar.IsError();
+}
+
+void UBKTreeDictionaryRepresentation::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T AllocatedSize = Nodes.GetAllocatedSize();
+	for (const FBKTreeNode& Node : Nodes)
+	{
+		AllocatedSize += Node.Word.GetAllocatedSize();
+	}
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(AllocatedSize);
+}
+
+void UBKTreeDictionaryRepresentation::InsertNode(const FString& Word)
+{
+	if (Nodes.Num() == 0)
+	{
+		Nodes.Emplace(Word, 0);
+		return;
+	}
+
+	int32 NodeIndex = 0;
+	while (true)
+	{
+		const int32 Distance = UBitParallelLevenshteinDistanceFunction::ComputeDistance(Word, Nodes[NodeIndex].Word);
+		if (Distance == 0)
+		{
+			Nodes[NodeIndex].bIsRemoved = false;
+			return;
+		}
+
+		// Find child with the same distance, we continue insertion in its subtree
+		int32 Child = Nodes[NodeIndex].FirstChild;
+		while (Child != INDEX_NONE && Nodes[Child].ParentDistance != Distance)
+		{
+			Child = Nodes[Child].NextSibling;
+		}
+
+		if (Child == INDEX_NONE)
+		{
+			const int32 NewIndex = Nodes.Emplace(Word, Distance);
+			Nodes[NewIndex].NextSibling = Nodes[NodeIndex].FirstChild;
+			Nodes[NodeIndex].FirstChild = NewIndex;
+			return;
+		}
+
+		NodeIndex = Child;
+	}
+}
+
+int32 UBKTreeDictionaryRepresentation::FindNode(const FString& Word) const
+{
+	int32 NodeIndex = Nodes.Num() > 0 ? 0 : INDEX_NONE;
+
+	while (NodeIndex != INDEX_NONE)
+	{
+		const int32 Distance = UBitParallelLevenshteinDistanceFunction::ComputeDistance(Word, Nodes[NodeIndex].Word);
+		if (Distance == 0)
+		{
+			return NodeIndex;
+		}
+
+		// Word can be only in subtree of child with the same distance
+		int32 Child = Nodes[NodeIndex].FirstChild;
+		while (Child != INDEX_NONE && Nodes[Child].ParentDistance != Distance)
+		{
+			Child = Nodes[Child].NextSibling;
+		}
+
+		NodeIndex = Child;
+	}
+
+	return INDEX_NONE;
+}
@@ -0,0 +1,213 @@
+// Created by Michal Chamula. All rights reserved.
+
+#include "DefaultClasses/BitParallelLevenshteinDistanceFunction.h"
+#include "DefaultClasses/LevenshteinDistanceFunction.h"
+
+namespace BitParallelLevenshtein
+{
+	/** Num of pattern characters in one block */
+	constexpr int32 WordSize = 64;
+
+	/** Max num of blocks, longer patterns use ULevenshteinDistanceFunction */
+	constexpr int32 MaxBlocks = 8;
+
+	/** Max num of distinct characters in pattern */
+	constexpr int32 MaxAlphabet = 96;
+
+	constexpr int32 AsciiSize = 128;
+
+	/**
+	 * Match masks of pattern characters (Peq table)
+	 * Bit i of the mask is set, if pattern character at index i equals to the mask character
+	 */
+	struct FPatternMasks
+	{
+		/** Slot index + 1 of ascii characters, 0 if character is not in pattern */
+		uint8 AsciiSlots[AsciiSize];
+
+		TCHAR Characters[MaxAlphabet];
+		uint64 Masks[MaxAlphabet][MaxBlocks];
+
+		int32 NumOfCharacters;
+		int32 NumOfBlocks;
+
+		FORCEINLINE int32 FindSlot(const TCHAR Character) const
+		{
+			if (Character < AsciiSize)
+			{
+				return static_cast<int32>(AsciiSlots[Character]) - 1;
+			}
+
+			for (int32 Slot = 0; Slot < NumOfCharacters; Slot++)
+			{
+				if (Characters[Slot] == Character)
+				{
+					return Slot;
+				}
+			}
+
+			return INDEX_NONE;
+		}
+
+		/** Returns false, if pattern has too many distinct characters */
+		bool Build(const TCHAR* Pattern, const int32 PatternLen)
+		{
+			NumOfBlocks = (PatternLen + WordSize - 1) / WordSize;
+			NumOfCharacters = 0;
+			FMemory::Memzero(AsciiSlots);
+
+			for (int32 i = 0; i < PatternLen; i++)
+			{
+				const TCHAR Character = Pattern[i];
+				int32 Slot = FindSlot(Character);
+
+				if (Slot == INDEX_NONE)
+				{
+					if (NumOfCharacters == MaxAlphabet)
+					{
+						return false;
+					}
+
+					Slot = NumOfCharacters++;
+					Characters[Slot] = Character;
+					FMemory::Memzero(Masks[Slot], sizeof(uint64) * NumOfBlocks);
+
+					if (Character < AsciiSize)
+					{
+						AsciiSlots[Character] = static_cast<uint8>(Slot + 1);
+					}
+				}
+
+				Masks[Slot][i / WordSize] |= 1ull << (i % WordSize);
+			}
+
+			return true;
+		}
+	};
+
+	/**
+	 * Advances one block of vertical delta vectors by one text character
+	 * @param Pv - Positive vertical deltas of block
+	 * @param Mv - Negative vertical deltas of block
+	 * @param Eq - Match mask of text character for block
+	 * @param HorizontalIn - Horizontal delta at the top of block (-1, 0, +1)
+	 * @param OutBit - Bit of the last row, which delta is returned
+	 * @return - Horizontal delta at the bottom row of block
+	 */
+	FORCEINLINE int32 AdvanceBlock(uint64& Pv, uint64& Mv, uint64 Eq, const int32 HorizontalIn, const uint64 OutBit)
+	{
+		const uint64 Xv = Eq | Mv;
+		if (HorizontalIn < 0)
+		{
+			Eq |= 1;
+		}
+
+		const uint64 Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+		uint64 Ph = Mv | ~(Xh | Pv);
+		uint64 Mh = Pv & Xh;
+
+		const int32 HorizontalOut = (Ph & OutBit) ? 1 : ((Mh & OutBit) ? -1 : 0);
+
+		Ph <<= 1;
+		Mh <<= 1;
+
+		if (HorizontalIn < 0)
+		{
+			Mh |= 1;
+		}
+		else if (HorizontalIn > 0)
+		{
+			Ph |= 1;
+		}
+
+		Pv = Mh | ~(Xv | Ph);
+		Mv = Ph & Xv;
+
+		return HorizontalOut;
+	}
+}
+
+uint32 UBitParallelLevenshteinDistanceFunction::GetStringDistance(const FString& InputA, const FString& InputB) const
+{
+	return ComputeDistance(InputA, InputB);
+}
+
+uint32 UBitParallelLevenshteinDistanceFunction::GetStringDistanceBounded(const FString& InputA, const FString& InputB, const uint32 MaxDistance) const
+{
+	return ComputeDistance(InputA, InputB, MaxDistance);
+}
+
+uint32 UBitParallelLevenshteinDistanceFunction::GetStringViewDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance) const
+{
+	return ComputeDistance(InputA, InputB, MaxDistance);
+}
+
+uint32 UBitParallelLevenshteinDistanceFunction::ComputeDistance(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance)
+{
+	using namespace BitParallelLevenshtein;
+
+	// Shorter string is used as pattern, so it needs less blocks
+	const bool bSwap = InputA.Len() > InputB.Len();
+	const FStringView Pattern = bSwap ? InputB : InputA;
+	const FStringView Text = bSwap ? InputA : InputB;
+
+	const int32 PatternLen = Pattern.Len();
+	const int32 TextLen = Text.Len();
+	const uint32 ExceededDistance = MaxDistance == MAX_uint32 ? MAX_uint32 : MaxDistance + 1;
+
+	// Distance is never smaller than len difference
+	if (static_cast<uint32>(TextLen - PatternLen) > MaxDistance)
+	{
+		return ExceededDistance;
+	}
+
+	if (PatternLen == 0)
+	{
+		return TextLen;
+	}
+
+	FPatternMasks PatternMasks;
+	if (PatternLen > WordSize * MaxBlocks || !PatternMasks.Build(Pattern.GetData(), PatternLen))
+	{
+		const uint32 Distance = ULevenshteinDistanceFunction::ComputeDistance(InputA, InputB);
+		return Distance > MaxDistance ? ExceededDistance : Distance;
+	}
+
+	uint64 Pv[MaxBlocks];
+	uint64 Mv[MaxBlocks];
+	for (int32 Block = 0; Block < PatternMasks.NumOfBlocks; Block++)
+	{
+		Pv[Block] = ~0ull;
+		Mv[Block] = 0;
+	}
+
+	const int32 LastBlock = PatternMasks.NumOfBlocks - 1;
+	const uint64 LastBit = 1ull << ((PatternLen - 1) % WordSize);
+	const uint64 HighBit = 1ull << (WordSize - 1);
+
+	// Score is the value of DP matrix in the last pattern row
+	int32 Score = PatternLen;
+
+	for (int32 TextIndex = 0; TextIndex < TextLen; TextIndex++)
+	{
+		const int32 Slot = PatternMasks.FindSlot(Text[TextIndex]);
+
+		// Top row of DP matrix increases with every text character
+		int32 Carry = 1;
+		for (int32 Block = 0; Block <= LastBlock; Block++)
+		{
+			const uint64 Eq = Slot != INDEX_NONE ? PatternMasks.Masks[Slot][Block] : 0;
+			Carry = AdvanceBlock(Pv[Block], Mv[Block], Eq, Carry, Block == LastBlock ? LastBit : HighBit);
+		}
+
+		Score += Carry;
+
+		// Score changes at most by one per remaining character, so the distance can't get under the bound anymore
+		if (static_cast<int64>(Score) - (TextLen - TextIndex - 1) > static_cast<int64>(MaxDistance))
+		{
+			return ExceededDistance;
+		}
+	}
+
+	return Score;
+}
@@ -0,0 +1,534 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/CompactDictionaryRepresentation.h"
+
+#include "Resources/Resources.h"
+
+namespace CompactDictionary
+{
+	/** Compares characters of two words with the same len, words in bucket are sorted by this order */
+	FORCEINLINE int32 CompareChars(const TCHAR* A, const TCHAR* B, const int32 Len)
+	{
+		return Len > 0 ? FCString::Strncmp(A, B, Len) : 0;
+	}
+}
+
+void UCompactDictionaryRepresentation::InitializeDictionary()
+{
+	Super::InitializeDictionary();
+
+	// In every bucket are words of same len, in first value are words with len == 1, at second with len == 2, ...
+	Buckets.Reset();
+	Buckets.SetNum(10);
+	LetterMasks.Reset();
+	LetterMasks.SetNum(10);
+	NumOfSortedWords.Reset();
+	NumOfSortedWords.SetNumZeroed(10);
+	StringPool.Reset();
+	WordsData.Reset();
+	TermWords.Reset();
+	NumOfRemovedWords = 0;
+	NumOfRemovedChars = 0;
+}
+
+void UCompactDictionaryRepresentation::RegisterWord(const FString& Word, const UDataTable* FromDataTable)
+{
+	// Word without term id can be found only by string
+	RegisterTerm(Word, INVALID_TERM_ID, FromDataTable);
+}
+
+void UCompactDictionaryRepresentation::RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	if (Word.Len() <= 0)
+	{
+		return;
+	}
+
+	// Interned term is found without search in bucket
+	const int32 TermIndex = static_cast<int32>(TermId);
+	int32 DataIndex = TermId != INVALID_TERM_ID && TermWords.IsValidIndex(TermIndex) ? TermWords[TermIndex] : INDEX_NONE;
+
+	if (DataIndex == INDEX_NONE)
+	{
+		const int32 WordIndex = FindWord(Word);
+		if (WordIndex != INDEX_NONE)
+		{
+			FCompactDictionaryWord& DictionaryWord = Buckets[Word.Len() - 1][WordIndex];
+			DataIndex = DictionaryWord.DataIndex;
+
+			if (DictionaryWord.TermId == INVALID_TERM_ID && TermId != INVALID_TERM_ID)
+			{
+				DictionaryWord.TermId = TermId;
+				WordsData[DataIndex].SetTermId(TermId);
+				MapTermToWord(TermId, DataIndex);
+			}
+		}
+	}
+
+	if (DataIndex != INDEX_NONE)
+	{
+		// We found data in dictionary, now we add new occurence into these data
+		WordsData[DataIndex].AddOccurence(RegisterTable(FromDataTable));
+	}
+	else
+	{
+		// Or we just create new word in dictionary
+		DataIndex = AddWord(Word, TermId);
+		WordsData[DataIndex].AddOccurence(RegisterTable(FromDataTable));
+	}
+}
+
+bool UCompactDictionaryRepresentation::UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	const int32 WordIndex = FindWord(Word);
+	if (WordIndex != INDEX_NONE && TableRegistry)
+	{
+		const int32 FixedLen = Word.Len() - 1;
+		const FCompactDictionaryWord DictionaryWord = Buckets[FixedLen][WordIndex];
+
+		FDictionaryData& Data = WordsData[DictionaryWord.DataIndex];
+		Data.RemoveOccurences(TableRegistry->Find(FromDataTable), 1);
+
+		// Word is not used in any table, so it can't be picked anymore
+		if (Data.IsEmpty())
+		{
+			if (TermWords.IsValidIndex(static_cast<int32>(DictionaryWord.TermId)))
+			{
+				TermWords[DictionaryWord.TermId] = INDEX_NONE;
+			}
+
+			// Characters and data are released by CompactWords()
+			Data = FDictionaryData();
+			NumOfRemovedWords++;
+			NumOfRemovedChars += DictionaryWord.Len;
+
+			// Order of bucket is kept, so it stays sorted
+			Buckets[FixedLen].RemoveAt(WordIndex, 1, false);
+			LetterMasks[FixedLen].RemoveAt(WordIndex, 1, false);
+			if (WordIndex < NumOfSortedWords[FixedLen])
+			{
+				NumOfSortedWords[FixedLen]--;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool UCompactDictionaryRepresentation::CopyDictionary(const UDictionaryRepresentation* Other)
+{
+	const UCompactDictionaryRepresentation* OtherDictionary = Cast<UCompactDictionaryRepresentation>(Other);
+	if (!OtherDictionary || OtherDictionary->GetClass() != GetClass())
+	{
+		return false;
+	}
+
+	// Table indexes of word data are valid, because table registry is copied with snapshot
+	StringPool = OtherDictionary->StringPool;
+	Buckets = OtherDictionary->Buckets;
+	LetterMasks = OtherDictionary->LetterMasks;
+	NumOfSortedWords = OtherDictionary->NumOfSortedWords;
+	WordsData = OtherDictionary->WordsData;
+	TermWords = OtherDictionary->TermWords;
+	NumOfRemovedWords = OtherDictionary->NumOfRemovedWords;
+	NumOfRemovedChars = OtherDictionary->NumOfRemovedChars;
+	return true;
+}
+
+void UCompactDictionaryRepresentation::FinalizeDictionary()
+{
+	Super::FinalizeDictionary();
+
+	// Removed and registered again word gets new characters and data, so dead space is released, when it is a quarter of dictionary
+	if (NumOfRemovedWords > 0 && NumOfRemovedWords * 4 >= WordsData.Num())
+	{
+		CompactWords();
+	}
+
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); BucketIndex++)
+	{
+		TArray<FCompactDictionaryWord>& Bucket = Buckets[BucketIndex];
+		if (NumOfSortedWords[BucketIndex] == Bucket.Num())
+		{
+			continue;
+		}
+
+		const TCHAR* Pool = StringPool.GetData();
+		Bucket.Sort([Pool](const FCompactDictionaryWord& A, const FCompactDictionaryWord& B)
+		{
+			return CompactDictionary::CompareChars(Pool + A.Offset, Pool + B.Offset, A.Len) < 0;
+		});
+
+		// Capacity of bucket was grown by registration
+		Bucket.Shrink();
+		NumOfSortedWords[BucketIndex] = Bucket.Num();
+
+		// Masks are in the same order as words
+		TArray<uint64>& Masks = LetterMasks[BucketIndex];
+		Masks.Reset(Bucket.Num());
+		for (const FCompactDictionaryWord& Word : Bucket)
+		{
+			Masks.Add(FDictionaryWordSignature::MakeLetterMask(GetWordView(Word)));
+		}
+		Masks.Shrink();
+	}
+
+	StringPool.Shrink();
+	WordsData.Shrink();
+}
+
+TArray<FString> UCompactDictionaryRepresentation::GetListOfWords() const
+{
+	TArray<FString> Result;
+
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); BucketIndex++)
+	{
+		Result.Append(GetListOfWordsOfLen(BucketIndex + 1));
+	}
+
+	return Result;
+}
+
+TArray<FString> UCompactDictionaryRepresentation::GetListOfWordsOfLen(const int32 WordLen) const
+{
+	TArray<FString> Result;
+	const int32 FixedWordLen = WordLen - 1;
+
+	if (Buckets.IsValidIndex(FixedWordLen))
+	{
+		Result.Reserve(Buckets[FixedWordLen].Num());
+
+		for (const FCompactDictionaryWord& Word : Buckets[FixedWordLen])
+		{
+			Result.Emplace(Word.Len, StringPool.GetData() + Word.Offset);
+		}
+	}
+
+	return Result;
+}
+
+void UCompactDictionaryRepresentation::ForEachWordOfLen(const int32 WordLen, TFunctionRef<bool(const FStringView& Word)> Visitor) const
+{
+	const int32 FixedWordLen = WordLen - 1;
+
+	if (Buckets.IsValidIndex(FixedWordLen))
+	{
+		for (const FCompactDictionaryWord& Word : Buckets[FixedWordLen])
+		{
+			if (!Visitor(GetWordView(Word)))
+			{
+				return;
+			}
+		}
+	}
+}
+
+void UCompactDictionaryRepresentation::ForEachCandidateOfLen(const int32 WordLen, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const
+{
+	const int32 NumOfWords = GetNumOfWordsOfLen(WordLen);
+	if (NumOfWords > 0)
+	{
+		ForEachCandidateInRange(WordLen, 0, NumOfWords, Input, DistanceLimit, Visitor);
+	}
+}
+
+int32 UCompactDictionaryRepresentation::GetNumOfWordsOfLen(const int32 WordLen) const
+{
+	return Buckets.IsValidIndex(WordLen - 1) ? Buckets[WordLen - 1].Num() : 0;
+}
+
+void UCompactDictionaryRepresentation::ForEachCandidateInRange(const int32 WordLen, const int32 FirstWord, const int32 NumOfWords, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const
+{
+	const int32 FixedWordLen = WordLen - 1;
+	const int32 LenBound = FMath::Abs(WordLen - Input.Len());
+
+	if (!Buckets.IsValidIndex(FixedWordLen) || LenBound >= DistanceLimit)
+	{
+		return;
+	}
+
+	constexpr int32 BlockSize = 64;
+
+	const TArray<FCompactDictionaryWord>& Bucket = Buckets[FixedWordLen];
+	const uint64* Masks = LetterMasks[FixedWordLen].GetData();
+	const uint64 InputMask = FDictionaryWordSignature::MakeLetterMask(Input);
+	const int32 LastWord = FMath::Min(FirstWord + NumOfWords, Bucket.Num());
+
+	int32 Limit = DistanceLimit;
+	int32 Bounds[BlockSize];
+
+	for (int32 BlockStart = FMath::Max(FirstWord, 0); BlockStart < LastWord; BlockStart += BlockSize)
+	{
+		const int32 BlockLen = FMath::Min(BlockSize, LastWord - BlockStart);
+
+		// Lower bounds of whole block are computed without branches, so the loop is vectorized by compiler
+		uint64 Candidates = 0;
+		for (int32 i = 0; i < BlockLen; i++)
+		{
+			const uint64 Mask = Masks[BlockStart + i];
+			Bounds[i] = FMath::Max3(LenBound, static_cast<int32>(FMath::CountBits(Mask & ~InputMask)), static_cast<int32>(FMath::CountBits(InputMask & ~Mask)));
+			Candidates |= static_cast<uint64>(Bounds[i] < Limit) << i;
+		}
+
+		for (; Candidates != 0; Candidates &= Candidates - 1)
+		{
+			const int32 i = static_cast<int32>(FMath::CountTrailingZeros64(Candidates));
+
+			// Limit could be decreased by previous candidate of block
+			if (Bounds[i] >= Limit)
+			{
+				continue;
+			}
+
+			Limit = Visitor(GetWordView(Bucket[BlockStart + i]));
+			if (Limit <= 0)
+			{
+				return;
+			}
+		}
+	}
+}
+
+const FDictionaryData* UCompactDictionaryRepresentation::GetWordData(const FString& Word) const
+{
+	const int32 WordIndex = FindWord(Word);
+	return WordIndex != INDEX_NONE ? &WordsData[Buckets[Word.Len() - 1][WordIndex].DataIndex] : nullptr;
+}
+
+const FDictionaryData* UCompactDictionaryRepresentation::GetTermData(const uint32 TermId) const
+{
+	const int32 TermIndex = static_cast<int32>(TermId);
+
+	if (TermWords.IsValidIndex(TermIndex) && TermWords[TermIndex] != INDEX_NONE)
+	{
+		return &WordsData[TermWords[TermIndex]];
+	}
+
+	return nullptr;
+}
+
+bool UCompactDictionaryRepresentation::SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const
+{
+	// Dense table indexes are remapped to index of Tables, so the index doesn't depend on order of registration
+	TArray<int32> TableRemap;
+	if (TableRegistry)
+	{
+		TableRemap.Reserve(TableRegistry->Num());
+		for (int32 TableIndex = 0; TableIndex < TableRegistry->Num(); TableIndex++)
+		{
+			TableRemap.Add(Tables.IndexOfByKey(TableRegistry->GetTable(TableIndex)));
+		}
+	}
+
+	int32 NumOfBuckets = Buckets.Num();
+	Ar << NumOfBuckets;
+
+	for (const TArray<FCompactDictionaryWord>& Bucket : Buckets)
+	{
+		int32 NumOfWords = Bucket.Num();
+		Ar << NumOfWords;
+
+		for (const FCompactDictionaryWord& DictionaryWord : Bucket)
+		{
+			FString Word(DictionaryWord.Len, StringPool.GetData() + DictionaryWord.Offset);
+			uint32 TermId = DictionaryWord.TermId;
+			Ar << Word << TermId;
+			WordsData[DictionaryWord.DataIndex].SaveOccurences(Ar, TableRemap);
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+bool UCompactDictionaryRepresentation::LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables)
+{
+	int32 NumOfBuckets = 0;
+	Ar << NumOfBuckets;
+
+	if (Ar.IsError() || NumOfBuckets < 0)
+	{
+		return false;
+	}
+
+	InitializeDictionary();
+
+	TArray<int32> TableRemap;
+	TableRemap.Reserve(Tables.Num());
+	for (const UDataTable* Table : Tables)
+	{
+		TableRemap.Add(RegisterTable(Table));
+	}
+
+	for (int32 BucketIndex = 0; BucketIndex < NumOfBuckets && !Ar.IsError(); BucketIndex++)
+	{
+		int32 NumOfWords = 0;
+		Ar << NumOfWords;
+
+		for (int32 i = 0; i < NumOfWords && !Ar.IsError(); i++)
+		{
+			FString Word;
+			uint32 TermId = INVALID_TERM_ID;
+			Ar << Word << TermId;
+
+			// Word in bucket of other len means corrupted index
+			if (Word.Len() != BucketIndex + 1)
+			{
+				Ar.SetError();
+				break;
+			}
+
+			const int32 DataIndex = AddWord(Word, TermId);
+			WordsData[DataIndex].LoadOccurences(Ar, TableRemap);
+		}
+	}
+
+	// Saved buckets are sorted, but sort doesn't depend on order of saving
+	FinalizeDictionary();
+
+	return !Ar.IsError();
+}
+
+void UCompactDictionaryRepresentation::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T AllocatedSize = StringPool.GetAllocatedSize() + Buckets.GetAllocatedSize() + LetterMasks.GetAllocatedSize() + NumOfSortedWords.GetAllocatedSize() + WordsData.GetAllocatedSize() + TermWords.GetAllocatedSize();
+
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); BucketIndex++)
+	{
+		AllocatedSize += Buckets[BucketIndex].GetAllocatedSize() + LetterMasks[BucketIndex].GetAllocatedSize();
+	}
+
+	for (const FDictionaryData& Data : WordsData)
+	{
+		AllocatedSize += Data.GetAllocatedSize();
+	}
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(AllocatedSize);
+}
+
+int32 UCompactDictionaryRepresentation::FindWord(const FStringView& Word) const
+{
+	const int32 FixedLen = Word.Len() - 1;
+	if (!Buckets.IsValidIndex(FixedLen))
+	{
+		return INDEX_NONE;
+	}
+
+	const TArray<FCompactDictionaryWord>& Bucket = Buckets[FixedLen];
+	const TCHAR* Pool = StringPool.GetData();
+
+	// Binary search in sorted part of bucket
+	int32 Low = 0;
+	int32 High = NumOfSortedWords[FixedLen];
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		const int32 Compare = CompactDictionary::CompareChars(Pool + Bucket[Middle].Offset, Word.GetData(), Word.Len());
+
+		if (Compare == 0)
+		{
+			return Middle;
+		}
+
+		if (Compare < 0)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	// Words registered after the last finalization are not sorted yet
+	for (int32 WordIndex = NumOfSortedWords[FixedLen]; WordIndex < Bucket.Num(); WordIndex++)
+	{
+		if (CompactDictionary::CompareChars(Pool + Bucket[WordIndex].Offset, Word.GetData(), Word.Len()) == 0)
+		{
+			return WordIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void UCompactDictionaryRepresentation::MapTermToWord(const uint32 TermId, const int32 DataIndex)
+{
+	if (TermId == INVALID_TERM_ID)
+	{
+		return;
+	}
+
+	const int32 TermIndex = static_cast<int32>(TermId);
+	if (TermWords.Num() <= TermIndex)
+	{
+		const int32 OldNum = TermWords.Num();
+		TermWords.SetNumUninitialized(TermIndex + 1);
+
+		for (int32 i = OldNum; i < TermWords.Num(); i++)
+		{
+			TermWords[i] = INDEX_NONE;
+		}
+	}
+
+	TermWords[TermIndex] = DataIndex;
+}
+
+int32 UCompactDictionaryRepresentation::AddWord(const FStringView& Word, const uint32 TermId)
+{
+	const int32 WordLen = Word.Len();
+	if (Buckets.Num() < WordLen)
+	{
+		// If bucket with (len == WordLen) doesn't exist, we have to extend the array
+		Buckets.SetNum(WordLen);
+		LetterMasks.SetNum(WordLen);
+		NumOfSortedWords.SetNumZeroed(WordLen);
+	}
+
+	const int32 Offset = StringPool.Num();
+	StringPool.Append(Word.GetData(), WordLen);
+
+	const int32 DataIndex = WordsData.AddDefaulted();
+	WordsData[DataIndex].SetTermId(TermId);
+
+	Buckets[WordLen - 1].Emplace(Offset, WordLen, TermId, DataIndex);
+	LetterMasks[WordLen - 1].Add(FDictionaryWordSignature::MakeLetterMask(Word));
+	MapTermToWord(TermId, DataIndex);
+
+	return DataIndex;
+}
+
+void UCompactDictionaryRepresentation::CompactWords()
+{
+	TArray<TCHAR> NewStringPool;
+	NewStringPool.Reserve(StringPool.Num() - NumOfRemovedChars);
+
+	TArray<FDictionaryData> NewWordsData;
+	NewWordsData.Reserve(WordsData.Num() - NumOfRemovedWords);
+
+	// Only words in buckets are alive, their terms are mapped again
+	for (int32& DataIndex : TermWords)
+	{
+		DataIndex = INDEX_NONE;
+	}
+
+	for (TArray<FCompactDictionaryWord>& Bucket : Buckets)
+	{
+		for (FCompactDictionaryWord& Word : Bucket)
+		{
+			const int32 NewOffset = NewStringPool.Num();
+			NewStringPool.Append(StringPool.GetData() + Word.Offset, Word.Len);
+			Word.Offset = NewOffset;
+
+			Word.DataIndex = NewWordsData.Add(MoveTemp(WordsData[Word.DataIndex]));
+			MapTermToWord(Word.TermId, Word.DataIndex);
+		}
+	}
+
+	StringPool = MoveTemp(NewStringPool);
+	WordsData = MoveTemp(NewWordsData);
+	NumOfRemovedWords = 0;
+	NumOfRemovedChars = 0;
+}
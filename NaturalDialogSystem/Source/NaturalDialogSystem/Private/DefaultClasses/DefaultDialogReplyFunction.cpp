@@ -1,491 +1,979 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "DefaultClasses/DefaultDialogReplyFunction.h"
-#include "Core/PlayerNaturalDialogComponent.h"
-#include "DefaultClasses/LevenshteinDistanceFunction.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "Resources/DictionaryRepresentation.h"
-#include "Resources/NaturalDialogSystemLibrary.h"
-
-#define MIN_COMBINATION 2
-
-DEFINE_LOG_CATEGORY(Log_DefaultDialogReplyFunction);
-
-UDefaultDialogReplyFunction::UDefaultDialogReplyFunction()
-{
-	MetricInterval = 10.f;
-}
-
-void UDefaultDialogReplyFunction::InitializeDialogReplyPicker()
-{
-	Super::InitializeDialogReplyPicker();
-
-	// Initialize all important references
-	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
-	if (GameInstance)
-	{
-		DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
-		if (DictionarySubsystem.IsValid())
-		{
-			DictionaryRepresentation = DictionarySubsystem.Get()->GetDictionary();
-		}
-	}
-
-	const TSubclassOf<UStringDistanceFunction> StringFuncClass = StringDistanceFunctionClass ? StringDistanceFunctionClass : ULevenshteinDistanceFunction::StaticClass();
-	StringDistanceFunction = NewObject<UStringDistanceFunction>(this, StringFuncClass);
-	StringDistanceFunction->GetStringDistance(TEXT("A"), TEXT("B")); // Override check
-
-	OwnerComponent = Cast<UPlayerNaturalDialogComponent>(GetOuter());
-
-	// Handle defaults table registration
-	if (DefaultResponses)
-	{
-		HandleNewTableRegistration(DefaultResponses);
-	}
-	else
-	{
-		UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Default responses table is invalid"));
-	}
-
-	if (ensure(OwnerComponent.IsValid()))
-	{
-		OwnerComponent.Get()->OnDataTableAdded.AddUniqueDynamic(this, &UDefaultDialogReplyFunction::HandleNewTableRegistration);
-		OwnerComponent.Get()->OnDataTableRemoved.AddUniqueDynamic(this, &UDefaultDialogReplyFunction::HandleRegisteredTableRemoved);
-	}
-
-	if (GetWorld())
-	{
-		GetWorld()->GetTimerManager().SetTimer(MatrixWearinessHandler, this, &UDefaultDialogReplyFunction::HandleMatrixWeariness, MetricInterval, true);
-	}
-}
-
-bool UDefaultDialogReplyFunction::GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
-{
-	bool Result = false;
-	ResultAnswer = FNaturalDialogResult();
-
-	if (!DictionarySubsystem.IsValid())
-	{
-		const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
-		DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
-		UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Invalid dictionary subsystem reference, setting new one"));
-	}
-
-	if (!DictionaryRepresentation.IsValid())
-	{
-		if (DictionarySubsystem.IsValid())
-		{
-			DictionaryRepresentation = DictionarySubsystem.Get()->GetDictionary();
-			UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Invalid dictionary representation reference, setting new one"));
-		}
-
-		if (!DictionaryRepresentation.IsValid())
-		{
-			UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Invalid dictionary representation ptr value"));
-			return Result;
-		}
-	}
-
-	if (DictionarySubsystem.IsValid() && OwnerComponent.IsValid())
-	{
-		// Generated keywords of input sentence
-		const TArray<FString> Keywords = DictionarySubsystem.Get()->GenerateKeywords(OwnerComponent.Get(), Sentence);
-
-#if !UE_BUILD_SHIPPING
-
-		FString StringDebugKeywords = "";
-		StringDebugKeywords.Reserve(Keywords.Num() * 10);
-		for (const FString& Keyword : Keywords)
-		{
-			StringDebugKeywords += Keyword + TEXT(" ");
-		}
-		UE_LOG(LogPlayerNaturalDialogComponent, Log, TEXT("Founds keywords are: %s"), *StringDebugKeywords);
-
-#endif
-
-		if (Keywords.IsValidIndex(0))
-		{
-			const TSet<const UDataTable*> TableSet = FindBestTableSet(NpcNaturalDialogComponent, Keywords);
-
-#if !UE_BUILD_SHIPPING
-
-			FString DebugMessage = TEXT("Selected tables for reply: { ");
-			DebugMessage.Reserve(100);
-
-			for (const UDataTable* Table : TableSet)
-			{
-				DebugMessage += Table->GetName() + " ";
-			}
-
-			DebugMessage += "}";
-			UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("%s"), *DebugMessage);
-
-#endif
-
-			// Now we check only selected tables
-			if (TableSet.Num() > 0)
-			{
-				TArray<FReplyData> ReplyData;
-				ReplyData.Reserve(TableSet.Num());
-
-				for (const UDataTable* OutTable : TableSet)
-				{
-					// Find row with most keyword match
-					OutTable->ForeachRow<FNaturalDialogRow_Keyword>("Searching for data from keywords", [&ReplyData, OutTable, &Keywords, this](const FName& Key, const FNaturalDialogRow_Keyword& Value)
-					{
-						int32 MatchCount = 0;
-						int32 AbsoluteError = 0;
-						const TArray<FText>& RowKeywords = Value.Keywords;
-
-						for (const FString& InputKeyword : Keywords)
-						{
-							for (const FText& RowKeyword : RowKeywords)
-							{
-								const FString NormalizedRowKeywords = UNaturalDialogSystemLibrary::NormalizeTerm(RowKeyword.ToString());
-								const int32 StringLenDifference = FMath::Abs(InputKeyword.Len() - NormalizedRowKeywords.Len());
-								const int32 StringDistance = StringDistanceFunction->GetStringDistance(InputKeyword, NormalizedRowKeywords);
-								const int32 StringError = FMath::Abs(StringDistance - StringLenDifference);
-								if (StringError == 0)
-								{
-									AbsoluteError += StringLenDifference;
-									MatchCount++;
-									break;
-								}
-							}
-						}
-
-						for (int32 AnswerIndex = 0; AnswerIndex < Value.Answer.Num(); AnswerIndex++)
-						{
-							const FReplyData TempData = FReplyData(MatchCount, OutTable, Key, AnswerIndex, AbsoluteError);
-							const int32 DataIndex = ReplyData.Find(TempData);
-
-							// If any reply data with the same data table contains reply with equals num of keywords, then add this data asn new possibility to response, from these data we select with the hightest metric value
-							if (MatchCount > 0 && (DataIndex == INDEX_NONE || ReplyData[DataIndex].NumOfMatchedKeywords == TempData.NumOfMatchedKeywords))
-							{
-								// Allow only rows with min keywords match
-								if(TempData.NumOfMatchedKeywords >= Value.MinKeywordsMatch)
-								{
-									ReplyData.Add(TempData);
-								}
-							}
-							else if (DataIndex != INDEX_NONE && ReplyData[DataIndex].NumOfMatchedKeywords < TempData.NumOfMatchedKeywords)
-							{
-								ReplyData[DataIndex] = TempData;
-							}
-						}
-					});
-				}
-
-				// Find all elements with highness value
-				const FReplyData BestReplyData = FindBestReply(ReplyData);
-
-				// We need at least 3 matched keywords to select correct response, or if keywords are matched, because we can say only "hi"
-				// if (BestReplyData.NumOfMatchedKeywords >= MIN_KEYWORDS_COUNT || BestReplyData.NumOfMatchedKeywords == Keywords.Num())
-				if (BestReplyData.IsValid())
-				{
-					Result = true;
-					ResultAnswer = FNaturalDialogResult(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
-
-					// Decrease metric value
-					ModifyMetricValue(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
-				}
-			}
-		}
-		else
-		{
-			UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Empty keywords input array"));
-		}
-
-		// DEFAULT REPLIES
-		// Implement default reply
-		// Used if no reply was found for player input
-		if (!Result && DefaultResponses)
-		{
-			// Fill table data
-			TArray<FReplyData> ReplyData;
-			DefaultResponses->ForeachRow<FNaturalDialogRow_Base>("Searching for data from keywords", [&ReplyData, this](const FName& Key, const FNaturalDialogRow_Base& Value)
-			{
-				for (int32 i = 0; i < Value.Answer.Num(); i++)
-				{
-					ReplyData.Add(FReplyData(0, DefaultResponses, Key, i, 0));
-				}
-			});
-
-			if (ReplyData.IsValidIndex(0))
-			{
-				// Find the best, by using metric
-				const FReplyData BestReplyData = FindBestReply(ReplyData);
-
-				ResultAnswer = FNaturalDialogResult(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
-
-				// Decrease metric value
-				ModifyMetricValue(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
-			}
-		}
-	}
-
-	return Result;
-}
-
-TSet<const UDataTable*> UDefaultDialogReplyFunction::FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<FString>& Keywords) const
-{
-	TSet<const UDataTable*> Result;
-
-	if (!Keywords.IsValidIndex(0))
-	{
-		return Result;
-	}
-
-	TArray<TSet<const UDataTable*>> Combinations;
-	Combinations.Reserve(20);
-
-	if (Keywords.Num() < MIN_COMBINATION)
-	{
-		// Just use tables of the one keyword, we have found
-		const FDictionaryData* InitialDictData = DictionaryRepresentation.Get()->GetWordData(Keywords[0]);
-		Combinations.Add(InitialDictData->GetTables());
-	}
-	else
-	{
-		// Find all combinations of keywords
-		for (int32 Size = MIN_COMBINATION; Size <= Keywords.Num(); Size ++)
-		{
-			TArray<FString> Data;
-			Data.SetNum(Size);
-			Combinations.Append(CombinationUtil(Keywords, Data, 0, Keywords.Num() - 1, 0, Size));
-		}
-	}
-
-	TArray<int32> CachedSizes;
-	CachedSizes.SetNum(Combinations.Num());
-
-	// Intersect on tables which are available for NPC
-	for (int32 i = 0; i < Combinations.Num(); i++)
-	{
-		Combinations[i] = Combinations[i].Intersect(OwnerComponent.Get()->GetDialogTables_Const(NpcNaturalDialogComponent));
-		CachedSizes[i] = Combinations[i].Num();
-	}
-
-	// Find tables with max value
-	int32 MaxIndex = INDEX_NONE;
-	int32 MaxValue = -1;
-	UKismetMathLibrary::MaxOfIntArray(CachedSizes, MaxIndex, MaxValue);
-
-	if (MaxIndex != INDEX_NONE)
-	{
-		return Combinations[MaxIndex];
-	}
-
-	return Result;
-}
-
-void UDefaultDialogReplyFunction::HandleNewTableRegistration(const UDataTable* NewTable)
-{
-	if (NewTable)
-	{
-		FDialogMetricRow& StoredValue = Metric.Add(NewTable, FDialogMetricRow());
-
-		if (NewTable->GetRowStruct()->IsChildOf(FNaturalDialogRow_Base::StaticStruct()))
-		{
-			// FNaturalDialogRow_Base for now appears only one time, for default response values
-			NewTable->ForeachRow<FNaturalDialogRow_Base>("Creating metrics values", [&StoredValue](const FName& Key, const FNaturalDialogRow_Base& Value)
-			{
-				const int32 NumOfAnswers = Value.Answer.Num();
-				StoredValue.Add(Key, NumOfAnswers);
-			});
-		}
-
-		UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Creating metric values for table %s"), *NewTable->GetName());
-	}
-}
-
-void UDefaultDialogReplyFunction::HandleRegisteredTableRemoved(const UDataTable* NewTable)
-{
-	Metric.Remove(NewTable);
-	UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Removing metric values for table %s"), *NewTable->GetName());
-}
-
-void UDefaultDialogReplyFunction::HandleMatrixWeariness()
-{
-	for (TPair<const UDataTable*, FDialogMetricRow> Pair : Metric)
-	{
-		for (float* MetricValue : Pair.Value.GetAllWearinessValues())
-		{
-			if (FMath::RandBool())
-			{
-				*MetricValue *= FMath::Clamp(*MetricValue * 1.1f, 0.f, 1.f);
-			}
-		}
-	}
-
-	// Log metric values into log
-	// Slow operation, but perfect for debugging
-	LogMetricValues();
-}
-
-FReplyData UDefaultDialogReplyFunction::FindBestReply(const TArray<FReplyData>& AllReplies) const
-{
-	FReplyData Result;
-
-	if (AllReplies.IsValidIndex(0))
-	{
-		// Find all elements with highness value
-		TArray<int32> ElementIndexes;
-		int32 MaxValue = INDEX_NONE;
-		int32 MinError = INT_MAX;
-		for (int32 i = 0; i < AllReplies.Num(); i++)
-		{
-			const int32 NewMaxValue = AllReplies[i].NumOfMatchedKeywords;
-			const int32 NewError = AllReplies[i].AbsoluteError;
-
-			if (NewMaxValue == MaxValue && NewError == MinError)
-			{
-				ElementIndexes.Add(i);
-			}
-			else if (NewMaxValue >= MaxValue && NewError < MinError) // Find with maximum keyword match, but with minimum len distance error
-			{
-				MaxValue = NewMaxValue;
-				MinError = NewError;
-				ElementIndexes.Reset(5);
-				ElementIndexes.Add(i);
-			}
-		}
-
-		// Now from all max values we choose one with best metric value
-		const FReplyData* BestResultData = &AllReplies[ElementIndexes[0]];
-
-		for (int32 i = 1; i < ElementIndexes.Num(); i++)
-		{
-			const FDialogMetricRow* BestRow = Metric.Find(BestResultData->InTable);
-			const FDialogMetricRow* CurrentRow = Metric.Find(AllReplies[i].InTable);
-			if (ensure(BestRow && CurrentRow))
-			{
-				for (int32 AnswerIndex = 0; AnswerIndex < CurrentRow->GetNumOfAnswers(); AnswerIndex++)
-				{
-					const float BestValue = BestRow->GetEvalValue(BestResultData->RowName, BestResultData->AnswerIndex);
-					const float CurrentValue = CurrentRow->GetEvalValue(AllReplies[i].RowName, AnswerIndex);
-					if (BestValue < CurrentValue)
-					{
-						BestResultData = &AllReplies[i];
-					}
-				}
-			}
-		}
-
-		Result = *BestResultData;
-	}
-
-	return Result;
-}
-
-void UDefaultDialogReplyFunction::ModifyMetricValue(const UDataTable* InTable, const FName InRow, const int32 AnswerIndex)
-{
-	if (InTable)
-	{
-		FDialogMetricRow* MetricData = Metric.Find(InTable);
-		if (MetricData)
-		{
-			float& MetricValue = MetricData->GetWearinessValueRef(InRow, AnswerIndex);
-			if (MetricCurve)
-			{
-				// Curve metric calculation
-				const float NewValue = MetricCurve->GetFloatValue(MetricValue);
-				UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Metric has changed (%s | %s), (old value = %f, new value = %f)"), *InTable->GetName(), *InRow.ToString(), MetricValue, NewValue);
-				MetricValue = NewValue;
-			}
-			else
-			{
-				// Default metric calculation
-				const float NewValue = FMath::Clamp(MetricValue * 0.5f, 0.01f, 1.f);
-				UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Metric has changed (%s | %s), (old value = %f, new value = %f)"), *InTable->GetName(), *InRow.ToString(), MetricValue, NewValue);
-				MetricValue = NewValue;
-
-				UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Curve isn ont set, for metric calculation"));
-			}
-
-			// Log metric values into log
-			// Slow operation, but perfect for debugging
-			LogMetricValues();
-		}
-		else
-		{
-			UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Metric doesn't contain data table data (%s)"), *InTable->GetName());
-		}
-	}
-	else
-	{
-		UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Input table is not valid in function ModifyMetricValue()"));
-	}
-}
-
-void UDefaultDialogReplyFunction::LogMetricValues()
-{
-	// #todo ... finish this
-
-#if !UE_BUILD_SHIPPING
-
-	// static FString Rows = TEXT("   Rows > ");
-	// static FString Columns = TEXT("V Tables ");
-	// static FString VertSeparator = TEXT("||");
-	// static FString HorizSeparator = TEXT("=");
-	//
-	// TArray<int32> TablesLens;
-	// for (const TPair<const UDataTable*, FDialogMetricRow>& Table : Metric)
-	// {
-	// 	TablesLens.Add(Table.Value.Num());
-	// }
-	//
-	// int32 TempIndex;
-	// const int32 NumOfColumns = FMath::Max(TablesLens, &TempIndex);
-	// const int32 Abc = FString::FromInt(NumOfColumns).Len();
-	//
-	// FString Result = "Metric values\n" + Rows + VertSeparator + "\n"; // First line
-	// Result.Append(Columns + VertSeparator);                           // Second line
-	//
-	// for (int32 i = 0; i < NumOfColumns; i++)
-	// {
-	// 	Result.Append(" Row " + FString::FromInt(i + 1) + " ");
-	// }
-
-#endif
-}
-
-TArray<TSet<const UDataTable*>> UDefaultDialogReplyFunction::CombinationUtil(const TArray<FString>& InArray, TArray<FString> Data, const int32 Start, const int32 End, const int32 Index, const int32 CombinationSize) const
-{
-	TArray<TSet<const UDataTable*>> Result;
-
-	// Current combination is ready
-	if (Index == CombinationSize)
-	{
-		if (Data.IsValidIndex(0))
-		{
-			const FDictionaryData* InitialDictData = DictionaryRepresentation.Get()->GetWordData(Data[0]);
-			TSet<const UDataTable*> TableSet = InitialDictData->GetTables();
-
-			for (int32 i = 1; i < Data.Num(); i++)
-			{
-				const FDictionaryData* DictData = DictionaryRepresentation.Get()->GetWordData(Data[i]);
-				TableSet = TableSet.Intersect(DictData->GetTables());
-			}
-
-			Result.Add(TableSet);
-		}
-
-		return Result;
-	}
-
-	// replace index with all possible
-	// elements. The condition "end-i+1 >= r-index"
-	// makes sure that including one element
-	// at index will make a combination with
-	// remaining elements at remaining positions
-	for (int i = Start; i <= End && End - i + 1 >= CombinationSize - Index; i++)
-	{
-		Data[Index] = InArray[i];
-		Result.Append(CombinationUtil(InArray, Data, i + 1, End, Index + 1, CombinationSize));
-	}
-
-	return Result;
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/DefaultDialogReplyFunction.h"
+#include "Core/PlayerNaturalDialogComponent.h"
+#include "DefaultClasses/BitParallelLevenshteinDistanceFunction.h"
+#include "Kismet/GameplayStatics.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+
+DEFINE_LOG_CATEGORY(Log_DefaultDialogReplyFunction);
+
+TArray<FReplyData> FDefaultDialogReplyMatcher::FindReplyCandidates(const FString& Sentence) const
+{
+	return UDefaultDialogReplyFunction::FindReplyCandidates(Context, Sentence);
+}
+
+bool FDefaultDialogReplyMatcher::GetSharingKey(FString& OutKey) const
+{
+	if (!Context.DictionarySubsystem || !Context.DictionarySubsystem->IsKeywordPickingPlayerIndependent())
+	{
+		return false;
+	}
+
+	OutKey = Context.StringDistanceFunction ? Context.StringDistanceFunction->GetClass()->GetPathName() : FString();
+	for (const UDataTable* Table : Context.NpcTables)
+	{
+		OutKey += TEXT(",");
+		OutKey += Table->GetPathName();
+	}
+
+	return true;
+}
+
+FString FReplyCandidateCache::MakeKey(const FString& Sentence, const TArray<const UDataTable*>& NpcTables)
+{
+	// Keywords are generated only from normalized terms, so sentences with the same terms have the same candidates
+	uint32 TablesHash = 0;
+	for (const UDataTable* Table : NpcTables)
+	{
+		TablesHash = HashCombine(TablesHash, GetTypeHash(Table));
+	}
+
+	FString Key = FString::Printf(TEXT("%08x|"), TablesHash);
+	const FScopedNormalizedText Terms(Sentence);
+	Terms->JoinTo(Key, TEXT(' '));
+	return Key;
+}
+
+bool FReplyCandidateCache::Find(const FString& Key, const TArray<const UDataTable*>& NpcTables, TArray<FReplyData>& OutCandidates)
+{
+	FScopeLock Lock(&CacheLock);
+
+	const FEntry* Entry = Entries.FindAndTouch(Key);
+	if (Entry && Entry->NpcTables == NpcTables)
+	{
+		OutCandidates = Entry->Candidates;
+		NumOfHits++;
+		return true;
+	}
+
+	NumOfMisses++;
+	return false;
+}
+
+void FReplyCandidateCache::Add(const FString& Key, const TArray<const UDataTable*>& NpcTables, const TArray<FReplyData>& Candidates, const uint32 InGeneration)
+{
+	FScopeLock Lock(&CacheLock);
+
+	if (InGeneration == Generation)
+	{
+		FEntry Entry;
+		Entry.NpcTables = NpcTables;
+		Entry.Candidates = Candidates;
+		Entries.Add(Key, MoveTemp(Entry));
+	}
+}
+
+void FReplyCandidateCache::InvalidateTable(const UDataTable* InTable)
+{
+	FScopeLock Lock(&CacheLock);
+
+	TArray<FString> Keys;
+	Entries.GetKeys(Keys);
+
+	for (const FString& Key : Keys)
+	{
+		const FEntry* Entry = Entries.Find(Key);
+		if (Entry && Entry->NpcTables.Contains(InTable))
+		{
+			Entries.Remove(Key);
+		}
+	}
+
+	Generation++;
+}
+
+void FReplyCandidateCache::InvalidateAll()
+{
+	FScopeLock Lock(&CacheLock);
+
+	Entries.Empty(Entries.Max());
+	Generation++;
+}
+
+uint32 FReplyCandidateCache::GetGeneration() const
+{
+	FScopeLock Lock(&CacheLock);
+	return Generation;
+}
+
+FReplyCacheStats FReplyCandidateCache::GetStats() const
+{
+	FScopeLock Lock(&CacheLock);
+
+	FReplyCacheStats Stats;
+	Stats.NumOfHits = NumOfHits;
+	Stats.NumOfMisses = NumOfMisses;
+	Stats.NumOfEntries = Entries.Num();
+	return Stats;
+}
+
+void FTableKeywordIndex::Build(const UDataTable* InTable, const FDictionaryTermTable* TermTable)
+{
+	Keywords.Reset();
+	KeywordTerms.Reset();
+	KeywordRows.Reset();
+	Rows.Reset();
+
+	if (!InTable || !InTable->GetRowStruct() || !InTable->GetRowStruct()->IsChildOf(FNaturalDialogRow_Keyword::StaticStruct()))
+	{
+		return;
+	}
+
+	TMap<FString, int32> KeywordIds;
+
+	InTable->ForeachRow<FNaturalDialogRow_Keyword>("Building keyword index", [this, &KeywordIds, TermTable](const FName& Key, const FNaturalDialogRow_Keyword& Value)
+	{
+		const int32 RowIndex = Rows.AddDefaulted();
+		FKeywordIndexRow& Row = Rows[RowIndex];
+		Row.RowName = Key;
+		Row.NumOfAnswers = Value.Answer.Num();
+		Row.MinKeywordsMatch = Value.MinKeywordsMatch;
+		Row.Keywords.Reserve(Value.Keywords.Num());
+
+		for (const FText& RowKeyword : Value.Keywords)
+		{
+			const FString NormalizedKeyword = UNaturalDialogSystemLibrary::NormalizeTerm(RowKeyword.ToString());
+
+			int32 KeywordId;
+			if (const int32* FoundId = KeywordIds.Find(NormalizedKeyword))
+			{
+				KeywordId = *FoundId;
+			}
+			else
+			{
+				KeywordId = Keywords.Add(NormalizedKeyword);
+				KeywordTerms.Add(TermTable ? TermTable->Find(NormalizedKeyword) : INVALID_TERM_ID);
+				KeywordRows.AddDefaulted();
+				KeywordIds.Add(NormalizedKeyword, KeywordId);
+			}
+
+			Row.Keywords.Add(KeywordId);
+
+			// Row can contain the same keyword more times
+			if (KeywordRows[KeywordId].Num() == 0 || KeywordRows[KeywordId].Last() != RowIndex)
+			{
+				KeywordRows[KeywordId].Add(RowIndex);
+			}
+		}
+	});
+}
+
+TSharedPtr<FTableKeywordIndex, ESPMode::ThreadSafe> FTableKeywordIndex::ResolveNewTerms(const FDictionaryTermTable& TermTable) const
+{
+	TSharedPtr<FTableKeywordIndex, ESPMode::ThreadSafe> Result;
+
+	for (int32 KeywordId = 0; KeywordId < KeywordTerms.Num(); KeywordId++)
+	{
+		if (KeywordTerms[KeywordId] != INVALID_TERM_ID)
+		{
+			continue;
+		}
+
+		const uint32 TermId = TermTable.Find(Keywords[KeywordId]);
+		if (TermId != INVALID_TERM_ID)
+		{
+			// Index can be read by running matching, so the new ids are written into copy
+			if (!Result.IsValid())
+			{
+				Result = MakeShared<FTableKeywordIndex, ESPMode::ThreadSafe>(*this);
+			}
+			Result->KeywordTerms[KeywordId] = TermId;
+		}
+	}
+
+	return Result;
+}
+
+UDefaultDialogReplyFunction::UDefaultDialogReplyFunction()
+{
+	MetricInterval = 10.f;
+	ReplyCacheCapacity = 64;
+}
+
+void UDefaultDialogReplyFunction::InitializeDialogReplyPicker()
+{
+	Super::InitializeDialogReplyPicker();
+
+	// Initialize all important references
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
+	if (GameInstance)
+	{
+		DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
+		if (DictionarySubsystem.IsValid())
+		{
+			DictionarySubsystem.Get()->OnSnapshotChanged.AddUObject(this, &UDefaultDialogReplyFunction::HandleDictionarySnapshotChanged);
+		}
+	}
+
+	const TSubclassOf<UStringDistanceFunction> StringFuncClass = StringDistanceFunctionClass ? StringDistanceFunctionClass : UBitParallelLevenshteinDistanceFunction::StaticClass();
+	StringDistanceFunction = NewObject<UStringDistanceFunction>(this, StringFuncClass);
+	StringDistanceFunction->GetStringDistance(TEXT("A"), TEXT("B")); // Override check
+
+	OwnerComponent = Cast<UPlayerNaturalDialogComponent>(GetOuter());
+
+	if (ReplyCacheCapacity > 0)
+	{
+		ReplyCache = MakeShared<FReplyCandidateCache, ESPMode::ThreadSafe>(ReplyCacheCapacity);
+	}
+
+	// Handle defaults table registration
+	if (DefaultResponses)
+	{
+		HandleNewTableRegistration(DefaultResponses);
+	}
+	else
+	{
+		UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Default responses table is invalid"));
+	}
+
+	if (ensure(OwnerComponent.IsValid()))
+	{
+		OwnerComponent.Get()->OnDataTableAdded.AddUniqueDynamic(this, &UDefaultDialogReplyFunction::HandleNewTableRegistration);
+		OwnerComponent.Get()->OnDataTableRemoved.AddUniqueDynamic(this, &UDefaultDialogReplyFunction::HandleRegisteredTableRemoved);
+	}
+
+	if (GetWorld())
+	{
+		GetWorld()->GetTimerManager().SetTimer(MatrixWearinessHandler, this, &UDefaultDialogReplyFunction::HandleMatrixWeariness, MetricInterval, true);
+	}
+}
+
+bool UDefaultDialogReplyFunction::GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+{
+	ResultAnswer = FNaturalDialogResult();
+
+	if (UpdateDictionaryReferences() && OwnerComponent.IsValid())
+	{
+		const TArray<FReplyData> Candidates = FindReplyCandidates(MakeMatchingContext(NpcNaturalDialogComponent), Sentence);
+		return ResolveReply(Candidates, NpcNaturalDialogComponent, ResultAnswer);
+	}
+
+	return false;
+}
+
+bool UDefaultDialogReplyFunction::GenerateReplyFromTerms(const TArray<uint32>& KeywordTerms, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+{
+	ResultAnswer = FNaturalDialogResult();
+
+	if (UpdateDictionaryReferences() && OwnerComponent.IsValid())
+	{
+		const TArray<FReplyData> Candidates = MatchReplyCandidates(MakeMatchingContext(NpcNaturalDialogComponent), KeywordTerms);
+		return ResolveReply(Candidates, NpcNaturalDialogComponent, ResultAnswer);
+	}
+
+	return false;
+}
+
+TSharedPtr<FDialogReplyMatcher, ESPMode::ThreadSafe> UDefaultDialogReplyFunction::CreateReplyMatcher(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent)
+{
+	if (UpdateDictionaryReferences() && OwnerComponent.IsValid())
+	{
+		// Worker thread can't create function instances of subsystem
+		DictionarySubsystem.Get()->EnsureFunctionInstances();
+		return MakeShared<FDefaultDialogReplyMatcher, ESPMode::ThreadSafe>(MakeMatchingContext(NpcNaturalDialogComponent));
+	}
+
+	return nullptr;
+}
+
+bool UDefaultDialogReplyFunction::ResolveReply(const TArray<FReplyData>& Candidates, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+{
+	bool Result = false;
+	ResultAnswer = FNaturalDialogResult();
+
+	// Find all elements with highness value
+	const FReplyData BestReplyData = FindBestReply(Candidates);
+
+	// We need at least 3 matched keywords to select correct response, or if keywords are matched, because we can say only "hi"
+	// if (BestReplyData.NumOfMatchedKeywords >= MIN_KEYWORDS_COUNT || BestReplyData.NumOfMatchedKeywords == Keywords.Num())
+	if (BestReplyData.IsValid())
+	{
+		Result = true;
+		ResultAnswer = FNaturalDialogResult(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
+
+		// Decrease metric value
+		ModifyMetricValue(BestReplyData.InTable, BestReplyData.RowName, BestReplyData.AnswerIndex);
+	}
+
+	// DEFAULT REPLIES
+	// Implement default reply
+	// Used if no reply was found for player input
+	if (!Result && DefaultResponses)
+	{
+		// Fill table data
+		TArray<FReplyData> ReplyData;
+		DefaultResponses->ForeachRow<FNaturalDialogRow_Base>("Searching for data from keywords", [&ReplyData, this](const FName& Key, const FNaturalDialogRow_Base& Value)
+		{
+			for (int32 i = 0; i < Value.Answer.Num(); i++)
+			{
+				ReplyData.Add(FReplyData(0, DefaultResponses, Key, i, 0));
+			}
+		});
+
+		if (ReplyData.IsValidIndex(0))
+		{
+			// Find the best, by using metric
+			const FReplyData DefaultReplyData = FindBestReply(ReplyData);
+
+			ResultAnswer = FNaturalDialogResult(DefaultReplyData.InTable, DefaultReplyData.RowName, DefaultReplyData.AnswerIndex);
+
+			// Decrease metric value
+			ModifyMetricValue(DefaultReplyData.InTable, DefaultReplyData.RowName, DefaultReplyData.AnswerIndex);
+		}
+	}
+
+	return Result;
+}
+
+TArray<FReplyData> UDefaultDialogReplyFunction::MatchReplyCandidates(const FReplyMatchingContext& Context, const TArray<uint32>& KeywordTerms)
+{
+	TArray<FReplyData> ReplyData;
+
+	if (!Context.DictionarySubsystem || !Context.Snapshot.IsValid() || !Context.StringDistanceFunction)
+	{
+		UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Invalid matching context"));
+		return ReplyData;
+	}
+
+	const FDictionaryTermTable& TermTable = Context.Snapshot->TermTable;
+
+	// Only registered terms can be matched
+	TArray<uint32> Keywords;
+	Keywords.Reserve(KeywordTerms.Num());
+	for (const uint32 TermId : KeywordTerms)
+	{
+		if (TermTable.IsValidId(TermId))
+		{
+			Keywords.Add(TermId);
+		}
+	}
+
+#if !UE_BUILD_SHIPPING
+
+	FString StringDebugKeywords = "";
+	StringDebugKeywords.Reserve(Keywords.Num() * 10);
+	for (const uint32 Keyword : Keywords)
+	{
+		StringDebugKeywords += TermTable.GetTerm(Keyword) + TEXT(" ");
+	}
+	UE_LOG(LogPlayerNaturalDialogComponent, Log, TEXT("Founds keywords are: %s"), *StringDebugKeywords);
+
+#endif
+
+	if (!Keywords.IsValidIndex(0))
+	{
+		UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Empty keywords input array"));
+		return ReplyData;
+	}
+
+	const TArray<int32> TableSet = FindBestTables(Context, Keywords);
+
+#if !UE_BUILD_SHIPPING
+
+	FString DebugMessage = TEXT("Selected tables for reply: { ");
+	DebugMessage.Reserve(100);
+
+	for (const int32 TableIndex : TableSet)
+	{
+		DebugMessage += Context.NpcTables[TableIndex]->GetName() + " ";
+	}
+
+	DebugMessage += "}";
+	UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("%s"), *DebugMessage);
+
+#endif
+
+	// Now we check only selected tables
+	if (TableSet.Num() == 0)
+	{
+		return ReplyData;
+	}
+
+	ReplyData.Reserve(TableSet.Num());
+
+	// Lens of input keywords, used for absolute error of reply
+	TArray<int32> KeywordLens;
+	KeywordLens.Reserve(Keywords.Num());
+	for (const uint32 Keyword : Keywords)
+	{
+		KeywordLens.Add(TermTable.GetTerm(Keyword).Len());
+	}
+
+	for (const int32 TableIndex : TableSet)
+	{
+		const UDataTable* OutTable = Context.NpcTables[TableIndex];
+		if (!Context.NpcKeywordIndexes.IsValidIndex(TableIndex) || !Context.NpcKeywordIndexes[TableIndex].IsValid())
+		{
+			continue;
+		}
+
+		const FTableKeywordIndex& Index = *Context.NpcKeywordIndexes[TableIndex];
+		const int32 NumOfTableKeywords = Index.Keywords.Num();
+
+		// Compare input keywords with distinct table keywords, bit (TableKeyword * Keywords.Num() + InputKeyword) is set for match
+		TBitArray<> MatchedKeywords(false, NumOfTableKeywords * Keywords.Num());
+		TArray<int32> CandidateRows;
+
+		for (int32 TableKeywordIndex = 0; TableKeywordIndex < NumOfTableKeywords; TableKeywordIndex++)
+		{
+			const FString& TableKeyword = Index.Keywords[TableKeywordIndex];
+			const uint32 TableKeywordTerm = Index.KeywordTerms[TableKeywordIndex];
+			bool bIsMatched = false;
+
+			for (int32 InputKeywordIndex = 0; InputKeywordIndex < Keywords.Num(); InputKeywordIndex++)
+			{
+				// The same term is always matched, string distance is needed only for different terms
+				bool bIsKeywordMatched = Keywords[InputKeywordIndex] == TableKeywordTerm;
+				if (!bIsKeywordMatched)
+				{
+					const FString& InputKeyword = TermTable.GetTerm(Keywords[InputKeywordIndex]);
+					const int32 StringLenDifference = FMath::Abs(InputKeyword.Len() - TableKeyword.Len());
+					const int32 StringDistance = Context.StringDistanceFunction->GetStringDistanceBounded(InputKeyword, TableKeyword, StringLenDifference);
+					bIsKeywordMatched = FMath::Abs(StringDistance - StringLenDifference) == 0;
+				}
+
+				if (bIsKeywordMatched)
+				{
+					MatchedKeywords[TableKeywordIndex * Keywords.Num() + InputKeywordIndex] = true;
+					bIsMatched = true;
+				}
+			}
+
+			if (bIsMatched)
+			{
+				CandidateRows.Append(Index.KeywordRows[TableKeywordIndex]);
+			}
+		}
+
+		// Rows have to be checked in table order, because the first reply of the table with the same match count wins
+		CandidateRows.Sort();
+
+		int32 PreviousRow = INDEX_NONE;
+		for (const int32 RowIndex : CandidateRows)
+		{
+			if (RowIndex == PreviousRow)
+			{
+				continue;
+			}
+			PreviousRow = RowIndex;
+
+			// Find row with most keyword match
+			const FKeywordIndexRow& Row = Index.Rows[RowIndex];
+			int32 MatchCount = 0;
+			int32 AbsoluteError = 0;
+
+			for (int32 InputKeywordIndex = 0; InputKeywordIndex < Keywords.Num(); InputKeywordIndex++)
+			{
+				for (const int32 RowKeyword : Row.Keywords)
+				{
+					if (MatchedKeywords[RowKeyword * Keywords.Num() + InputKeywordIndex])
+					{
+						AbsoluteError += FMath::Abs(KeywordLens[InputKeywordIndex] - Index.Keywords[RowKeyword].Len());
+						MatchCount++;
+						break;
+					}
+				}
+			}
+
+			for (int32 AnswerIndex = 0; AnswerIndex < Row.NumOfAnswers; AnswerIndex++)
+			{
+				const FReplyData TempData = FReplyData(MatchCount, OutTable, Row.RowName, AnswerIndex, AbsoluteError);
+				const int32 DataIndex = ReplyData.Find(TempData);
+
+				// If any reply data with the same data table contains reply with equals num of keywords, then add this data asn new possibility to response, from these data we select with the hightest metric value
+				if (MatchCount > 0 && (DataIndex == INDEX_NONE || ReplyData[DataIndex].NumOfMatchedKeywords == TempData.NumOfMatchedKeywords))
+				{
+					// Allow only rows with min keywords match
+					if (TempData.NumOfMatchedKeywords >= Row.MinKeywordsMatch)
+					{
+						ReplyData.Add(TempData);
+					}
+				}
+				else if (DataIndex != INDEX_NONE && ReplyData[DataIndex].NumOfMatchedKeywords < TempData.NumOfMatchedKeywords)
+				{
+					ReplyData[DataIndex] = TempData;
+				}
+			}
+		}
+	}
+
+	return ReplyData;
+}
+
+TArray<FReplyData> UDefaultDialogReplyFunction::FindReplyCandidates(const FReplyMatchingContext& Context, const FString& Sentence)
+{
+	TArray<FReplyData> Candidates;
+
+	if (!Context.DictionarySubsystem)
+	{
+		return Candidates;
+	}
+
+	FString CacheKey;
+	if (Context.ReplyCache.IsValid())
+	{
+		CacheKey = FReplyCandidateCache::MakeKey(Sentence, Context.NpcTables);
+		if (Context.ReplyCache->Find(CacheKey, Context.NpcTables, Candidates))
+		{
+			return Candidates;
+		}
+	}
+
+	// Generated keywords of input sentence, after word correction they are compared only as term ids
+	const TArray<uint32> KeywordTerms = Context.DictionarySubsystem->GenerateKeywordTerms(Context.OwnerComponent, Sentence);
+	Candidates = MatchReplyCandidates(Context, KeywordTerms);
+
+	if (Context.ReplyCache.IsValid())
+	{
+		Context.ReplyCache->Add(CacheKey, Context.NpcTables, Candidates, Context.ReplyCacheGeneration);
+	}
+
+	return Candidates;
+}
+
+FReplyCacheStats UDefaultDialogReplyFunction::GetReplyCacheStats() const
+{
+	return ReplyCache.IsValid() ? ReplyCache->GetStats() : FReplyCacheStats();
+}
+
+TSet<const UDataTable*> UDefaultDialogReplyFunction::FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<FString>& Keywords) const
+{
+	TArray<uint32> KeywordTerms;
+	const FDictionarySnapshotPtr Snapshot = DictionarySubsystem.IsValid() ? DictionarySubsystem.Get()->GetSnapshot() : FDictionarySnapshotPtr();
+
+	if (Snapshot.IsValid())
+	{
+		// Unknown words are kept as invalid terms, so they are still part of keyword pairs
+		KeywordTerms.Reserve(Keywords.Num());
+		for (const FString& Keyword : Keywords)
+		{
+			KeywordTerms.Add(Snapshot->TermTable.Find(Keyword));
+		}
+	}
+
+	return FindBestTableSet(NpcNaturalDialogComponent, KeywordTerms);
+}
+
+TSet<const UDataTable*> UDefaultDialogReplyFunction::FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<uint32>& Keywords) const
+{
+	TSet<const UDataTable*> Result;
+
+	FReplyMatchingContext Context;
+	FillMatchingContext(NpcNaturalDialogComponent, Context);
+
+	for (const int32 TableIndex : FindBestTables(Context, Keywords))
+	{
+		Result.Add(Context.NpcTables[TableIndex]);
+	}
+
+	return Result;
+}
+
+TArray<int32> UDefaultDialogReplyFunction::FindBestTables(const FReplyMatchingContext& Context, const TArray<uint32>& Keywords)
+{
+	TArray<int32> Result;
+
+	if (!Keywords.IsValidIndex(0) || !Context.Snapshot.IsValid() || !Context.Snapshot->GetDictionary())
+	{
+		return Result;
+	}
+
+	// Bit index of table is its dense index in dictionary, @see FDictionaryTableRegistry
+	const FDictionaryTableRegistry& TableRegistry = Context.Snapshot->TableRegistry;
+	const TArray<const UDataTable*>& NpcTables = Context.NpcTables;
+	const int32 NumOfWords = TableRegistry.GetNumOfBitsetWords();
+
+	if (NumOfWords == 0 || NpcTables.Num() == 0)
+	{
+		return Result;
+	}
+
+	// Only tables which are available for NPC are interesting
+	TArray<uint64, TInlineAllocator<8>> NpcTablesMask;
+	NpcTablesMask.SetNumZeroed(NumOfWords);
+
+	for (const UDataTable* Table : NpcTables)
+	{
+		const int32 TableIndex = TableRegistry.Find(Table);
+		if (TableIndex != INDEX_NONE)
+		{
+			NpcTablesMask[TableIndex / 64] |= 1ull << (TableIndex % 64);
+		}
+	}
+
+	// Bitset of NPC tables for every keyword, bit is set if keyword is used in table
+	TArray<uint64, TInlineAllocator<64>> KeywordTables;
+	KeywordTables.SetNumZeroed(Keywords.Num() * NumOfWords);
+
+	for (int32 KeywordIndex = 0; KeywordIndex < Keywords.Num(); KeywordIndex++)
+	{
+		const FDictionaryData* DictData = Context.Snapshot->GetDictionary()->GetTermData(Keywords[KeywordIndex]);
+		if (DictData)
+		{
+			const TArray<uint64>& TermTables = DictData->GetTableBits();
+			const int32 NumOfTermWords = FMath::Min(TermTables.Num(), NumOfWords);
+
+			uint64* Bits = &KeywordTables[KeywordIndex * NumOfWords];
+			for (int32 Word = 0; Word < NumOfTermWords; Word++)
+			{
+				Bits[Word] = TermTables[Word] & NpcTablesMask[Word];
+			}
+		}
+	}
+
+	TArray<uint64, TInlineAllocator<8>> BestTables;
+	BestTables.SetNumUninitialized(NumOfWords);
+	FindBestTableBits(KeywordTables, NumOfWords, BestTables);
+
+	// Convert bitset back to tables
+	for (int32 NpcTableIndex = 0; NpcTableIndex < NpcTables.Num(); NpcTableIndex++)
+	{
+		const int32 TableIndex = TableRegistry.Find(NpcTables[NpcTableIndex]);
+		if (TableIndex != INDEX_NONE && (BestTables[TableIndex / 64] & (1ull << (TableIndex % 64))) != 0)
+		{
+			Result.Add(NpcTableIndex);
+		}
+	}
+
+	return Result;
+}
+
+void UDefaultDialogReplyFunction::FindBestTableBits(const TArrayView<const uint64>& KeywordTables, const int32 NumOfWords, const TArrayView<uint64>& OutTables)
+{
+	const int32 NumOfKeywords = NumOfWords > 0 ? KeywordTables.Num() / NumOfWords : 0;
+	check(OutTables.Num() >= NumOfWords);
+
+	if (NumOfKeywords == 0)
+	{
+		FMemory::Memzero(OutTables.GetData(), NumOfWords * sizeof(uint64));
+		return;
+	}
+
+	// Intersection of keyword tables can only shrink, when another keyword is added into combination
+	// So the biggest table set of all keyword combinations (with at least MinCombination keywords) is always intersection of a keywords pair
+	// Pairs are checked in the same order as combinations, so for equal sizes the first pair wins
+	int32 BestFirst = 0;
+	int32 BestSecond = NumOfKeywords < MinCombination ? 0 : 1;
+	int32 BestSize = -1;
+
+	for (int32 First = 0; First < NumOfKeywords; First++)
+	{
+		const uint64* FirstBits = &KeywordTables[First * NumOfWords];
+
+		for (int32 Second = First + 1; Second < NumOfKeywords; Second++)
+		{
+			const uint64* SecondBits = &KeywordTables[Second * NumOfWords];
+
+			int32 Size = 0;
+			for (int32 Word = 0; Word < NumOfWords; Word++)
+			{
+				Size += FPlatformMath::CountBits(FirstBits[Word] & SecondBits[Word]);
+			}
+
+			if (Size > BestSize)
+			{
+				BestSize = Size;
+				BestFirst = First;
+				BestSecond = Second;
+			}
+		}
+	}
+
+	const uint64* FirstBits = &KeywordTables[BestFirst * NumOfWords];
+	const uint64* SecondBits = &KeywordTables[BestSecond * NumOfWords];
+
+	for (int32 Word = 0; Word < NumOfWords; Word++)
+	{
+		OutTables[Word] = FirstBits[Word] & SecondBits[Word];
+	}
+}
+
+TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe> UDefaultDialogReplyFunction::FindOrBuildKeywordIndex(const UDataTable* InTable)
+{
+	TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe>* Index = KeywordIndexes.Find(InTable);
+	if (!Index)
+	{
+		const FDictionarySnapshotPtr Snapshot = DictionarySubsystem.IsValid() ? DictionarySubsystem.Get()->GetSnapshot() : FDictionarySnapshotPtr();
+		const TSharedRef<FTableKeywordIndex, ESPMode::ThreadSafe> NewIndex = MakeShared<FTableKeywordIndex, ESPMode::ThreadSafe>();
+		NewIndex->Build(InTable, Snapshot.IsValid() ? &Snapshot->TermTable : nullptr);
+		Index = &KeywordIndexes.Add(InTable, NewIndex);
+	}
+
+	return *Index;
+}
+
+void UDefaultDialogReplyFunction::FillMatchingContext(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FReplyMatchingContext& Context) const
+{
+	Context.DictionarySubsystem = DictionarySubsystem.Get();
+	Context.Snapshot = DictionarySubsystem.IsValid() ? DictionarySubsystem.Get()->GetSnapshot() : FDictionarySnapshotPtr();
+	Context.StringDistanceFunction = StringDistanceFunction;
+	Context.OwnerComponent = OwnerComponent.Get();
+	Context.ReplyCache = ReplyCache;
+	Context.ReplyCacheGeneration = ReplyCache.IsValid() ? ReplyCache->GetGeneration() : 0;
+
+	if (OwnerComponent.IsValid())
+	{
+		Context.NpcTables = OwnerComponent.Get()->GetDialogTables_Const(NpcNaturalDialogComponent).Array();
+	}
+}
+
+FReplyMatchingContext UDefaultDialogReplyFunction::MakeMatchingContext(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent)
+{
+	check(IsInGameThread());
+
+	FReplyMatchingContext Context;
+	FillMatchingContext(NpcNaturalDialogComponent, Context);
+
+	Context.NpcKeywordIndexes.Reserve(Context.NpcTables.Num());
+	for (const UDataTable* Table : Context.NpcTables)
+	{
+		Context.NpcKeywordIndexes.Add(FindOrBuildKeywordIndex(Table));
+	}
+
+	return Context;
+}
+
+void UDefaultDialogReplyFunction::HandleNewTableRegistration(const UDataTable* NewTable)
+{
+	if (NewTable)
+	{
+		// Prepare keywords of table, so they are not normalized during reply generation
+		FindOrBuildKeywordIndex(NewTable);
+
+		// Table set of NPC is changed
+		if (ReplyCache.IsValid())
+		{
+			ReplyCache->InvalidateTable(NewTable);
+		}
+
+		FDialogMetricRow& StoredValue = Metric.Add(NewTable, FDialogMetricRow());
+
+		if (NewTable->GetRowStruct()->IsChildOf(FNaturalDialogRow_Base::StaticStruct()))
+		{
+			// FNaturalDialogRow_Base for now appears only one time, for default response values
+			NewTable->ForeachRow<FNaturalDialogRow_Base>("Creating metrics values", [&StoredValue](const FName& Key, const FNaturalDialogRow_Base& Value)
+			{
+				const int32 NumOfAnswers = Value.Answer.Num();
+				StoredValue.Add(Key, NumOfAnswers);
+			});
+		}
+
+		UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Creating metric values for table %s"), *NewTable->GetName());
+	}
+}
+
+void UDefaultDialogReplyFunction::HandleRegisteredTableRemoved(const UDataTable* NewTable)
+{
+	Metric.Remove(NewTable);
+	KeywordIndexes.Remove(NewTable);
+
+	if (ReplyCache.IsValid())
+	{
+		ReplyCache->InvalidateTable(NewTable);
+	}
+
+	UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Removing metric values for table %s"), *NewTable->GetName());
+}
+
+void UDefaultDialogReplyFunction::HandleDictionarySnapshotChanged(const FDictionarySnapshotPtr& NewSnapshot)
+{
+	// Keywords are normalized only once, when index is built, the new snapshot can only add term ids
+	if (NewSnapshot.IsValid())
+	{
+		for (TPair<const UDataTable*, TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe>>& Pair : KeywordIndexes)
+		{
+			if (Pair.Value.IsValid())
+			{
+				// Running matching keeps old index, it is shared with its context
+				const TSharedPtr<FTableKeywordIndex, ESPMode::ThreadSafe> ResolvedIndex = Pair.Value->ResolveNewTerms(NewSnapshot->TermTable);
+				if (ResolvedIndex.IsValid())
+				{
+					Pair.Value = ResolvedIndex;
+				}
+			}
+		}
+	}
+
+	// Keywords of cached sentences could be corrected to the new terms
+	if (ReplyCache.IsValid())
+	{
+		ReplyCache->InvalidateAll();
+	}
+}
+
+void UDefaultDialogReplyFunction::HandleMatrixWeariness()
+{
+	for (TPair<const UDataTable*, FDialogMetricRow> Pair : Metric)
+	{
+		for (float* MetricValue : Pair.Value.GetAllWearinessValues())
+		{
+			if (FMath::RandBool())
+			{
+				*MetricValue *= FMath::Clamp(*MetricValue * 1.1f, 0.f, 1.f);
+			}
+		}
+	}
+
+	// Log metric values into log
+	// Slow operation, but perfect for debugging
+	LogMetricValues();
+}
+
+bool UDefaultDialogReplyFunction::UpdateDictionaryReferences()
+{
+	if (!DictionarySubsystem.IsValid())
+	{
+		const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
+		DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
+		UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Invalid dictionary subsystem reference, setting new one"));
+	}
+
+	// Dictionary representation is taken from subsystem snapshot for every reply, so it is never outdated
+	if (!DictionarySubsystem.IsValid() || !DictionarySubsystem.Get()->GetDictionary())
+	{
+		UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Invalid dictionary representation ptr value"));
+		return false;
+	}
+
+	return true;
+}
+
+FReplyData UDefaultDialogReplyFunction::FindBestReply(const TArray<FReplyData>& AllReplies) const
+{
+	FReplyData Result;
+
+	if (AllReplies.IsValidIndex(0))
+	{
+		// Find all elements with highness value
+		TArray<int32> ElementIndexes;
+		int32 MaxValue = INDEX_NONE;
+		int32 MinError = INT_MAX;
+		for (int32 i = 0; i < AllReplies.Num(); i++)
+		{
+			const int32 NewMaxValue = AllReplies[i].NumOfMatchedKeywords;
+			const int32 NewError = AllReplies[i].AbsoluteError;
+
+			if (NewMaxValue == MaxValue && NewError == MinError)
+			{
+				ElementIndexes.Add(i);
+			}
+			else if (NewMaxValue >= MaxValue && NewError < MinError) // Find with maximum keyword match, but with minimum len distance error
+			{
+				MaxValue = NewMaxValue;
+				MinError = NewError;
+				ElementIndexes.Reset(5);
+				ElementIndexes.Add(i);
+			}
+		}
+
+		// Now from all max values we choose one with best metric value
+		const FReplyData* BestResultData = &AllReplies[ElementIndexes[0]];
+
+		for (int32 i = 1; i < ElementIndexes.Num(); i++)
+		{
+			const FDialogMetricRow* BestRow = Metric.Find(BestResultData->InTable);
+			const FDialogMetricRow* CurrentRow = Metric.Find(AllReplies[i].InTable);
+			if (ensure(BestRow && CurrentRow))
+			{
+				for (int32 AnswerIndex = 0; AnswerIndex < CurrentRow->GetNumOfAnswers(); AnswerIndex++)
+				{
+					const float BestValue = BestRow->GetEvalValue(BestResultData->RowName, BestResultData->AnswerIndex);
+					const float CurrentValue = CurrentRow->GetEvalValue(AllReplies[i].RowName, AnswerIndex);
+					if (BestValue < CurrentValue)
+					{
+						BestResultData = &AllReplies[i];
+					}
+				}
+			}
+		}
+
+		Result = *BestResultData;
+	}
+
+	return Result;
+}
+
+void UDefaultDialogReplyFunction::ModifyMetricValue(const UDataTable* InTable, const FName InRow, const int32 AnswerIndex)
+{
+	if (InTable)
+	{
+		FDialogMetricRow* MetricData = Metric.Find(InTable);
+		if (MetricData)
+		{
+			float& MetricValue = MetricData->GetWearinessValueRef(InRow, AnswerIndex);
+			if (MetricCurve)
+			{
+				// Curve metric calculation
+				const float NewValue = MetricCurve->GetFloatValue(MetricValue);
+				UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Metric has changed (%s | %s), (old value = %f, new value = %f)"), *InTable->GetName(), *InRow.ToString(), MetricValue, NewValue);
+				MetricValue = NewValue;
+			}
+			else
+			{
+				// Default metric calculation
+				const float NewValue = FMath::Clamp(MetricValue * 0.5f, 0.01f, 1.f);
+				UE_LOG(Log_DefaultDialogReplyFunction, Log, TEXT("Metric has changed (%s | %s), (old value = %f, new value = %f)"), *InTable->GetName(), *InRow.ToString(), MetricValue, NewValue);
+				MetricValue = NewValue;
+
+				UE_LOG(Log_DefaultDialogReplyFunction, Warning, TEXT("Curve isn ont set, for metric calculation"));
+			}
+
+			// Log metric values into log
+			// Slow operation, but perfect for debugging
+			LogMetricValues();
+		}
+		else
+		{
+			UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Metric doesn't contain data table data (%s)"), *InTable->GetName());
+		}
+	}
+	else
+	{
+		UE_LOG(Log_DefaultDialogReplyFunction, Error, TEXT("Input table is not valid in function ModifyMetricValue()"));
+	}
+}
+
+void UDefaultDialogReplyFunction::LogMetricValues()
+{
+	// #todo ... finish this
+
+#if !UE_BUILD_SHIPPING
+
+	// static FString Rows = TEXT("   Rows > ");
+	// static FString Columns = TEXT("V Tables ");
+	// static FString VertSeparator = TEXT("||");
+	// static FString HorizSeparator = TEXT("=");
+	//
+	// TArray<int32> TablesLens;
+	// for (const TPair<const UDataTable*, FDialogMetricRow>& Table : Metric)
+	// {
+	// 	TablesLens.Add(Table.Value.Num());
+	// }
+	//
+	// int32 TempIndex;
+	// const int32 NumOfColumns = FMath::Max(TablesLens, &TempIndex);
+	// const int32 Abc = FString::FromInt(NumOfColumns).Len();
+	//
+	// FString Result = "Metric values\n" + Rows + VertSeparator + "\n"; // First line
+	// Result.Append(Columns + VertSeparator);                           // Second line
+	//
+	// for (int32 i = 0; i < NumOfColumns; i++)
+	// {
+	// 	Result.Append(" Row " + FString::FromInt(i + 1) + " ");
+	// }
+
+#endif
+}
@@ -1,108 +1,297 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "DefaultClasses/DefaultDictionaryPickerFunction.h"
-
-#include "DefaultClasses/LevenshteinDistanceFunction.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "Resources/DictionaryRepresentation.h"
-
-
-DEFINE_LOG_CATEGORY(Log_DefaultDictPickerFunction);
-
-void UDefaultDictionaryPickerFunction::InitializeWordPicker()
-{
-	Super::InitializeWordPicker();
-
-	CachedDictionarySubsystem = Cast<UDictionarySubsystem>(GetOuter());
-}
-
-FString UDefaultDictionaryPickerFunction::PickWordFromDictionary(const FString& Input) const
-{
-	FString Result;
-	const int32 InputLen = Input.Len();
-	const UDictionarySubsystem* DictionarySubsystem = nullptr;
-
-	// Cache dictionary subsystem which we use
-	if (CachedDictionarySubsystem.IsValid())
-	{
-		DictionarySubsystem = CachedDictionarySubsystem.Get();
-	}
-	else
-	{
-		UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
-		if (GameInstance)
-		{
-			DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
-		}
-	}
-
-	// If is dict subsystem invalid, we don't allow words picking
-	if (!DictionarySubsystem)
-	{
-		UE_LOG(Log_DefaultDictPickerFunction, Error, TEXT("Failed to retrieve dictionary subsystem"));
-		return Result;
-	}
-
-	// Retrieve word from dict data
-	if (InputLen > 0)
-	{
-		const UDictionaryRepresentation* DictionaryRepresentation = DictionarySubsystem->GetDictionary();
-		if (ensure(DictionaryRepresentation && StringMetricDistanceFunctionInstance))
-		{
-			//const FString NormalizedInput = UNaturalDialogSystemLibrary::NormalizeTerm(Input);
-			int32 MinErrorC = MAX_int32;
-			FString WordWithMinEvaluation;
-			for (int32 SubstituteLen = 0; SubstituteLen < MAX_LEN_DIFF; SubstituteLen++)
-			{
-				// Find all words of len
-				TArray<FString> Words = DictionaryRepresentation->GetListOfWordsOfLen(InputLen + SubstituteLen);
-				if (SubstituteLen > 0)
-				{
-					Words.Append(DictionaryRepresentation->GetListOfWordsOfLen(InputLen - SubstituteLen));
-				}
-
-				TArray<int32> WordsEvaluation;
-				WordsEvaluation.Reserve(Words.Num());
-
-				for (const FString& Word : Words)
-				{
-					// const FString NormalizedWord = UNaturalDialogSystemLibrary::NormalizeTerm(Word);
-					const int32 Evaluation = StringMetricDistanceFunctionInstance->GetStringDistance(Word, Input);
-					if (Evaluation == 0)
-					{
-						return Word; // <==== End here, found correct word
-					}
-
-					WordsEvaluation.Add(Evaluation);
-				}
-
-				// Save found word data
-				int32 Index;
-				int32 NewMinErrorC;
-				UKismetMathLibrary::MinOfIntArray(WordsEvaluation, Index, NewMinErrorC);
-
-				if (Index != INDEX_NONE && NewMinErrorC < MinErrorC && NewMinErrorC < Words[Index].Len() - 1)
-				{
-					MinErrorC = NewMinErrorC;
-					WordWithMinEvaluation = Words[Index];
-				}
-
-				// Check stop criteria if word len is too different from input, we use this stop criteria 
-				if (MinErrorC <= SubstituteLen)
-				{
-					break;
-				}
-			}
-
-			return WordWithMinEvaluation;
-		}
-	}
-	else
-	{
-		UE_LOG(Log_DefaultDictPickerFunction, Warning, TEXT("Empty input text"));
-	}
-
-	return Result;
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/DefaultDictionaryPickerFunction.h"
+
+#include "Async/ParallelFor.h"
+#include "DefaultClasses/LevenshteinDistanceFunction.h"
+#include "Kismet/GameplayStatics.h"
+#include "Resources/DictionaryRepresentation.h"
+
+
+DEFINE_LOG_CATEGORY(Log_DefaultDictPickerFunction);
+
+namespace DefaultDictionaryPicker
+{
+	/** Num of words scanned by one parallel task */
+	constexpr int32 ChunkSize = 512;
+
+	/** Range of bucket scanned by one parallel task */
+	struct FScanChunk
+	{
+		int32 WordLen;
+		int32 FirstWord;
+		int32 NumOfWords;
+	};
+
+	/** The best word of chunk, the first word of chunk wins between words with the same distance */
+	struct FChunkResult
+	{
+		FChunkResult()
+			: Distance(MAX_int32) {}
+
+		int32 Distance;
+		FString Word;
+	};
+}
+
+UDefaultDictionaryPickerFunction::UDefaultDictionaryPickerFunction()
+{
+	MaxNearestWordDistance = MAX_LEN_DIFF - 1;
+	bParallelCandidateScan = false;
+	MinParallelScanWords = 8192;
+}
+
+void UDefaultDictionaryPickerFunction::InitializeWordPicker()
+{
+	Super::InitializeWordPicker();
+
+	CachedDictionarySubsystem = Cast<UDictionarySubsystem>(GetOuter());
+}
+
+FString UDefaultDictionaryPickerFunction::PickWordFromDictionary(const FString& Input) const
+{
+	FString Result;
+	const int32 InputLen = Input.Len();
+	const UDictionarySubsystem* DictionarySubsystem = nullptr;
+
+	// Cache dictionary subsystem which we use
+	if (CachedDictionarySubsystem.IsValid())
+	{
+		DictionarySubsystem = CachedDictionarySubsystem.Get();
+	}
+	else
+	{
+		UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
+		if (GameInstance)
+		{
+			DictionarySubsystem = GameInstance->GetSubsystem<UDictionarySubsystem>();
+		}
+	}
+
+	// If is dict subsystem invalid, we don't allow words picking
+	if (!DictionarySubsystem)
+	{
+		UE_LOG(Log_DefaultDictPickerFunction, Error, TEXT("Failed to retrieve dictionary subsystem"));
+		return Result;
+	}
+
+	// Retrieve word from dict data
+	if (InputLen > 0)
+	{
+		// Snapshot is held for whole correction, so the dictionary can't be released during it
+		const FDictionarySnapshotPtr Snapshot = DictionarySubsystem->GetSnapshot();
+		const UDictionaryRepresentation* DictionaryRepresentation = Snapshot.IsValid() ? Snapshot->GetDictionary() : nullptr;
+
+		// Representation has own index, so we don't need to scan buckets of words
+		if (DictionaryRepresentation && DictionaryRepresentation->SupportsNearestWordLookup())
+		{
+			FString NearestWord;
+			int32 Distance = MAX_int32;
+			if (DictionaryRepresentation->FindNearestWord(Input, MaxNearestWordDistance, NearestWord, Distance) && (Distance == 0 || Distance < NearestWord.Len() - 1))
+			{
+				return NearestWord;
+			}
+
+			return Result;
+		}
+
+		if (ensure(DictionaryRepresentation && StringMetricDistanceFunctionInstance))
+		{
+			// Words are visited without copying, only the best word of iteration is copied, because view is valid only in visitor
+			// Representation skips words, which can't be better than the current best by their signature
+			const bool bUseSignatures = StringMetricDistanceFunctionInstance->IsEditDistance();
+			int32 MinErrorC = MAX_int32;
+			FString WordWithMinEvaluation;
+			for (int32 SubstituteLen = 0; SubstituteLen < MAX_LEN_DIFF; SubstituteLen++)
+			{
+				// Only words better than current best are interesting, so distance function can stop early for others
+				int32 IterationMinErrorC = MinErrorC;
+				FString IterationWord;
+				bool bFoundCorrectWord = false;
+
+				const auto VisitWord = [this, &Input, &IterationMinErrorC, &IterationWord, &bFoundCorrectWord](const FStringView& Word)
+				{
+					const int32 Evaluation = StringMetricDistanceFunctionInstance->GetStringViewDistanceBounded(Word, Input, IterationMinErrorC - 1);
+					if (Evaluation == 0)
+					{
+						IterationWord = FString(Word.Len(), Word.GetData());
+						bFoundCorrectWord = true;
+						return 0;
+					}
+
+					if (Evaluation < IterationMinErrorC)
+					{
+						IterationMinErrorC = Evaluation;
+						IterationWord = FString(Word.Len(), Word.GetData());
+					}
+
+					return IterationMinErrorC;
+				};
+
+				const auto VisitWordsOfLen = [DictionaryRepresentation, bUseSignatures, &Input, &IterationMinErrorC, &VisitWord](const int32 WordLen)
+				{
+					if (bUseSignatures)
+					{
+						DictionaryRepresentation->ForEachCandidateOfLen(WordLen, Input, IterationMinErrorC, VisitWord);
+					}
+					else
+					{
+						DictionaryRepresentation->ForEachWordOfLen(WordLen, [&VisitWord](const FStringView& Word) { return VisitWord(Word) > 0; });
+					}
+				};
+
+				TArray<int32, TInlineAllocator<2>> WordLens;
+				WordLens.Add(InputLen + SubstituteLen);
+				if (SubstituteLen > 0 && InputLen - SubstituteLen > 0)
+				{
+					WordLens.Add(InputLen - SubstituteLen);
+				}
+
+				if (ScanWordsInParallel(DictionaryRepresentation, Input, WordLens, IterationMinErrorC, IterationMinErrorC, IterationWord))
+				{
+					bFoundCorrectWord = IterationMinErrorC == 0;
+				}
+				else
+				{
+					// Check all words of len
+					for (int32 i = 0; i < WordLens.Num() && !bFoundCorrectWord; i++)
+					{
+						VisitWordsOfLen(WordLens[i]);
+					}
+				}
+
+				if (bFoundCorrectWord)
+				{
+					return IterationWord; // <==== End here, found correct word
+				}
+
+				// Save found word data
+				if (IterationWord.Len() > 0 && IterationMinErrorC < IterationWord.Len() - 1)
+				{
+					MinErrorC = IterationMinErrorC;
+					WordWithMinEvaluation = MoveTemp(IterationWord);
+				}
+
+				// Check stop criteria if word len is too different from input, we use this stop criteria 
+				if (MinErrorC <= SubstituteLen)
+				{
+					break;
+				}
+			}
+
+			return WordWithMinEvaluation;
+		}
+	}
+	else
+	{
+		UE_LOG(Log_DefaultDictPickerFunction, Warning, TEXT("Empty input text"));
+	}
+
+	return Result;
+}
+
+bool UDefaultDictionaryPickerFunction::ScanWordsInParallel(const UDictionaryRepresentation* DictionaryRepresentation, const FString& Input, const TArray<int32, TInlineAllocator<2>>& WordLens, const int32 DistanceLimit, int32& OutDistance, FString& OutWord) const
+{
+	using namespace DefaultDictionaryPicker;
+
+	if (!bParallelCandidateScan || DistanceLimit <= 0)
+	{
+		return false;
+	}
+
+	// Chunks are in order of serial scan, so order of chunks decides between words with the same distance
+	TArray<FScanChunk> Chunks;
+	int32 NumOfWords = 0;
+
+	for (const int32 WordLen : WordLens)
+	{
+		const int32 NumOfBucketWords = DictionaryRepresentation->GetNumOfWordsOfLen(WordLen);
+		if (NumOfBucketWords == INDEX_NONE)
+		{
+			return false;
+		}
+
+		for (int32 FirstWord = 0; FirstWord < NumOfBucketWords; FirstWord += ChunkSize)
+		{
+			Chunks.Add({WordLen, FirstWord, FMath::Min(ChunkSize, NumOfBucketWords - FirstWord)});
+		}
+		NumOfWords += NumOfBucketWords;
+	}
+
+	if (NumOfWords < MinParallelScanWords)
+	{
+		return false;
+	}
+
+	const UStringDistanceFunction* DistanceFunction = StringMetricDistanceFunctionInstance;
+	const bool bUseSignatures = DistanceFunction->IsEditDistance();
+
+	// Max distance of word, which can still be picked, shared by all tasks
+	// Words with the same distance as the best word of other task are still measured, because they can be earlier in order
+	volatile int32 SharedMaxDistance = DistanceLimit - 1;
+
+	TArray<FChunkResult> Results;
+	Results.SetNum(Chunks.Num());
+
+	ParallelFor(Chunks.Num(), [DictionaryRepresentation, DistanceFunction, bUseSignatures, &Input, &Chunks, &Results, &SharedMaxDistance](const int32 ChunkIndex)
+	{
+		const FScanChunk& Chunk = Chunks[ChunkIndex];
+		FChunkResult& Result = Results[ChunkIndex];
+
+		const auto GetLimit = [bUseSignatures, &Result, &SharedMaxDistance]()
+		{
+			const int32 Limit = FMath::Min(Result.Distance, FPlatformAtomics::AtomicRead(&SharedMaxDistance) + 1);
+			return bUseSignatures || Limit <= 0 ? Limit : MAX_int32;
+		};
+
+		DictionaryRepresentation->ForEachCandidateInRange(Chunk.WordLen, Chunk.FirstWord, Chunk.NumOfWords, Input, GetLimit(), [DistanceFunction, &Input, &Result, &SharedMaxDistance, &GetLimit](const FStringView& Word)
+		{
+			// Word of chunk has to be strictly better than previous word of chunk
+			const int32 MaxDistance = FMath::Min(Result.Distance - 1, FPlatformAtomics::AtomicRead(&SharedMaxDistance));
+			if (MaxDistance < 0)
+			{
+				return 0;
+			}
+
+			const int32 Evaluation = DistanceFunction->GetStringViewDistanceBounded(Word, Input, MaxDistance);
+			if (Evaluation <= MaxDistance)
+			{
+				Result.Distance = Evaluation;
+				Result.Word = FString(Word.Len(), Word.GetData());
+
+				// Other tasks can stop measuring of worse words
+				int32 CurrentMaxDistance = FPlatformAtomics::AtomicRead(&SharedMaxDistance);
+				while (Evaluation < CurrentMaxDistance)
+				{
+					const int32 PreviousMaxDistance = FPlatformAtomics::InterlockedCompareExchange(&SharedMaxDistance, Evaluation, CurrentMaxDistance);
+					if (PreviousMaxDistance == CurrentMaxDistance)
+					{
+						break;
+					}
+					CurrentMaxDistance = PreviousMaxDistance;
+				}
+			}
+
+			return GetLimit();
+		});
+	});
+
+	// The first chunk with the smallest distance, the same word as serial scan finds
+	const FChunkResult* BestResult = nullptr;
+	for (const FChunkResult& Result : Results)
+	{
+		if (Result.Distance < DistanceLimit && (!BestResult || Result.Distance < BestResult->Distance))
+		{
+			BestResult = &Result;
+		}
+	}
+
+	if (BestResult)
+	{
+		OutDistance = BestResult->Distance;
+		OutWord = BestResult->Word;
+	}
+
+	return true;
+}
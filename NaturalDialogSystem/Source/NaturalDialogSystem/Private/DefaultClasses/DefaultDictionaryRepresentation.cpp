@@ -1,82 +1,316 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "DefaultClasses/DefaultDictionaryRepresentation.h"
-
-#include "Resources/NaturalDialogSystemLibrary.h"
-#include "Resources/Resources.h"
-
-void UDefaultDictionaryRepresentation::InitializeDictionary()
-{
-	Super::InitializeDictionary();
-
-	// In every bucket are words of same len, in first value are words with len == 1, at second with len == 2, ...
-	DictionaryData.SetNum(10);
-}
-
-void UDefaultDictionaryRepresentation::RegisterWord(const FString& Word, const UDataTable* FromDataTable)
-{
-	const int32 WordLen = Word.Len();
-	if (WordLen > 0)
-	{
-		const int32 FixedLen = WordLen - 1;
-
-		if (DictionaryData.Num() <= FixedLen)
-		{
-			// If bucket with (len == WordLen) doesn't exist, we have to extend the array
-			DictionaryData.AddDefaulted(WordLen - DictionaryData.Num());
-		}
-
-		FDictionaryData* Data = DictionaryData[FixedLen].Find(Word);
-		if (Data)
-		{
-			// We found data in table, now we add new occurence into these data
-			Data->AddOccurence(FromDataTable);
-		}
-		else
-		{
-			// Or we just create new data in dictionary
-			DictionaryData[FixedLen].Add(UNaturalDialogSystemLibrary::NormalizeTerm(Word), FDictionaryData(FromDataTable));
-		}
-	}
-}
-
-TArray<FString> UDefaultDictionaryRepresentation::GetListOfWords() const
-{
-	TArray<FString> Result;
-
-	for (const TMap<FString, FDictionaryData>& Map : DictionaryData)
-	{
-		TArray<FString> Temp;
-		Map.GetKeys(Temp);
-		Result.Append(Temp);
-	}
-
-	return Result;
-}
-
-TArray<FString> UDefaultDictionaryRepresentation::GetListOfWordsOfLen(const int32 WordLen) const
-{
-	TArray<FString> OutKeys;
-	const int32 FixedWordLen = WordLen - 1;
-
-	if (DictionaryData.IsValidIndex(FixedWordLen))
-	{
-		DictionaryData[FixedWordLen].GetKeys(OutKeys);
-	}
-
-	return OutKeys;
-}
-
-
-const FDictionaryData* UDefaultDictionaryRepresentation::GetWordData(const FString& Word) const
-{
-	const int32 FixedWordLen = Word.Len() - 1;
-
-	if (DictionaryData.IsValidIndex(FixedWordLen))
-	{
-		return DictionaryData[FixedWordLen].Find(Word);
-	}
-
-	return nullptr;
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/DefaultDictionaryRepresentation.h"
+
+#include "Resources/NaturalDialogSystemLibrary.h"
+#include "Resources/Resources.h"
+
+void UDefaultDictionaryRepresentation::InitializeDictionary()
+{
+	Super::InitializeDictionary();
+
+	// In every bucket are words of same len, in first value are words with len == 1, at second with len == 2, ...
+	DictionaryData.SetNum(10);
+	WordsData.Reset();
+	TermWords.Reset();
+	FreeWordsData.Reset();
+}
+
+void UDefaultDictionaryRepresentation::RegisterWord(const FString& Word, const UDataTable* FromDataTable)
+{
+	// Word without term id can be found only by string
+	RegisterTerm(Word, INVALID_TERM_ID, FromDataTable);
+}
+
+void UDefaultDictionaryRepresentation::RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	const int32 WordLen = Word.Len();
+	if (WordLen > 0)
+	{
+		const int32 FixedLen = WordLen - 1;
+
+		if (DictionaryData.Num() <= FixedLen)
+		{
+			// If bucket with (len == WordLen) doesn't exist, we have to extend the array
+			DictionaryData.AddDefaulted(WordLen - DictionaryData.Num());
+		}
+
+		const int32* WordIndex = DictionaryData[FixedLen].Find(Word);
+		if (WordIndex)
+		{
+			// We found data in table, now we add new occurence into these data
+			FDictionaryData& Data = WordsData[*WordIndex];
+			Data.AddOccurence(RegisterTable(FromDataTable));
+
+			if (Data.GetTermId() == INVALID_TERM_ID && TermId != INVALID_TERM_ID)
+			{
+				Data.SetTermId(TermId);
+				MapTermToWord(TermId, *WordIndex);
+			}
+		}
+		else
+		{
+			// Or we just create new data in dictionary, data of removed word are reused
+			int32 NewIndex = INDEX_NONE;
+			if (FreeWordsData.Num() > 0)
+			{
+				NewIndex = FreeWordsData.Pop(false);
+				WordsData[NewIndex] = FDictionaryData(TermId, RegisterTable(FromDataTable));
+			}
+			else
+			{
+				NewIndex = WordsData.Emplace(TermId, RegisterTable(FromDataTable));
+			}
+
+			DictionaryData[FixedLen].Add(UNaturalDialogSystemLibrary::NormalizeTerm(Word), NewIndex);
+			MapTermToWord(TermId, NewIndex);
+		}
+	}
+}
+
+bool UDefaultDictionaryRepresentation::UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+{
+	const int32 FixedLen = Word.Len() - 1;
+	if (!DictionaryData.IsValidIndex(FixedLen))
+	{
+		return true;
+	}
+
+	const int32* WordIndex = DictionaryData[FixedLen].Find(Word);
+	if (WordIndex && TableRegistry)
+	{
+		FDictionaryData& Data = WordsData[*WordIndex];
+		Data.RemoveOccurences(TableRegistry->Find(FromDataTable), 1);
+
+		// Word is not used in any table, so it can't be picked anymore
+		if (Data.IsEmpty())
+		{
+			if (TermWords.IsValidIndex(static_cast<int32>(Data.GetTermId())))
+			{
+				TermWords[Data.GetTermId()] = INDEX_NONE;
+			}
+
+			Data = FDictionaryData();
+			FreeWordsData.Add(*WordIndex);
+			DictionaryData[FixedLen].Remove(Word);
+		}
+	}
+
+	return true;
+}
+
+bool UDefaultDictionaryRepresentation::CopyDictionary(const UDictionaryRepresentation* Other)
+{
+	const UDefaultDictionaryRepresentation* OtherDictionary = Cast<UDefaultDictionaryRepresentation>(Other);
+	if (!OtherDictionary || OtherDictionary->GetClass() != GetClass())
+	{
+		return false;
+	}
+
+	// Table indexes of word data are valid, because table registry is copied with snapshot
+	DictionaryData = OtherDictionary->DictionaryData;
+	WordsData = OtherDictionary->WordsData;
+	TermWords = OtherDictionary->TermWords;
+	FreeWordsData = OtherDictionary->FreeWordsData;
+	return true;
+}
+
+TArray<FString> UDefaultDictionaryRepresentation::GetListOfWords() const
+{
+	TArray<FString> Result;
+
+	for (const TMap<FString, int32>& Map : DictionaryData)
+	{
+		TArray<FString> Temp;
+		Map.GetKeys(Temp);
+		Result.Append(Temp);
+	}
+
+	return Result;
+}
+
+TArray<FString> UDefaultDictionaryRepresentation::GetListOfWordsOfLen(const int32 WordLen) const
+{
+	TArray<FString> OutKeys;
+	const int32 FixedWordLen = WordLen - 1;
+
+	if (DictionaryData.IsValidIndex(FixedWordLen))
+	{
+		DictionaryData[FixedWordLen].GetKeys(OutKeys);
+	}
+
+	return OutKeys;
+}
+
+void UDefaultDictionaryRepresentation::ForEachWordOfLen(const int32 WordLen, TFunctionRef<bool(const FStringView& Word)> Visitor) const
+{
+	const int32 FixedWordLen = WordLen - 1;
+
+	if (DictionaryData.IsValidIndex(FixedWordLen))
+	{
+		for (const TPair<FString, int32>& Pair : DictionaryData[FixedWordLen])
+		{
+			if (!Visitor(Pair.Key))
+			{
+				return;
+			}
+		}
+	}
+}
+
+const FDictionaryData* UDefaultDictionaryRepresentation::GetWordData(const FString& Word) const
+{
+	const int32 FixedWordLen = Word.Len() - 1;
+
+	if (DictionaryData.IsValidIndex(FixedWordLen))
+	{
+		const int32* WordIndex = DictionaryData[FixedWordLen].Find(Word);
+		if (WordIndex)
+		{
+			return &WordsData[*WordIndex];
+		}
+	}
+
+	return nullptr;
+}
+
+const FDictionaryData* UDefaultDictionaryRepresentation::GetTermData(const uint32 TermId) const
+{
+	const int32 TermIndex = static_cast<int32>(TermId);
+
+	if (TermWords.IsValidIndex(TermIndex) && TermWords[TermIndex] != INDEX_NONE)
+	{
+		return &WordsData[TermWords[TermIndex]];
+	}
+
+	return nullptr;
+}
+
+bool UDefaultDictionaryRepresentation::SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const
+{
+	// Dense table indexes are remapped to index of Tables, so the index doesn't depend on order of registration
+	TArray<int32> TableRemap;
+	if (TableRegistry)
+	{
+		TableRemap.Reserve(TableRegistry->Num());
+		for (int32 TableIndex = 0; TableIndex < TableRegistry->Num(); TableIndex++)
+		{
+			TableRemap.Add(Tables.IndexOfByKey(TableRegistry->GetTable(TableIndex)));
+		}
+	}
+
+	int32 NumOfBuckets = DictionaryData.Num();
+	Ar << NumOfBuckets;
+
+	for (const TMap<FString, int32>& Bucket : DictionaryData)
+	{
+		int32 NumOfWords = Bucket.Num();
+		Ar << NumOfWords;
+
+		for (const TPair<FString, int32>& Pair : Bucket)
+		{
+			const FDictionaryData& Data = WordsData[Pair.Value];
+			FString Word = Pair.Key;
+			uint32 TermId = Data.GetTermId();
+			Ar << Word << TermId;
+			Data.SaveOccurences(Ar, TableRemap);
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+bool UDefaultDictionaryRepresentation::LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables)
+{
+	int32 NumOfBuckets = 0;
+	Ar << NumOfBuckets;
+
+	if (Ar.IsError() || NumOfBuckets < 0)
+	{
+		return false;
+	}
+
+	DictionaryData.Reset();
+	DictionaryData.SetNum(FMath::Max(NumOfBuckets, 10));
+	WordsData.Reset();
+	TermWords.Reset();
+	FreeWordsData.Reset();
+
+	TArray<int32> TableRemap;
+	TableRemap.Reserve(Tables.Num());
+	for (const UDataTable* Table : Tables)
+	{
+		TableRemap.Add(RegisterTable(Table));
+	}
+
+	for (int32 BucketIndex = 0; BucketIndex < NumOfBuckets && !Ar.IsError(); BucketIndex++)
+	{
+		int32 NumOfWords = 0;
+		Ar << NumOfWords;
+
+		TMap<FString, int32>& Bucket = DictionaryData[BucketIndex];
+		Bucket.Reserve(NumOfWords);
+
+		for (int32 i = 0; i < NumOfWords && !Ar.IsError(); i++)
+		{
+			FString Word;
+			uint32 TermId = INVALID_TERM_ID;
+			Ar << Word << TermId;
+
+			const int32 WordIndex = WordsData.AddDefaulted();
+			WordsData[WordIndex].SetTermId(TermId);
+			WordsData[WordIndex].LoadOccurences(Ar, TableRemap);
+
+			Bucket.Add(MoveTemp(Word), WordIndex);
+			MapTermToWord(TermId, WordIndex);
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+void UDefaultDictionaryRepresentation::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T AllocatedSize = DictionaryData.GetAllocatedSize() + WordsData.GetAllocatedSize() + TermWords.GetAllocatedSize();
+
+	for (const TMap<FString, int32>& Bucket : DictionaryData)
+	{
+		AllocatedSize += Bucket.GetAllocatedSize();
+		for (const TPair<FString, int32>& Pair : Bucket)
+		{
+			AllocatedSize += Pair.Key.GetAllocatedSize();
+		}
+	}
+
+	for (const FDictionaryData& Data : WordsData)
+	{
+		AllocatedSize += Data.GetAllocatedSize();
+	}
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(AllocatedSize);
+}
+
+void UDefaultDictionaryRepresentation::MapTermToWord(const uint32 TermId, const int32 WordIndex)
+{
+	if (TermId == INVALID_TERM_ID)
+	{
+		return;
+	}
+
+	const int32 TermIndex = static_cast<int32>(TermId);
+	if (TermWords.Num() <= TermIndex)
+	{
+		const int32 OldNum = TermWords.Num();
+		TermWords.SetNumUninitialized(TermIndex + 1);
+
+		for (int32 i = OldNum; i < TermWords.Num(); i++)
+		{
+			TermWords[i] = INDEX_NONE;
+		}
+	}
+
+	TermWords[TermIndex] = WordIndex;
+}
@@ -1,45 +1,138 @@
-// Created by Michal Chamula. All rights reserved.
-
-#include "DefaultClasses/LevenshteinDistanceFunction.h"
-#include <vector>
-
-uint32 ULevenshteinDistanceFunction::GetStringDistance(const FString& InputA, const FString& InputB) const
-{
-	const uint32 MinSize = InputA.Len();
-	const uint32 MaxSize = InputB.Len();
-	
-	if (MinSize > MaxSize)
-	{
-		return GetStringDistance(InputB, InputA);
-	}
-	
-	std::vector<uint32> Lev_Dist(MinSize + 1);
-	
-	for (uint32 i = 0; i <= MinSize; ++i)
-	{
-		Lev_Dist[i] = i;
-	}
-	
-	for (uint32 j = 1; j <= MaxSize; ++j)
-	{
-		uint32 PreviousDiagonal = Lev_Dist[0];
-		++Lev_Dist[0];
-	
-		for (uint32 i = 1; i <= MinSize; ++i)
-		{
-			const uint32 PreviousDiagonalSave = Lev_Dist[i];
-			if (InputA[i - 1] == InputB[j - 1])
-			{
-				Lev_Dist[i] = PreviousDiagonal;
-			}
-			else
-			{
-				Lev_Dist[i] = std::min(std::min(Lev_Dist[i - 1], Lev_Dist[i]), PreviousDiagonal) + 1;
-			}
-	
-			PreviousDiagonal = PreviousDiagonalSave;
-		}
-	}
-	
-	return Lev_Dist[MinSize];
-}
+// Created by Michal Chamula. All rights reserved.
+
+#include "DefaultClasses/LevenshteinDistanceFunction.h"
+#include <vector>
+
+uint32 ULevenshteinDistanceFunction::GetStringDistance(const FString& InputA, const FString& InputB) const
+{
+	return ComputeDistance(InputA, InputB);
+}
+
+uint32 ULevenshteinDistanceFunction::GetStringDistanceBounded(const FString& InputA, const FString& InputB, const uint32 MaxDistance) const
+{
+	return ComputeDistanceBounded(InputA, InputB, MaxDistance);
+}
+
+uint32 ULevenshteinDistanceFunction::GetStringViewDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance) const
+{
+	return ComputeDistanceBounded(InputA, InputB, MaxDistance);
+}
+
+uint32 ULevenshteinDistanceFunction::ComputeDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance)
+{
+	const bool bSwap = InputA.Len() > InputB.Len();
+	const FStringView ShortInput = bSwap ? InputB : InputA;
+	const FStringView LongInput = bSwap ? InputA : InputB;
+
+	const int32 MinSize = ShortInput.Len();
+	const int32 MaxSize = LongInput.Len();
+
+	// Distance is never smaller than len difference
+	if (static_cast<uint32>(MaxSize - MinSize) > MaxDistance)
+	{
+		return MaxDistance + 1;
+	}
+
+	// Band covers whole matrix
+	if (MaxDistance >= static_cast<uint32>(MaxSize))
+	{
+		return ComputeDistance(InputA, InputB);
+	}
+
+	const int32 Band = MaxDistance;
+	const uint32 Exceeded = MaxDistance + 1;
+
+	// Cells out of band are never better than Exceeded value
+	TArray<uint32, TInlineAllocator<64>> Lev_Dist;
+	Lev_Dist.SetNumUninitialized(MinSize + 1);
+
+	for (int32 i = 0; i <= MinSize; ++i)
+	{
+		Lev_Dist[i] = i <= Band ? i : Exceeded;
+	}
+
+	for (int32 j = 1; j <= MaxSize; ++j)
+	{
+		const int32 First = FMath::Max(1, j - Band);
+		const int32 Last = FMath::Min(MinSize, j + Band);
+
+		uint32 PreviousDiagonal = Lev_Dist[First - 1];
+		uint32 RowMin;
+
+		if (First == 1)
+		{
+			Lev_Dist[0] = FMath::Min<uint32>(j, Exceeded);
+			RowMin = Lev_Dist[0];
+		}
+		else
+		{
+			Lev_Dist[First - 1] = Exceeded;
+			RowMin = Exceeded;
+		}
+
+		for (int32 i = First; i <= Last; ++i)
+		{
+			const uint32 PreviousDiagonalSave = Lev_Dist[i];
+			if (ShortInput[i - 1] == LongInput[j - 1])
+			{
+				Lev_Dist[i] = PreviousDiagonal;
+			}
+			else
+			{
+				Lev_Dist[i] = FMath::Min(std::min(std::min(Lev_Dist[i - 1], Lev_Dist[i]), PreviousDiagonal) + 1, Exceeded);
+			}
+
+			PreviousDiagonal = PreviousDiagonalSave;
+			RowMin = FMath::Min(RowMin, Lev_Dist[i]);
+		}
+
+		// Whole band is over the bound, distance can't decrease anymore
+		if (RowMin > MaxDistance)
+		{
+			return Exceeded;
+		}
+	}
+
+	return Lev_Dist[MinSize] > MaxDistance ? Exceeded : Lev_Dist[MinSize];
+}
+
+uint32 ULevenshteinDistanceFunction::ComputeDistance(const FStringView& InputA, const FStringView& InputB)
+{
+	const uint32 MinSize = InputA.Len();
+	const uint32 MaxSize = InputB.Len();
+	
+	if (MinSize > MaxSize)
+	{
+		return ComputeDistance(InputB, InputA);
+	}
+	
+	std::vector<uint32> Lev_Dist(MinSize + 1);
+	
+	for (uint32 i = 0; i <= MinSize; ++i)
+	{
+		Lev_Dist[i] = i;
+	}
+	
+	for (uint32 j = 1; j <= MaxSize; ++j)
+	{
+		uint32 PreviousDiagonal = Lev_Dist[0];
+		++Lev_Dist[0];
+	
+		for (uint32 i = 1; i <= MinSize; ++i)
+		{
+			const uint32 PreviousDiagonalSave = Lev_Dist[i];
+			if (InputA[i - 1] == InputB[j - 1])
+			{
+				Lev_Dist[i] = PreviousDiagonal;
+			}
+			else
+			{
+				Lev_Dist[i] = std::min(std::min(Lev_Dist[i - 1], Lev_Dist[i]), PreviousDiagonal) + 1;
+			}
+	
+			PreviousDiagonal = PreviousDiagonalSave;
+		}
+	}
+	
+	return Lev_Dist[MinSize];
+}
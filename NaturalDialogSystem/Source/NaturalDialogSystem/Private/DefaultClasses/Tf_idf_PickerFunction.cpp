@@ -1,114 +1,201 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "DefaultClasses/Tf_idf_PickerFunction.h"
-#include "Core/DictionarySubsystem.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "Resources/DictionaryRepresentation.h"
-#include "Resources/NaturalDialogSystemLibrary.h"
-
-
-DEFINE_LOG_CATEGORY(Log_Tf_Idf_PickerFunction);
-
-void UTf_idf_PickerFunction::InitializeKeywordPicker()
-{
-	Super::InitializeKeywordPicker();
-
-	if (const UDictionarySubsystem* Subsystem = Cast<UDictionarySubsystem>(GetOuter()))
-	{
-		DictionaryData = Subsystem->GetDictionary();
-	}
-
-	TablesCount = UNaturalDialogSystemLibrary::GetListOfDialogDataTables().Num();
-}
-
-TArray<FString> UTf_idf_PickerFunction::PickKeyWords(const UPlayerNaturalDialogComponent* DialogComponent, const TArray<FString>& Input)
-{
-	TArray<FString> Result;
-	TArray<FString> CopiedInput = TSet<FString>(Input).Array(); // Remove duplicates
-
-	if (DictionaryData.IsValid())
-	{
-		if (Input.IsValidIndex(0))
-		{
-			TArray<float> Tf_Idf_Value;
-			Tf_Idf_Value.Reserve(Input.Num());
-
-			// Compute Tf-Idf values for input words
-			for (const FString& Word : CopiedInput)
-			{
-				const FDictionaryData* DictData = DictionaryData->GetWordData(Word);
-				if (DictData)
-				{
-					int32 TermOccurence = 0;
-					for (const UDataTable* OccurenceInTable : DictData->GetTables())
-					{
-						TermOccurence += DictData->GetOccurenceCount(OccurenceInTable);
-					}
-
-					const float Tf_Value = static_cast<float>(TermOccurence) / static_cast<float>(FDictionaryData::GetNumOfWords());
-					const float Idf_Value = FMath::LogX(10, (static_cast<float>(TablesCount) / static_cast<float>(DictData->GetTableOccurenceCount())));
-					const float TfIdf_Value = Tf_Value * Idf_Value; // The result Tf_Idf value
-
-					Tf_Idf_Value.Add(TfIdf_Value);
-					UE_LOG(Log_Tf_Idf_PickerFunction, Log, TEXT("Tf_Idf value for word is (%s = %f)"), *Word, TfIdf_Value);
-				}
-				else
-				{
-					UE_LOG(Log_Tf_Idf_PickerFunction, Error, TEXT("Dict data for word (%s) not found"), *Word);
-				}
-			}
-
-			// Find the max value of array
-			int32 IndexOfMaxValue = -1;
-			float ArrMaxValue = 0.f;
-			UKismetMathLibrary::MaxOfFloatArray(Tf_Idf_Value, IndexOfMaxValue, ArrMaxValue);
-
-			// In some cases, we use input, because player can ask "Who you are", and it can be found in reply
-			// Invalid input is, when the sentence doesnt contains at least MIN_KEYWORDS_COUNT words, now it is 3, so we need the sentence with at least 3 words
-			if (Input.Num() <= MIN_KEYWORDS_COUNT)
-			{
-				for(const FString& InputElement : Input)
-				{
-					Result.Add(UNaturalDialogSystemLibrary::NormalizeTerm(InputElement));
-				}
-			}
-			else if (ArrMaxValue > 0 && Input.Num() > MIN_KEYWORDS_COUNT)
-			{
-				if (Tf_Idf_Value.IsValidIndex(IndexOfMaxValue))
-				{
-					// Defines how many elements takes from input array, e.g.> for value 0.5 takes half of array
-					const float Precision = UKismetMathLibrary::MapRangeClamped(Tf_Idf_Value.Num(), 4, 10, 1.f, 0.5f);
-
-					// Add the first occurence
-					Result.Add(UNaturalDialogSystemLibrary::NormalizeTerm(CopiedInput[IndexOfMaxValue]));
-					UE_LOG(Log_Tf_Idf_PickerFunction, Log, TEXT("Selecting (%s) as first keyword"), *CopiedInput[IndexOfMaxValue]);
-					Tf_Idf_Value.RemoveAt(IndexOfMaxValue);
-					CopiedInput.RemoveAt(IndexOfMaxValue);
-
-					// Select keywords using computed value
-					const int32 NumOfRepeats = FMath::RoundToInt((Tf_Idf_Value.Num() * Precision) - 1);
-					for (int32 i = 0; i < NumOfRepeats; i++)
-					{
-						// Add other occurence, but only if max_value is greater than 0, or we still have not MIN_KEYWORDS_COUNT elements in array
-						UKismetMathLibrary::MaxOfFloatArray(Tf_Idf_Value, IndexOfMaxValue, ArrMaxValue);
-						if (Input.IsValidIndex(IndexOfMaxValue) && (i <= MIN_KEYWORDS_COUNT || ArrMaxValue > 0))
-						{
-							const FString& InWord = CopiedInput[IndexOfMaxValue];
-							Result.Add(UNaturalDialogSystemLibrary::NormalizeTerm(InWord));
-							UE_LOG(Log_Tf_Idf_PickerFunction, Log, TEXT("Next keyword is (%s)"), *InWord);
-							CopiedInput.RemoveAt(IndexOfMaxValue);
-							Tf_Idf_Value.RemoveAt(IndexOfMaxValue);
-						}
-					}
-				}
-			}
-		}
-	}
-	else
-	{
-		UE_LOG(Log_Tf_Idf_PickerFunction, Error, TEXT("No dictionary data found"));
-	}
-
-	return Result;
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/Tf_idf_PickerFunction.h"
+#include "Core/DictionarySubsystem.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+
+
+DEFINE_LOG_CATEGORY(Log_Tf_Idf_PickerFunction);
+
+void UTf_idf_PickerFunction::InitializeKeywordPicker()
+{
+	Super::InitializeKeywordPicker();
+
+	DictionarySubsystem = Cast<UDictionarySubsystem>(GetOuter());
+}
+
+TArray<FString> UTf_idf_PickerFunction::PickKeyWords(const UPlayerNaturalDialogComponent* DialogComponent, const TArray<FString>& Input)
+{
+	TArray<FString> Result;
+
+	if (!Input.IsValidIndex(0))
+	{
+		return Result;
+	}
+
+	// Terms are converted back with the same snapshot
+	const FDictionarySnapshotPtr Snapshot = DictionarySubsystem.IsValid() ? DictionarySubsystem.Get()->GetSnapshot() : FDictionarySnapshotPtr();
+	if (!Snapshot.IsValid())
+	{
+		UE_LOG(Log_Tf_Idf_PickerFunction, Error, TEXT("No dictionary data found"));
+		return Result;
+	}
+
+	// Short input is used as it is, words which are not in dictionary are kept too, @see PickKeyTerms()
+	if (Input.Num() <= MIN_KEYWORDS_COUNT)
+	{
+		for (const FString& Word : Input)
+		{
+			Result.Add(UNaturalDialogSystemLibrary::NormalizeTerm(Word));
+		}
+
+		return Result;
+	}
+
+	// Words, which are not in dictionary, can't be keywords
+	TArray<uint32> InputTerms;
+	InputTerms.Reserve(Input.Num());
+	for (const FString& Word : Input)
+	{
+		const uint32 TermId = Snapshot->TermTable.Find(UNaturalDialogSystemLibrary::NormalizeTerm(Word));
+		if (TermId != INVALID_TERM_ID)
+		{
+			InputTerms.Add(TermId);
+		}
+	}
+
+	for (const uint32 TermId : PickKeyTerms(DialogComponent, InputTerms))
+	{
+		Result.Add(Snapshot->TermTable.GetTerm(TermId));
+	}
+
+	return Result;
+}
+
+TArray<uint32> UTf_idf_PickerFunction::PickKeyTerms(const UPlayerNaturalDialogComponent* DialogComponent, const TArray<uint32>& Input)
+{
+	TArray<uint32> Result;
+	TArray<uint32> CopiedInput;
+	CopiedInput.Reserve(Input.Num());
+
+	// Remove duplicates, the first occurence keeps its position
+	TSet<uint32> UniqueInput;
+	UniqueInput.Reserve(Input.Num());
+	for (const uint32 TermId : Input)
+	{
+		bool bIsAlreadyInSet = false;
+		UniqueInput.Add(TermId, &bIsAlreadyInSet);
+
+		if (!bIsAlreadyInSet)
+		{
+			CopiedInput.Add(TermId);
+		}
+	}
+
+	// Snapshot is immutable, so keywords can be picked on any thread
+	const FDictionarySnapshotPtr Snapshot = DictionarySubsystem.IsValid() ? DictionarySubsystem.Get()->GetSnapshot() : FDictionarySnapshotPtr();
+
+	if (Snapshot.IsValid() && Snapshot->GetDictionary())
+	{
+		const FDictionaryTermTable* TermTable = &Snapshot->TermTable;
+
+		if (Input.IsValidIndex(0))
+		{
+			TArray<float> Tf_Idf_Value;
+			Tf_Idf_Value.Reserve(Input.Num());
+
+			// Tf-Idf values of terms are precomputed when snapshot is built, every term gets value, so values and terms keep the same positions
+			for (const uint32 TermId : CopiedInput)
+			{
+				const FDictionaryTermWeight* TermWeight = Snapshot->GetTermWeight(TermId);
+				if (TermWeight)
+				{
+					const float TfIdf_Value = TermWeight->TfIdf; // The result Tf_Idf value
+
+					Tf_Idf_Value.Add(TfIdf_Value);
+					UE_LOG(Log_Tf_Idf_PickerFunction, Verbose, TEXT("Tf_Idf value for word is (%s = %f)"), *TermTable->GetTerm(TermId), TfIdf_Value);
+				}
+				else
+				{
+					Tf_Idf_Value.Add(0.f);
+					UE_LOG(Log_Tf_Idf_PickerFunction, Error, TEXT("Dict data for term (%u) not found"), TermId);
+				}
+			}
+
+			// In some cases, we use input, because player can ask "Who you are", and it can be found in reply
+			// Invalid input is, when the sentence doesnt contains at least MIN_KEYWORDS_COUNT words, now it is 3, so we need the sentence with at least 3 words
+			if (Input.Num() <= MIN_KEYWORDS_COUNT)
+			{
+				// Terms are already normalized
+				Result = Input;
+			}
+			else
+			{
+				// Values are paired with input terms by position
+				const TArray<int32> KeywordIndexes = SelectKeywordIndexes(Tf_Idf_Value);
+
+				for (int32 i = 0; i < KeywordIndexes.Num(); i++)
+				{
+					const uint32 InTerm = CopiedInput[KeywordIndexes[i]];
+					Result.Add(InTerm);
+					UE_LOG(Log_Tf_Idf_PickerFunction, Verbose, i == 0 ? TEXT("Selecting (%s) as first keyword") : TEXT("Next keyword is (%s)"), *TermTable->GetTerm(InTerm));
+				}
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(Log_Tf_Idf_PickerFunction, Error, TEXT("No dictionary data found"));
+	}
+
+	return Result;
+}
+
+TArray<int32> UTf_idf_PickerFunction::SelectKeywordIndexes(const TArray<float>& Values)
+{
+	TArray<int32> Result;
+
+	if (Values.Num() == 0)
+	{
+		return Result;
+	}
+
+	struct FKeywordScore
+	{
+		float Value;
+		int32 Index;
+	};
+
+	// Keywords are selected from the highest value, equal values in the order of input
+	const auto SelectionOrder = [](const FKeywordScore& A, const FKeywordScore& B)
+	{
+		return A.Value > B.Value || (A.Value == B.Value && A.Index < B.Index);
+	};
+
+	TArray<FKeywordScore, TInlineAllocator<16>> Scores;
+	Scores.Reserve(Values.Num());
+	for (int32 i = 0; i < Values.Num(); i++)
+	{
+		Scores.Add({Values[i], i});
+	}
+
+	// Only selected keywords are popped from heap, so the rest of values is never sorted
+	Scores.Heapify(SelectionOrder);
+
+	if (Scores.HeapTop().Value > 0)
+	{
+		// Defines how many elements takes from input array, e.g.> for value 0.5 takes half of array
+		const float Precision = UKismetMathLibrary::MapRangeClamped(Values.Num(), 4, 10, 1.f, 0.5f);
+		const int32 NumOfRepeats = FMath::RoundToInt(((Values.Num() - 1) * Precision) - 1);
+		const int32 NumOfKeywords = FMath::Min(1 + FMath::Max(NumOfRepeats, 0), Values.Num());
+
+		Result.Reserve(NumOfKeywords);
+
+		for (int32 i = 0; i < NumOfKeywords; i++)
+		{
+			// Keyword is added, only if its value is greater than 0, or we still have not MIN_KEYWORDS_COUNT elements after the first one
+			if (i > MIN_KEYWORDS_COUNT + 1 && !(Scores.HeapTop().Value > 0))
+			{
+				break;
+			}
+
+			FKeywordScore Score;
+			Scores.HeapPop(Score, SelectionOrder, false);
+			Result.Add(Score.Index);
+		}
+	}
+
+	return Result;
+}
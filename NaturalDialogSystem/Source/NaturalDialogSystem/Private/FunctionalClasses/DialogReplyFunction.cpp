@@ -1,5 +1,28 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "FunctionalClasses/DialogReplyFunction.h"
-
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "FunctionalClasses/DialogReplyFunction.h"
+#include "Core/DictionarySubsystem.h"
+#include "Kismet/GameplayStatics.h"
+
+
+bool UDialogReplyFunction::GenerateReplyFromTerms(const TArray<uint32>& KeywordTerms, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+{
+	const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(this);
+	const UDictionarySubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDictionarySubsystem>() : nullptr;
+	const FDictionarySnapshotPtr Snapshot = Subsystem ? Subsystem->GetSnapshot() : FDictionarySnapshotPtr();
+
+	FString Sentence;
+	if (Snapshot.IsValid())
+	{
+		for (const uint32 TermId : KeywordTerms)
+		{
+			if (Snapshot->TermTable.IsValidId(TermId))
+			{
+				Sentence += Snapshot->TermTable.GetTerm(TermId) + TEXT(" ");
+			}
+		}
+	}
+
+	return GenerateReply(Sentence, NpcNaturalDialogComponent, ResultAnswer);
+}
@@ -1,5 +1,36 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "FunctionalClasses/KeywordPickerFunction.h"
-
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "FunctionalClasses/KeywordPickerFunction.h"
+#include "Core/DictionarySubsystem.h"
+
+
+TArray<uint32> UKeywordPickerFunction::PickKeyTerms(const UPlayerNaturalDialogComponent* DialogComponent, const TArray<uint32>& Input)
+{
+	TArray<uint32> Result;
+
+	const UDictionarySubsystem* Subsystem = Cast<UDictionarySubsystem>(GetOuter());
+	const FDictionarySnapshotPtr Snapshot = Subsystem ? Subsystem->GetSnapshot() : FDictionarySnapshotPtr();
+	if (ensure(Snapshot.IsValid()))
+	{
+		const FDictionaryTermTable& TermTable = Snapshot->TermTable;
+
+		TArray<FString> InputWords;
+		InputWords.Reserve(Input.Num());
+		for (const uint32 TermId : Input)
+		{
+			InputWords.Add(TermTable.GetTerm(TermId));
+		}
+
+		for (const FString& Keyword : PickKeyWords(DialogComponent, InputWords))
+		{
+			const uint32 TermId = TermTable.Find(Keyword);
+			if (TermId != INVALID_TERM_ID)
+			{
+				Result.Add(TermId);
+			}
+		}
+	}
+
+	return Result;
+}
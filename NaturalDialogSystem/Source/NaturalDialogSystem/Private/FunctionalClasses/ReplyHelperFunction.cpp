@@ -1,5 +1,5 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "FunctionalClasses/ReplyHelperFunction.h"
-
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "FunctionalClasses/ReplyHelperFunction.h"
+
@@ -1,5 +1,5 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "FunctionalClasses/StringDistanceFunction.h"
-
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "FunctionalClasses/StringDistanceFunction.h"
+
@@ -0,0 +1,60 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Module/BuildDictionaryIndexCommandlet.h"
+#include "DefaultClasses/DefaultDictionaryRepresentation.h"
+#include "Module/NaturalDialogSystemSettings.h"
+#include "Resources/DictionaryIndex.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "Resources/DictionarySnapshot.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+#include "Resources/Resources.h"
+
+
+DEFINE_LOG_CATEGORY(LogBuildDictionaryIndexCommandlet);
+
+UBuildDictionaryIndexCommandlet::UBuildDictionaryIndexCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UBuildDictionaryIndexCommandlet::Main(const FString& Params)
+{
+	const UNaturalDialogSystemSettings* Settings = GetDefault<UNaturalDialogSystemSettings>();
+
+	FString FilePath;
+	if (!FParse::Value(*Params, TEXT("Output="), FilePath))
+	{
+		FilePath = Settings->GetPrebuiltDictionaryFilePath();
+	}
+
+	// Create the same dictionary representation as UDictionarySubsystem
+	const TSubclassOf<UDictionaryRepresentation> DictClass = Settings->GetDictionaryRepresentationClass() ? Settings->GetDictionaryRepresentationClass() : TSubclassOf<UDictionaryRepresentation>(UDefaultDictionaryRepresentation::StaticClass());
+	FDictionarySnapshot Snapshot;
+	Snapshot.BindDictionary(NewObject<UDictionaryRepresentation>(GetTransientPackage(), DictClass));
+	Snapshot.Dictionary->InitializeDictionary();
+
+	int32 NumOfScannedAssets = 0;
+	int32 NumOfLoadedAssets = 0;
+	const TArray<const UDataTable*> SortedTables = FDictionaryIndex::GetSortedTables(UNaturalDialogSystemLibrary::GetListOfDialogDataTables(NumOfScannedAssets, NumOfLoadedAssets));
+	UE_LOG(LogBuildDictionaryIndexCommandlet, Display, TEXT("Found %d dialog tables (%d data tables scanned)"), SortedTables.Num(), NumOfScannedAssets);
+
+	// Register words of all tables
+	for (const UDataTable* Table : SortedTables)
+	{
+		Snapshot.RegisterWordsFromTable(Table);
+	}
+
+	const uint32 ContentHash = FDictionaryIndex::ComputeContentHash(SortedTables);
+	if (!FDictionaryIndex::Save(FilePath, Snapshot, SortedTables, ContentHash))
+	{
+		UE_LOG(LogBuildDictionaryIndexCommandlet, Error, TEXT("Failed to build dictionary index %s"), *FilePath);
+		return 1;
+	}
+
+	UE_LOG(LogBuildDictionaryIndexCommandlet, Display, TEXT("Dictionary index %s was built (%d words)"), *FilePath, Snapshot.NumOfWords);
+	return 0;
+}
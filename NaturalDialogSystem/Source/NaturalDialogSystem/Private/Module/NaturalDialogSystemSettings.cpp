@@ -1,10 +1,20 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "Module/NaturalDialogSystemSettings.h"
-
-UNaturalDialogSystemSettings::UNaturalDialogSystemSettings()
-{
-	CategoryName = TEXT("Plugins");
-	SectionName = TEXT("Natural Dialog System");
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Module/NaturalDialogSystemSettings.h"
+
+UNaturalDialogSystemSettings::UNaturalDialogSystemSettings()
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("Natural Dialog System");
+
+	bUsePrebuiltDictionary = true;
+	PrebuiltDictionaryPath = TEXT("NaturalDialogSystem/DictionaryIndex.bin");
+	WordCorrectionCacheCapacity = 4096;
+	bFoldDiacritics = false;
+}
+
+FString UNaturalDialogSystemSettings::GetPrebuiltDictionaryFilePath() const
+{
+	return FPaths::Combine(FPaths::ProjectContentDir(), PrebuiltDictionaryPath);
+}
@@ -0,0 +1,197 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Resources/DictionaryIndex.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+#include "Misc/FileHelper.h"
+#include "Module/NaturalDialogSystemSettings.h"
+#include "Resources/DictionarySnapshot.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "Resources/Resources.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+
+DEFINE_LOG_CATEGORY(LogDictionaryIndex);
+
+TArray<const UDataTable*> FDictionaryIndex::GetSortedTables(const TSet<UDataTable*>& Tables)
+{
+	TArray<const UDataTable*> Result;
+	Result.Reserve(Tables.Num());
+
+	for (const UDataTable* Table : Tables)
+	{
+		if (Table)
+		{
+			Result.Add(Table);
+		}
+	}
+
+	Result.Sort([](const UDataTable& A, const UDataTable& B)
+	{
+		return A.GetPathName() < B.GetPathName();
+	});
+
+	return Result;
+}
+
+uint32 FDictionaryIndex::ComputeTableListHash(const TArray<const UDataTable*>& SortedTables)
+{
+	uint32 Result = DICTIONARY_INDEX_VERSION;
+
+	// Folding changes normalized terms, so index built with other setting is not valid
+	Result = HashCombine(Result, GetTypeHash(GetDefault<UNaturalDialogSystemSettings>()->GetFoldDiacritics()));
+
+	// Words are parsed from texts of current culture, so index of other language is not valid
+	Result = FCrc::StrCrc32(*FInternationalization::Get().GetCurrentCulture()->GetName(), Result);
+
+	for (const UDataTable* Table : SortedTables)
+	{
+		Result = FCrc::StrCrc32(*Table->GetPathName(), Result);
+	}
+
+	return Result;
+}
+
+uint32 FDictionaryIndex::ComputeContentHash(const TArray<const UDataTable*>& SortedTables)
+{
+	uint32 Result = 0;
+
+	for (const UDataTable* Table : SortedTables)
+	{
+		if (Table->GetRowStruct()->IsChildOf(FNaturalDialogRow_Keyword::StaticStruct()))
+		{
+			Table->ForeachRow<FNaturalDialogRow_Keyword>(TEXT("Dictionary index hash"), [&Result](const FName& Key, const FNaturalDialogRow_Keyword& Value)
+			{
+				Result = FCrc::StrCrc32(*Value.Ask.ToString(), Result);
+
+				for (const FNaturalDialogAnswer& Answer : Value.Answer)
+				{
+					Result = FCrc::StrCrc32(*Answer.Answer.ToString(), Result);
+				}
+
+				for (const FText& Keyword : Value.Keywords)
+				{
+					Result = FCrc::StrCrc32(*Keyword.ToString(), Result);
+				}
+			});
+		}
+		else if (Table->GetRowStruct()->IsChildOf(FNaturalDialogRow::StaticStruct()))
+		{
+			Table->ForeachRow<FNaturalDialogRow>(TEXT("Dictionary index hash"), [&Result](const FName& Key, const FNaturalDialogRow& Value)
+			{
+				Result = FCrc::StrCrc32(*Value.Ask.ToString(), Result);
+
+				for (const FNaturalDialogAnswer& Answer : Value.Answer)
+				{
+					Result = FCrc::StrCrc32(*Answer.Answer.ToString(), Result);
+				}
+			});
+		}
+	}
+
+	return Result;
+}
+
+bool FDictionaryIndex::Save(const FString& FilePath, const FDictionarySnapshot& Snapshot, const TArray<const UDataTable*>& SortedTables, const uint32 ContentHash)
+{
+	const UDictionaryRepresentation* Dictionary = Snapshot.GetDictionary();
+	if (!Dictionary)
+	{
+		return false;
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Ar(Bytes);
+
+	// Header
+	uint32 Magic = DICTIONARY_INDEX_MAGIC;
+	int32 Version = DICTIONARY_INDEX_VERSION;
+	uint32 TableListHash = ComputeTableListHash(SortedTables);
+	uint32 Hash = ContentHash;
+	FString ClassPath = Dictionary->GetClass()->GetPathName();
+	int32 NumOfWords = Snapshot.NumOfWords;
+	Ar << Magic << Version << TableListHash << Hash << ClassPath << NumOfWords;
+
+	// Payload, terms are first, so dictionary can use term ids during loading
+	Ar << const_cast<FDictionaryTermTable&>(Snapshot.TermTable);
+
+	if (!Dictionary->SaveDictionary(Ar, SortedTables))
+	{
+		UE_LOG(LogDictionaryIndex, Warning, TEXT("Dictionary representation %s doesn't support prebuilt index"), *Dictionary->GetClass()->GetName());
+		return false;
+	}
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *FilePath))
+	{
+		UE_LOG(LogDictionaryIndex, Warning, TEXT("Failed to write dictionary index %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogDictionaryIndex, Log, TEXT("Dictionary index %s written (%d tables, %d bytes)"), *FilePath, SortedTables.Num(), Bytes.Num());
+	return true;
+}
+
+bool FDictionaryIndex::Load(const FString& FilePath, FDictionarySnapshot& Snapshot, const TArray<const UDataTable*>& SortedTables, const TOptional<uint32>& ContentHash)
+{
+	UDictionaryRepresentation* Dictionary = Snapshot.Dictionary;
+	if (!Dictionary)
+	{
+		return false;
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath, FILEREAD_Silent))
+	{
+		UE_LOG(LogDictionaryIndex, Log, TEXT("Dictionary index %s not found"), *FilePath);
+		return false;
+	}
+
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	uint32 TableListHash = 0;
+	uint32 Hash = 0;
+	FString ClassPath;
+	int32 NumOfWords = 0;
+	Ar << Magic << Version << TableListHash << Hash << ClassPath << NumOfWords;
+
+	if (Ar.IsError() || Magic != DICTIONARY_INDEX_MAGIC || Version != DICTIONARY_INDEX_VERSION)
+	{
+		UE_LOG(LogDictionaryIndex, Warning, TEXT("Dictionary index %s has invalid format"), *FilePath);
+		return false;
+	}
+
+	if (TableListHash != ComputeTableListHash(SortedTables))
+	{
+		UE_LOG(LogDictionaryIndex, Log, TEXT("Dictionary index %s is out of date, dialog tables were added or removed"), *FilePath);
+		return false;
+	}
+
+	if (ContentHash.IsSet() && Hash != ContentHash.GetValue())
+	{
+		UE_LOG(LogDictionaryIndex, Log, TEXT("Dictionary index %s is out of date, dialog tables have changed"), *FilePath);
+		return false;
+	}
+
+	if (ClassPath != Dictionary->GetClass()->GetPathName())
+	{
+		UE_LOG(LogDictionaryIndex, Log, TEXT("Dictionary index %s was built for %s representation"), *FilePath, *ClassPath);
+		return false;
+	}
+
+	Ar << Snapshot.TermTable;
+
+	if (Ar.IsError() || !Dictionary->LoadDictionary(Ar, SortedTables) || Ar.IsError())
+	{
+		UE_LOG(LogDictionaryIndex, Warning, TEXT("Failed to read dictionary data from index %s"), *FilePath);
+		return false;
+	}
+
+	Snapshot.NumOfWords = NumOfWords;
+	Snapshot.NumOfTables = SortedTables.Num();
+	Snapshot.RebuildTermCounts();
+	return true;
+}
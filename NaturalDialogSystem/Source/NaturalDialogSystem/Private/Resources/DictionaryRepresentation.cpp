@@ -1,4 +1,4 @@
-﻿// Created by Michal Chamula. All rights reserved.
-
-
-#include "Resources/DictionaryRepresentation.h"
+﻿// Created by Michal Chamula. All rights reserved.
+
+
+#include "Resources/DictionaryRepresentation.h"
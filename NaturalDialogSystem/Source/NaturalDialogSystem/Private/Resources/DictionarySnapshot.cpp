@@ -0,0 +1,194 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Resources/DictionarySnapshot.h"
+#include "Engine/DataTable.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "Resources/NaturalDialogSystemLibrary.h"
+
+
+void FDictionarySnapshot::InitializeFrom(const FDictionarySnapshot* BaseSnapshot)
+{
+	if (BaseSnapshot)
+	{
+		TermTable = BaseSnapshot->TermTable;
+		TableRegistry = BaseSnapshot->TableRegistry;
+		Version = BaseSnapshot->Version + 1;
+	}
+	else
+	{
+		TermTable.Reset();
+		TableRegistry.Reset();
+		Version = 0;
+	}
+
+	NumOfWords = 0;
+	NumOfTables = 0;
+	TermWeights.Reset();
+}
+
+void FDictionarySnapshot::BindDictionary(UDictionaryRepresentation* InDictionary)
+{
+	Dictionary = InDictionary;
+
+	if (Dictionary)
+	{
+		Dictionary->SetTermTable(&TermTable);
+		Dictionary->SetTableRegistry(&TableRegistry);
+	}
+}
+
+void FDictionarySnapshot::RegisterWordsFromTable(const UDataTable* InTable)
+{
+	if (ensure(InTable && Dictionary))
+	{
+		RegisterTableTerms(InTable, UNaturalDialogSystemLibrary::GetTableTerms(InTable));
+	}
+}
+
+bool FDictionarySnapshot::CopyDictionaryFrom(const FDictionarySnapshot* BaseSnapshot)
+{
+	if (!BaseSnapshot || !BaseSnapshot->Dictionary || !Dictionary || !Dictionary->CopyDictionary(BaseSnapshot->Dictionary))
+	{
+		return false;
+	}
+
+	NumOfWords = BaseSnapshot->NumOfWords;
+	NumOfTables = BaseSnapshot->NumOfTables;
+	TermWeights = BaseSnapshot->TermWeights;
+	return true;
+}
+
+void FDictionarySnapshot::RegisterTableTerms(const UDataTable* InTable, const TArray<FString>& Words)
+{
+	if (ensure(InTable && Dictionary))
+	{
+		TSet<uint32> TableTerms;
+		int32 NumOfRegisteredWords = 0;
+
+		for (const FString& Word : Words)
+		{
+			// Keywords, which are normalized to nothing (e.g. numbers), are not words
+			if (Word.IsEmpty())
+			{
+				continue;
+			}
+
+			NumOfRegisteredWords++;
+			const uint32 TermId = TermTable.Intern(Word);
+			Dictionary->RegisterTerm(Word, TermId, InTable);
+
+			if (TermId != INVALID_TERM_ID)
+			{
+				if (TermWeights.Num() <= static_cast<int32>(TermId))
+				{
+					TermWeights.SetNum(TermId + 1);
+				}
+
+				bool bIsInTable = false;
+				TableTerms.Add(TermId, &bIsInTable);
+
+				TermWeights[TermId].NumOfOccurences++;
+				TermWeights[TermId].NumOfTables += bIsInTable ? 0 : 1;
+			}
+		}
+
+		NumOfWords += NumOfRegisteredWords;
+		NumOfTables++;
+	}
+}
+
+bool FDictionarySnapshot::UnregisterTableTerms(const UDataTable* InTable, const TArray<FString>& Words)
+{
+	if (!ensure(InTable && Dictionary))
+	{
+		return false;
+	}
+
+	TSet<uint32> TableTerms;
+	int32 NumOfUnregisteredWords = 0;
+
+	for (const FString& Word : Words)
+	{
+		// Empty words were not registered, @see RegisterTableTerms()
+		if (Word.IsEmpty())
+		{
+			continue;
+		}
+
+		NumOfUnregisteredWords++;
+		const uint32 TermId = TermTable.Find(Word);
+		if (!Dictionary->UnregisterTerm(Word, TermId, InTable))
+		{
+			return false;
+		}
+
+		if (TermWeights.IsValidIndex(static_cast<int32>(TermId)))
+		{
+			bool bIsInTable = false;
+			TableTerms.Add(TermId, &bIsInTable);
+
+			TermWeights[TermId].NumOfOccurences--;
+			TermWeights[TermId].NumOfTables -= bIsInTable ? 0 : 1;
+		}
+	}
+
+	NumOfWords = FMath::Max(NumOfWords - NumOfUnregisteredWords, 0);
+	NumOfTables = FMath::Max(NumOfTables - 1, 0);
+	return true;
+}
+
+void FDictionarySnapshot::RebuildTermCounts()
+{
+	TermWeights.Reset();
+	TermWeights.SetNum(TermTable.Num());
+
+	if (Dictionary)
+	{
+		for (int32 TermIndex = 0; TermIndex < TermWeights.Num(); TermIndex++)
+		{
+			if (const FDictionaryData* Data = Dictionary->GetTermData(TermIndex))
+			{
+				TermWeights[TermIndex].NumOfOccurences = Data->GetTotalOccurenceCount();
+				TermWeights[TermIndex].NumOfTables = Data->GetTableOccurenceCount();
+			}
+		}
+	}
+}
+
+void FDictionarySnapshot::UpdateTermWeights()
+{
+	// Divider of all terms is the same, so log is computed only for different table counts
+	TArray<float> IdfValues;
+	IdfValues.SetNumZeroed(NumOfTables + 1);
+	for (int32 Count = 1; Count < IdfValues.Num(); Count++)
+	{
+		IdfValues[Count] = FMath::LogX(10, static_cast<float>(NumOfTables) / static_cast<float>(Count));
+	}
+
+	const float NumOfAllWords = static_cast<float>(GetNumOfWords());
+
+	for (FDictionaryTermWeight& Weight : TermWeights)
+	{
+		if (Weight.IsValid())
+		{
+			Weight.Tf = static_cast<float>(Weight.NumOfOccurences) / NumOfAllWords;
+			Weight.Idf = IdfValues.IsValidIndex(Weight.NumOfTables) ? IdfValues[Weight.NumOfTables] : FMath::LogX(10, static_cast<float>(NumOfTables) / static_cast<float>(Weight.NumOfTables));
+			Weight.TfIdf = Weight.Tf * Weight.Idf;
+		}
+		else
+		{
+			Weight = FDictionaryTermWeight();
+		}
+	}
+}
+
+void FDictionarySnapshot::FinishBuild()
+{
+	if (Dictionary)
+	{
+		Dictionary->FinalizeDictionary();
+	}
+
+	UpdateTermWeights();
+}
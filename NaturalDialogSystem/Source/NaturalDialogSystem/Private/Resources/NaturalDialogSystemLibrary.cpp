@@ -1,135 +1,741 @@
-// Created by Michal Chamula. All rights reserved.
-
-
-#include "Resources/NaturalDialogSystemLibrary.h"
-#include "Resources/Resources.h"
-#include "NaturalDialogSystem/External/utf8proc.h"
-
-
-TSet<UDataTable*> UNaturalDialogSystemLibrary::GetListOfDialogDataTables()
-{
-	// Finds all tables in content
-	const TArray<UDataTable*> FoundTables = GetListOfContentObjects_Recursive<UDataTable>();
-
-	TSet<UDataTable*> Result;
-	Result.Reserve(FoundTables.Num());
-
-	for (UDataTable* Table : FoundTables)
-	{
-		// We sort out tables with correct natural dialog struct
-		if (Table && Table->GetRowStruct()->IsChildOf(FNaturalDialogRow::StaticStruct()))
-		{
-			Result.Add(Table);
-		}
-	}
-
-	return Result;
-}
-
-TArray<FString> UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(const FString& Input)
-{
-	TArray<FString> Result;
-	Result.Reserve(20);
-
-	FString CachedWord;
-	CachedWord.Reset(20);
-
-	for (const CHAR Character : Input)
-	{
-		const CHAR Normalized = NormalizeCharacter(Character);
-		if (IsSpaceChar(Normalized))
-		{
-			if (!CachedWord.IsEmpty())
-			{
-				Result.Add(CachedWord);
-				CachedWord.Reset(20);
-			}
-		}
-		else if (Normalized != NULL_CHARACTER)
-		{
-			CachedWord += Normalized;
-		}
-	}
-
-	if (!CachedWord.IsEmpty())
-	{
-		Result.Add(CachedWord);
-	}
-
-	return Result;
-}
-
-FString UNaturalDialogSystemLibrary::NormalizeTerm(const FString& Input)
-{
-	FString Result;
-	Result.Reserve(Input.Len());
-
-	for (const TCHAR Character : Input)
-	{
-		const TCHAR NormalizedChar = NormalizeCharacter(Character);
-		if (NormalizedChar != SPACE_CHARACTER)
-		{
-			Result += NormalizedChar;
-		}
-	}
-
-	return Result;
-}
-
-TArray<FString> UNaturalDialogSystemLibrary::SplitToSentences(const FString& Input)
-{
-	TArray<FString> Result;
-
-	FWideStringBuilderBase StringBuilderBase;
-	
-	FString Sentence;
-
-	for (const TCHAR Character : Input)
-	{
-		if (IsSentenceSeparator(Character))
-		{
-			if (!Sentence.IsEmpty())
-			{
-				Sentence += Character;
-				Result.Add(Sentence);
-				Sentence.Reset(18);
-			}
-		}
-		else
-		{
-			Sentence += Character;
-		}
-	}
-
-	if (!Sentence.IsEmpty())
-	{
-		Result.Add(Sentence);
-	}
-
-	return Result;
-}
-
-FString UNaturalDialogSystemLibrary::NormalizeWord(const FString& Input)
-{
-	return NormalizeTerm(Input);
-}
-
-CHAR UNaturalDialogSystemLibrary::NormalizeCharacter(CHAR Character)
-{
-	if (IsSpaceChar(Character) || IsTagCharacter(Character))
-	{
-		return Character;
-	}
-
-	if (IsSentenceSeparator(Character))
-	{
-		return SPACE_CHARACTER;
-	}
-
-	if (IsSpecialChar(Character))
-	{
-		return NULL_CHARACTER;
-	}
-
-	return utf8proc_tolower(Character);
-}
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "Resources/NaturalDialogSystemLibrary.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "HAL/ThreadSingleton.h"
+#include "Misc/PackageName.h"
+#include "Module/NaturalDialogSystemSettings.h"
+#include "Resources/Resources.h"
+#include "UObject/UObjectIterator.h"
+#include "NaturalDialogSystem/External/utf8proc.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON && !PLATFORM_TCHAR_IS_4_BYTES
+	#include <arm_neon.h>
+	#define NORMALIZED_TEXT_SIMD 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && !PLATFORM_TCHAR_IS_4_BYTES
+	#include <emmintrin.h>
+	#define NORMALIZED_TEXT_SIMD 1
+#else
+	#define NORMALIZED_TEXT_SIMD 0
+#endif
+
+/** Pool of scratch buffers of the current thread, @see FScopedNormalizedText */
+struct FNormalizedTextScratchPool : TThreadSingleton<FNormalizedTextScratchPool>
+{
+	/** Buffers, which are not used by any scope */
+	TArray<TUniquePtr<FNormalizedText>> FreeTexts;
+};
+
+/** Larger buffers are released at the end of scope, so one long input doesn't keep memory of thread forever */
+static constexpr int32 MaxScratchChars = 4096;
+
+void FNormalizedText::Normalize(const FStringView& Input)
+{
+	Reset();
+	Append(Input);
+}
+
+void FNormalizedText::Append(const FStringView& Input)
+{
+	UNaturalDialogSystemLibrary::NormalizeIntoBuffer(Input.GetData(), Input.Len(), Chars, Words);
+}
+
+void FNormalizedText::Reset(const int32 MaxKeptChars)
+{
+	if (Chars.Max() > MaxKeptChars)
+	{
+		Chars.Empty();
+		Words.Empty();
+	}
+	else
+	{
+		Chars.Reset();
+		Words.Reset();
+	}
+}
+
+void FNormalizedText::JoinTo(FString& Output, const TCHAR Separator) const
+{
+	Output.Reserve(Output.Len() + Chars.Num() + Words.Num());
+
+	for (int32 i = 0; i < Words.Num(); i++)
+	{
+		if (i > 0)
+		{
+			Output.AppendChar(Separator);
+		}
+		Output.AppendChars(Chars.GetData() + Words[i].Start, Words[i].Len);
+	}
+}
+
+FScopedNormalizedText::FScopedNormalizedText(const FStringView& Input)
+{
+	TArray<TUniquePtr<FNormalizedText>>& FreeTexts = FNormalizedTextScratchPool::Get().FreeTexts;
+	Text = FreeTexts.Num() > 0 ? FreeTexts.Pop(false).Release() : new FNormalizedText();
+	Text->Normalize(Input);
+}
+
+FScopedNormalizedText::~FScopedNormalizedText()
+{
+	Text->Reset(MaxScratchChars);
+	FNormalizedTextScratchPool::Get().FreeTexts.Emplace(Text);
+}
+
+#if NORMALIZED_TEXT_SIMD
+
+namespace NormalizedText
+{
+	/** Num of characters in one block */
+	constexpr int32 BlockSize = 16;
+
+	/** Mask of block, where all characters are part of words */
+	constexpr uint32 FullBlockMask = (1u << BlockSize) - 1;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+
+	/** Returns bit for every lane of two 16 bit masks, bit i is set for character i */
+	FORCEINLINE uint32 MoveMask(const uint16x8_t Low, const uint16x8_t High)
+	{
+		static const uint8 BitWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+
+		const uint8x16_t Bits = vandq_u8(vcombine_u8(vmovn_u16(Low), vmovn_u16(High)), vld1q_u8(BitWeights));
+
+		// Horizontal sum of every half, weights are distinct bits, so the sum is the mask
+		uint8x8_t Sum = vpadd_u8(vget_low_u8(Bits), vget_high_u8(Bits));
+		Sum = vpadd_u8(Sum, Sum);
+		Sum = vpadd_u8(Sum, Sum);
+
+		return static_cast<uint32>(vget_lane_u8(Sum, 0)) | (static_cast<uint32>(vget_lane_u8(Sum, 1)) << 8);
+	}
+
+	FORCEINLINE uint16x8_t Lower(const uint16x8_t Characters)
+	{
+		const uint16x8_t IsUpper = vandq_u16(vcgeq_u16(Characters, vdupq_n_u16('A')), vcleq_u16(Characters, vdupq_n_u16('Z')));
+		return vorrq_u16(Characters, vandq_u16(IsUpper, vdupq_n_u16(0x20)));
+	}
+
+	/** Characters >= 'A' and $ are part of words */
+	FORCEINLINE uint16x8_t WordCharacters(const uint16x8_t Characters)
+	{
+		return vorrq_u16(vcgeq_u16(Characters, vdupq_n_u16(A_CHARACTER)), vceqq_u16(Characters, vdupq_n_u16(TAG_CHARACTER)));
+	}
+
+	/** Space and sentence separators .!? split words */
+	FORCEINLINE uint16x8_t SpaceCharacters(const uint16x8_t Characters)
+	{
+		return vorrq_u16(vorrq_u16(vceqq_u16(Characters, vdupq_n_u16(SPACE_CHARACTER)), vceqq_u16(Characters, vdupq_n_u16('!'))),
+		                 vorrq_u16(vceqq_u16(Characters, vdupq_n_u16('.')), vceqq_u16(Characters, vdupq_n_u16('?'))));
+	}
+
+	/**
+	 * Lowercases block of ASCII characters and classifies them, result is the same as from UNaturalDialogSystemLibrary::NormalizeCharacter()
+	 * @param Input - BlockSize characters
+	 * @param OutLowered - Lowercased characters of block
+	 * @param OutWordMask - Bit is set for characters, which are part of word
+	 * @param OutSpaceMask - Bit is set for characters, which split words
+	 * @return - False, if block contains non ASCII character, then it has to be normalized one by one
+	 */
+	FORCEINLINE bool NormalizeAsciiBlock(const TCHAR* Input, TCHAR* OutLowered, uint32& OutWordMask, uint32& OutSpaceMask)
+	{
+		const uint16x8_t Low = vld1q_u16(reinterpret_cast<const uint16*>(Input));
+		const uint16x8_t High = vld1q_u16(reinterpret_cast<const uint16*>(Input + 8));
+
+		// Any bit above 7 means non ASCII character, saturating narrow keeps also the high byte of lane non zero
+		const uint8x8_t NonAscii = vqmovn_u16(vshrq_n_u16(vorrq_u16(Low, High), 7));
+		if (vget_lane_u64(vreinterpret_u64_u8(NonAscii), 0) != 0)
+		{
+			return false;
+		}
+
+		vst1q_u16(reinterpret_cast<uint16*>(OutLowered), Lower(Low));
+		vst1q_u16(reinterpret_cast<uint16*>(OutLowered + 8), Lower(High));
+
+		OutWordMask = MoveMask(WordCharacters(Low), WordCharacters(High));
+		OutSpaceMask = MoveMask(SpaceCharacters(Low), SpaceCharacters(High));
+		return true;
+	}
+
+#else
+
+	FORCEINLINE __m128i Lower(const __m128i Characters)
+	{
+		// Characters are ASCII, so signed compare is valid
+		const __m128i IsUpper = _mm_and_si128(_mm_cmpgt_epi16(Characters, _mm_set1_epi16('A' - 1)), _mm_cmplt_epi16(Characters, _mm_set1_epi16('Z' + 1)));
+		return _mm_or_si128(Characters, _mm_and_si128(IsUpper, _mm_set1_epi16(0x20)));
+	}
+
+	/** Characters >= 'A' and $ are part of words */
+	FORCEINLINE __m128i WordCharacters(const __m128i Characters)
+	{
+		return _mm_or_si128(_mm_cmpgt_epi16(Characters, _mm_set1_epi16(A_CHARACTER - 1)), _mm_cmpeq_epi16(Characters, _mm_set1_epi16(TAG_CHARACTER)));
+	}
+
+	/** Space and sentence separators .!? split words */
+	FORCEINLINE __m128i SpaceCharacters(const __m128i Characters)
+	{
+		return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(Characters, _mm_set1_epi16(SPACE_CHARACTER)), _mm_cmpeq_epi16(Characters, _mm_set1_epi16('!'))),
+		                    _mm_or_si128(_mm_cmpeq_epi16(Characters, _mm_set1_epi16('.')), _mm_cmpeq_epi16(Characters, _mm_set1_epi16('?'))));
+	}
+
+	/** Returns bit for every lane of two 16 bit masks, bit i is set for character i */
+	FORCEINLINE uint32 MoveMask(const __m128i Low, const __m128i High)
+	{
+		return static_cast<uint32>(_mm_movemask_epi8(_mm_packs_epi16(Low, High)));
+	}
+
+	/**
+	 * Lowercases block of ASCII characters and classifies them, result is the same as from UNaturalDialogSystemLibrary::NormalizeCharacter()
+	 * @param Input - BlockSize characters
+	 * @param OutLowered - Lowercased characters of block
+	 * @param OutWordMask - Bit is set for characters, which are part of word
+	 * @param OutSpaceMask - Bit is set for characters, which split words
+	 * @return - False, if block contains non ASCII character, then it has to be normalized one by one
+	 */
+	FORCEINLINE bool NormalizeAsciiBlock(const TCHAR* Input, TCHAR* OutLowered, uint32& OutWordMask, uint32& OutSpaceMask)
+	{
+		const __m128i Low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input));
+		const __m128i High = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 8));
+
+		// Any bit above 7 means non ASCII character
+		const __m128i NonAscii = _mm_and_si128(_mm_or_si128(Low, High), _mm_set1_epi16(static_cast<int16>(0xFF80)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(NonAscii, _mm_setzero_si128())) != 0xFFFF)
+		{
+			return false;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutLowered), Lower(Low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(OutLowered + 8), Lower(High));
+
+		OutWordMask = MoveMask(WordCharacters(Low), WordCharacters(High));
+		OutSpaceMask = MoveMask(SpaceCharacters(Low), SpaceCharacters(High));
+		return true;
+	}
+
+#endif
+}
+
+#endif
+
+namespace NormalizationTable
+{
+	/** Num of entries of table, one for every UTF-16 code unit */
+	constexpr int32 NumOfEntries = 65536;
+
+	/** Returns true, if codepoint is part of UTF-16 surrogate pair */
+	FORCEINLINE bool IsSurrogate(const int32 Codepoint)
+	{
+		return Codepoint >= 0xD800 && Codepoint <= 0xDFFF;
+	}
+
+	/** Returns true, if codepoint is combining diacritical mark, marks are removed by diacritics folding */
+	FORCEINLINE bool IsCombiningDiacritic(const int32 Codepoint)
+	{
+		return (Codepoint >= 0x0300 && Codepoint <= 0x036F) || (Codepoint >= 0x1AB0 && Codepoint <= 0x1AFF) || (Codepoint >= 0x1DC0 && Codepoint <= 0x1DFF) ||
+		       (Codepoint >= 0x20D0 && Codepoint <= 0x20FF) || (Codepoint >= 0xFE20 && Codepoint <= 0xFE2F);
+	}
+
+	/** Returns true, if codepoint ends sentence in non latin script, it splits words as .!? */
+	bool IsSentenceTerminator(const int32 Codepoint)
+	{
+		switch (Codepoint)
+		{
+		case 0x037E: // Greek question mark
+		case 0x0589: // Armenian full stop
+		case 0x061F: // Arabic question mark
+		case 0x06D4: // Arabic full stop
+		case 0x0964: // Devanagari danda
+		case 0x0965: // Devanagari double danda
+		case 0x2026: // Horizontal ellipsis
+		case 0x203C: // Double exclamation mark
+		case 0x2047: // Double question mark
+		case 0x2048: // Question exclamation mark
+		case 0x2049: // Exclamation question mark
+		case 0x3002: // Ideographic full stop
+		case 0xFF61: // Halfwidth ideographic full stop
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/**
+	 * Maps precomposed letters to letters without diacritics, e.g. U+00E1 -> a, U+1EBF -> U+00EA -> e
+	 * Folded letters are found by canonical composition of base letter and combining mark from utf8proc data
+	 * @param OutFolded - Folded character for every UTF-16 code unit, characters without diacritics are mapped to themselves
+	 */
+	void BuildDiacriticsFolding(TArray<TCHAR>& OutFolded)
+	{
+		OutFolded.SetNumUninitialized(NumOfEntries);
+		for (int32 Codepoint = 0; Codepoint < NumOfEntries; Codepoint++)
+		{
+			OutFolded[Codepoint] = static_cast<TCHAR>(Codepoint);
+		}
+
+		TArray<int32> Marks;
+		for (int32 Codepoint = 0; Codepoint < NumOfEntries; Codepoint++)
+		{
+			if (IsCombiningDiacritic(Codepoint) && utf8proc_category(Codepoint) == UTF8PROC_CATEGORY_MN)
+			{
+				Marks.Add(Codepoint);
+			}
+		}
+
+		for (int32 Base = 0; Base < NumOfEntries; Base++)
+		{
+			if (IsSurrogate(Base))
+			{
+				continue;
+			}
+
+			// Only characters with composition index can be the first character of composition
+			const utf8proc_property_t* Property = utf8proc_get_property(Base);
+			if (Property->comb_index >= 0x8000 || Property->category < UTF8PROC_CATEGORY_LU || Property->category > UTF8PROC_CATEGORY_LO)
+			{
+				continue;
+			}
+
+			for (const int32 Mark : Marks)
+			{
+				utf8proc_int32_t Composition[2] = {Base, Mark};
+				if (utf8proc_normalize_utf32(Composition, 2, UTF8PROC_COMPOSE) == 1 && Composition[0] < NumOfEntries)
+				{
+					OutFolded[Composition[0]] = static_cast<TCHAR>(Base);
+				}
+			}
+		}
+
+		// Letters with more marks are composed from letters with one mark, so they are folded to the letter without any mark
+		for (int32 Codepoint = 0; Codepoint < NumOfEntries; Codepoint++)
+		{
+			TCHAR Folded = OutFolded[Codepoint];
+			while (OutFolded[Folded] != Folded)
+			{
+				Folded = OutFolded[Folded];
+			}
+			OutFolded[Codepoint] = Folded;
+		}
+	}
+}
+
+
+TSet<UDataTable*> UNaturalDialogSystemLibrary::GetListOfDialogDataTables()
+{
+	int32 NumOfScannedAssets = 0;
+	int32 NumOfLoadedAssets = 0;
+	return GetListOfDialogDataTables(NumOfScannedAssets, NumOfLoadedAssets);
+}
+
+TSet<UDataTable*> UNaturalDialogSystemLibrary::GetListOfDialogDataTables(int32& OutNumOfScannedAssets, int32& OutNumOfLoadedAssets)
+{
+	OutNumOfScannedAssets = 0;
+	OutNumOfLoadedAssets = 0;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// In editor, asset registry can still gather data in background, we need the full list of assets
+	if (AssetRegistry.IsLoadingAssets())
+	{
+		AssetRegistry.SearchAllAssets(true);
+	}
+
+	// Finds all tables in content, only asset metadata are used, nothing is loaded
+	FARFilter Filter;
+	Filter.ClassNames.Add(UDataTable::StaticClass()->GetFName());
+	Filter.PackagePaths.Add(TEXT("/Game"));
+	Filter.bRecursiveClasses = true;
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> FoundAssets;
+	AssetRegistry.GetAssets(Filter, FoundAssets);
+
+	const TSet<FName> DialogRowStructNames = GetDialogRowStructNames();
+
+	TSet<UDataTable*> Result;
+	Result.Reserve(FoundAssets.Num());
+
+	for (const FAssetData& AssetData : FoundAssets)
+	{
+		OutNumOfScannedAssets++;
+
+		// We sort out tables with correct natural dialog struct, tag can contain short name or full path of the struct
+		FString RowStructure;
+		if (AssetData.GetTagValue(TEXT("RowStructure"), RowStructure))
+		{
+			const FName RowStructName = FName(*FPackageName::ObjectPathToObjectName(RowStructure));
+			if (!DialogRowStructNames.Contains(RowStructName))
+			{
+				continue;
+			}
+		}
+
+		// Tables without tag (e.g. not resaved assets) must be loaded to check the row struct
+		UDataTable* Table = Cast<UDataTable>(AssetData.GetAsset());
+		OutNumOfLoadedAssets++;
+
+		if (Table && Table->GetRowStruct() && Table->GetRowStruct()->IsChildOf(FNaturalDialogRow::StaticStruct()))
+		{
+			Result.Add(Table);
+		}
+	}
+
+	return Result;
+}
+
+TArray<FString> UNaturalDialogSystemLibrary::GetTableTerms(const UDataTable* InTable)
+{
+	TArray<FString> Result;
+
+	if (!InTable || !InTable->GetRowStruct())
+	{
+		return Result;
+	}
+
+	// Iterate all rows from table and collect all words
+	if (InTable->GetRowStruct()->IsChildOf(FNaturalDialogRow_Keyword::StaticStruct()))
+	{
+		InTable->ForeachRow<FNaturalDialogRow_Keyword>(TEXT("Words registration"), [&Result](const FName& Key, const FNaturalDialogRow_Keyword& Value)
+		{
+			Result.Append(SplitSentenceIntoNormalizedTerms(Value.Ask.ToString()));
+
+			for (int32 i = 0; i < Value.Answer.Num(); i++)
+			{
+				Result.Append(SplitSentenceIntoNormalizedTerms(Value.Answer[i].Answer.ToString()));
+			}
+
+			for (const FText& Keyword : Value.Keywords)
+			{
+				Result.Add(NormalizeTerm(Keyword.ToString()));
+			}
+		});
+	}
+	else if (InTable->GetRowStruct()->IsChildOf(FNaturalDialogRow::StaticStruct()))
+	{
+		InTable->ForeachRow<FNaturalDialogRow>(TEXT("Words registration"), [&Result](const FName& Key, const FNaturalDialogRow& Value)
+		{
+			Result.Append(SplitSentenceIntoNormalizedTerms(Value.Ask.ToString()));
+
+			for (int32 i = 0; i < Value.Answer.Num(); i++)
+			{
+				Result.Append(SplitSentenceIntoNormalizedTerms(Value.Answer[i].Answer.ToString()));
+			}
+		});
+	}
+
+	return Result;
+}
+
+void UNaturalDialogSystemLibrary::NormalizeIntoBuffer(const TCHAR* Input, const int32 InputLen, TArray<TCHAR>& OutChars, TArray<FNormalizedWord>& OutWords)
+{
+	// Normalized text is never longer than input, so buffer is allocated only once
+	const int32 BaseNum = OutChars.Num();
+	OutChars.SetNumUninitialized(BaseNum + InputLen, false);
+
+	TCHAR* const Buffer = OutChars.GetData();
+	int32 NumOfChars = BaseNum;
+	int32 WordStart = BaseNum;
+
+	const auto EndWord = [&NumOfChars, &WordStart, &OutWords]()
+	{
+		if (NumOfChars > WordStart)
+		{
+			OutWords.Add({WordStart, NumOfChars - WordStart});
+			WordStart = NumOfChars;
+		}
+	};
+
+	const TCHAR* const Table = GetNormalizationTable();
+
+	const auto AppendCharacter = [&NumOfChars, Buffer, &EndWord, Table](const TCHAR Character)
+	{
+#if PLATFORM_TCHAR_IS_4_BYTES
+		const TCHAR Normalized = static_cast<uint32>(Character) < static_cast<uint32>(NormalizationTable::NumOfEntries) ? Table[Character] : NormalizeCharacter(Character);
+#else
+		const TCHAR Normalized = Table[Character];
+#endif
+		if (IsSpaceChar(Normalized))
+		{
+			EndWord();
+		}
+		else if (Normalized != NULL_CHARACTER)
+		{
+			Buffer[NumOfChars++] = Normalized;
+		}
+	};
+
+	int32 Index = 0;
+
+#if NORMALIZED_TEXT_SIMD
+
+	TCHAR Lowered[NormalizedText::BlockSize];
+
+	for (; Index + NormalizedText::BlockSize <= InputLen; Index += NormalizedText::BlockSize)
+	{
+		uint32 WordMask = 0;
+		uint32 SpaceMask = 0;
+
+		if (!NormalizedText::NormalizeAsciiBlock(Input + Index, Lowered, WordMask, SpaceMask))
+		{
+			for (int32 i = 0; i < NormalizedText::BlockSize; i++)
+			{
+				AppendCharacter(Input[Index + i]);
+			}
+			continue;
+		}
+
+		// The most common case, whole block is inside of one word
+		if (WordMask == NormalizedText::FullBlockMask)
+		{
+			FMemory::Memcpy(Buffer + NumOfChars, Lowered, NormalizedText::BlockSize * sizeof(TCHAR));
+			NumOfChars += NormalizedText::BlockSize;
+			continue;
+		}
+
+		// Runs of word characters are copied at once, other characters are skipped
+		uint32 Pending = WordMask | SpaceMask;
+		while (Pending != 0)
+		{
+			const uint32 Position = FMath::CountTrailingZeros(Pending);
+
+			if (SpaceMask & (1u << Position))
+			{
+				EndWord();
+				Pending &= Pending - 1;
+			}
+			else
+			{
+				const uint32 RunLen = FMath::CountTrailingZeros(~(WordMask >> Position));
+				FMemory::Memcpy(Buffer + NumOfChars, Lowered + Position, RunLen * sizeof(TCHAR));
+				NumOfChars += RunLen;
+				Pending &= ~(((1u << RunLen) - 1) << Position);
+			}
+		}
+	}
+
+#endif
+
+	for (; Index < InputLen; Index++)
+	{
+		AppendCharacter(Input[Index]);
+	}
+
+	EndWord();
+	OutChars.SetNum(NumOfChars, false);
+}
+
+TArray<FString> UNaturalDialogSystemLibrary::SplitSentenceIntoNormalizedTerms(const FString& Input)
+{
+	const FScopedNormalizedText NormalizedText(Input);
+
+	TArray<FString> Result;
+	Result.Reserve(NormalizedText->Num());
+
+	for (int32 i = 0; i < NormalizedText->Num(); i++)
+	{
+		const FStringView Word = NormalizedText->GetWord(i);
+		Result.Emplace(Word.Len(), Word.GetData());
+	}
+
+	return Result;
+}
+
+FString UNaturalDialogSystemLibrary::NormalizeTerm(const FString& Input)
+{
+	// Term is all words without spaces
+	const FScopedNormalizedText NormalizedText(Input);
+	const FStringView Term = NormalizedText->GetText();
+
+	return FString(Term.Len(), Term.GetData());
+}
+
+TArray<FString> UNaturalDialogSystemLibrary::SplitToSentences(const FString& Input)
+{
+	TArray<FStringView> Sentences;
+	SplitToSentences(Input, Sentences);
+
+	TArray<FString> Result;
+	Result.Reserve(Sentences.Num());
+
+	for (const FStringView& Sentence : Sentences)
+	{
+		Result.Emplace(Sentence.Len(), Sentence.GetData());
+	}
+
+	return Result;
+}
+
+void UNaturalDialogSystemLibrary::SplitToSentences(const FStringView& Input, TArray<FStringView>& OutSentences)
+{
+	// Separators at the beginning of sentence are skipped, so every sentence is continuous part of input
+	int32 SentenceStart = INDEX_NONE;
+
+	for (int32 Index = 0; Index < Input.Len(); Index++)
+	{
+		if (IsSentenceSeparator(Input[Index]))
+		{
+			if (SentenceStart != INDEX_NONE)
+			{
+				OutSentences.Emplace(Input.GetData() + SentenceStart, Index + 1 - SentenceStart);
+				SentenceStart = INDEX_NONE;
+			}
+		}
+		else if (SentenceStart == INDEX_NONE)
+		{
+			SentenceStart = Index;
+		}
+	}
+
+	if (SentenceStart != INDEX_NONE)
+	{
+		OutSentences.Emplace(Input.GetData() + SentenceStart, Input.Len() - SentenceStart);
+	}
+}
+
+void UNaturalDialogSystemLibrary::SplitToWords(const FStringView& Input, TArray<FStringView>& OutWords)
+{
+	int32 WordStart = 0;
+
+	for (int32 Index = 0; Index <= Input.Len(); Index++)
+	{
+		if (Index == Input.Len() || IsSpaceChar(Input[Index]))
+		{
+			if (Index > WordStart)
+			{
+				OutWords.Emplace(Input.GetData() + WordStart, Index - WordStart);
+			}
+			WordStart = Index + 1;
+		}
+	}
+}
+
+FString UNaturalDialogSystemLibrary::NormalizeWord(const FString& Input)
+{
+	return NormalizeTerm(Input);
+}
+
+TCHAR UNaturalDialogSystemLibrary::NormalizeCharacter(const TCHAR Character)
+{
+	const int32 Codepoint = static_cast<int32>(Character);
+
+	if (Codepoint < 128)
+	{
+		if (IsSpaceChar(Character) || IsTagCharacter(Character))
+		{
+			return Character;
+		}
+
+		if (IsSentenceSeparator(Character))
+		{
+			return SPACE_CHARACTER;
+		}
+
+		if (IsSpecialChar(Character))
+		{
+			return NULL_CHARACTER;
+		}
+
+		return static_cast<TCHAR>(utf8proc_tolower(Codepoint));
+	}
+
+	// Fullwidth forms of ASCII characters are written by CJK input methods
+	if (Codepoint >= 0xFF01 && Codepoint <= 0xFF5E)
+	{
+		return NormalizeCharacter(static_cast<TCHAR>(Codepoint - 0xFF01 + 0x21));
+	}
+
+	// Both halves of surrogate pair stay in word, characters outside of BMP are not normalized
+	if (NormalizationTable::IsSurrogate(Codepoint))
+	{
+		return Character;
+	}
+
+	if (Codepoint > 0x10FFFF)
+	{
+		return NULL_CHARACTER;
+	}
+
+	if (NormalizationTable::IsSentenceTerminator(Codepoint))
+	{
+		return SPACE_CHARACTER;
+	}
+
+	switch (utf8proc_category(Codepoint))
+	{
+	case UTF8PROC_CATEGORY_LU:
+	case UTF8PROC_CATEGORY_LL:
+	case UTF8PROC_CATEGORY_LT:
+	case UTF8PROC_CATEGORY_LM:
+	case UTF8PROC_CATEGORY_LO:
+		{
+			// Lowercase letter has to fit into one code unit, otherwise the letter is kept
+			const utf8proc_int32_t Lowered = utf8proc_tolower(Codepoint);
+			return Lowered < NormalizationTable::NumOfEntries || sizeof(TCHAR) == 4 ? static_cast<TCHAR>(Lowered) : Character;
+		}
+	case UTF8PROC_CATEGORY_MN:
+	case UTF8PROC_CATEGORY_MC:
+	case UTF8PROC_CATEGORY_ME:
+	case UTF8PROC_CATEGORY_CO:
+	case UTF8PROC_CATEGORY_CN:
+		// Marks are part of words in many scripts, private and unassigned characters are kept as they are
+		return Character;
+	case UTF8PROC_CATEGORY_ZS:
+	case UTF8PROC_CATEGORY_ZL:
+	case UTF8PROC_CATEGORY_ZP:
+		return SPACE_CHARACTER;
+	default:
+		// Numbers, punctuation, symbols and control characters are removed, the same as ASCII ones
+		return NULL_CHARACTER;
+	}
+}
+
+const TCHAR* UNaturalDialogSystemLibrary::GetNormalizationTable()
+{
+	const auto BuildTable = [](const bool bFoldDiacritics)
+	{
+		TArray<TCHAR> Folded;
+		if (bFoldDiacritics)
+		{
+			NormalizationTable::BuildDiacriticsFolding(Folded);
+		}
+
+		TArray<TCHAR> Result;
+		Result.SetNumUninitialized(NormalizationTable::NumOfEntries);
+
+		for (int32 Codepoint = 0; Codepoint < NormalizationTable::NumOfEntries; Codepoint++)
+		{
+			TCHAR Normalized = NormalizeCharacter(static_cast<TCHAR>(Codepoint));
+			if (bFoldDiacritics && static_cast<int32>(Normalized) < NormalizationTable::NumOfEntries)
+			{
+				Normalized = NormalizationTable::IsCombiningDiacritic(Normalized) ? NULL_CHARACTER : Folded[Normalized];
+			}
+			Result[Codepoint] = Normalized;
+		}
+
+		return Result;
+	};
+
+	// Static locals are initialized only once even if more threads normalize text, table with folding is built only if it is used
+	if (GetDefault<UNaturalDialogSystemSettings>()->GetFoldDiacritics())
+	{
+		static const TArray<TCHAR> FoldingTable = BuildTable(true);
+		return FoldingTable.GetData();
+	}
+
+	static const TArray<TCHAR> Table = BuildTable(false);
+	return Table.GetData();
+}
+
+TSet<FName> UNaturalDialogSystemLibrary::GetDialogRowStructNames()
+{
+	TSet<FName> Result;
+
+	for (TObjectIterator<UScriptStruct> It; It; ++It)
+	{
+		if (It->IsChildOf(FNaturalDialogRow::StaticStruct()))
+		{
+			Result.Add(It->GetFName());
+		}
+	}
+
+	return Result;
+}
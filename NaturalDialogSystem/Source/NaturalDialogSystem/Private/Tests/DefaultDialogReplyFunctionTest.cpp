@@ -0,0 +1,138 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/DefaultDialogReplyFunction.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DefaultDialogReplyFunctionTest
+{
+	/**
+	 * Original recursive enumeration of keyword combinations, combination tables are intersection of tables of its keywords
+	 * Tables are bitsets instead of TSet, so measured time is lower bound of the original implementation
+	 */
+	void CombinationUtil(const TArrayView<const uint64>& KeywordTables, const int32 NumOfWords, TArray<int32>& Data, const int32 Start, const int32 End, const int32 Index, const int32 CombinationSize, TArray<TArray<uint64>>& OutCombinations)
+	{
+		// Current combination is ready
+		if (Index == CombinationSize)
+		{
+			TArray<uint64>& TableSet = OutCombinations.AddDefaulted_GetRef();
+			TableSet.Append(&KeywordTables[Data[0] * NumOfWords], NumOfWords);
+
+			for (int32 i = 1; i < Data.Num(); i++)
+			{
+				for (int32 Word = 0; Word < NumOfWords; Word++)
+				{
+					TableSet[Word] &= KeywordTables[Data[i] * NumOfWords + Word];
+				}
+			}
+
+			return;
+		}
+
+		for (int32 i = Start; i <= End && End - i + 1 >= CombinationSize - Index; i++)
+		{
+			Data[Index] = i;
+			CombinationUtil(KeywordTables, NumOfWords, Data, i + 1, End, Index + 1, CombinationSize, OutCombinations);
+		}
+	}
+
+	/** Original selection of the biggest table set from all keyword combinations */
+	TArray<uint64> FindBestTableBits_Reference(const TArrayView<const uint64>& KeywordTables, const int32 NumOfWords)
+	{
+		const int32 NumOfKeywords = KeywordTables.Num() / NumOfWords;
+
+		TArray<TArray<uint64>> Combinations;
+		if (NumOfKeywords < UDefaultDialogReplyFunction::MinCombination)
+		{
+			// Just use tables of the one keyword
+			Combinations.Add(TArray<uint64>(KeywordTables.GetData(), NumOfWords));
+		}
+		else
+		{
+			for (int32 Size = UDefaultDialogReplyFunction::MinCombination; Size <= NumOfKeywords; Size++)
+			{
+				TArray<int32> Data;
+				Data.SetNum(Size);
+				CombinationUtil(KeywordTables, NumOfWords, Data, 0, NumOfKeywords - 1, 0, Size, Combinations);
+			}
+		}
+
+		TArray<int32> CachedSizes;
+		for (const TArray<uint64>& Combination : Combinations)
+		{
+			int32 Size = 0;
+			for (const uint64 Word : Combination)
+			{
+				Size += FPlatformMath::CountBits(Word);
+			}
+			CachedSizes.Add(Size);
+		}
+
+		int32 MaxIndex = INDEX_NONE;
+		int32 MaxValue = -1;
+		UKismetMathLibrary::MaxOfIntArray(CachedSizes, MaxIndex, MaxValue);
+
+		return Combinations[MaxIndex];
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDefaultDialogReplyFunctionFindBestTablesTest, "NaturalDialogSystem.DefaultDialogReplyFunction.FindBestTableBits",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FDefaultDialogReplyFunctionFindBestTablesTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x4E445349);
+
+	for (int32 NumOfKeywords = 1; NumOfKeywords <= 20; NumOfKeywords++)
+	{
+		// Enumeration of all combinations is exponential, so large inputs are tested less times
+		const int32 NumOfIterations = NumOfKeywords <= 14 ? 20 : 2;
+
+		double ReferenceTime = 0.0;
+		double BestTablesTime = 0.0;
+
+		for (int32 Iteration = 0; Iteration < NumOfIterations; Iteration++)
+		{
+			const int32 NumOfTables = Random.RandRange(1, 200);
+			const int32 NumOfWords = (NumOfTables + 63) / 64;
+
+			// Dense keywords share many tables, so there are many ties of table set sizes
+			const float Density = Random.FRandRange(0.05f, 0.9f);
+
+			TArray<uint64> KeywordTables;
+			KeywordTables.SetNumZeroed(NumOfKeywords * NumOfWords);
+			for (int32 Keyword = 0; Keyword < NumOfKeywords; Keyword++)
+			{
+				for (int32 Table = 0; Table < NumOfTables; Table++)
+				{
+					if (Random.FRand() < Density)
+					{
+						KeywordTables[Keyword * NumOfWords + Table / 64] |= 1ull << (Table % 64);
+					}
+				}
+			}
+
+			double StartTime = FPlatformTime::Seconds();
+			const TArray<uint64> Expected = DefaultDialogReplyFunctionTest::FindBestTableBits_Reference(KeywordTables, NumOfWords);
+			ReferenceTime += FPlatformTime::Seconds() - StartTime;
+
+			TArray<uint64> BestTables;
+			BestTables.SetNumUninitialized(NumOfWords);
+
+			StartTime = FPlatformTime::Seconds();
+			UDefaultDialogReplyFunction::FindBestTableBits(KeywordTables, NumOfWords, BestTables);
+			BestTablesTime += FPlatformTime::Seconds() - StartTime;
+
+			TestTrue(FString::Printf(TEXT("%d keywords and %d tables select the same table set"), NumOfKeywords, NumOfTables), BestTables == Expected);
+		}
+
+		AddInfo(FString::Printf(TEXT("%d keywords: combinations %.3f ms, keyword pairs %.3f ms"), NumOfKeywords, ReferenceTime * 1000.0 / NumOfIterations, BestTablesTime * 1000.0 / NumOfIterations));
+	}
+
+	return true;
+}
+
+#endif
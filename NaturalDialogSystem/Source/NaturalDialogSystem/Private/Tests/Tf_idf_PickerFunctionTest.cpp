@@ -0,0 +1,99 @@
+// Created by Michal Chamula. All rights reserved.
+
+
+#include "DefaultClasses/Tf_idf_PickerFunction.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Misc/AutomationTest.h"
+#include "Resources/Resources.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace Tf_idf_PickerFunctionTest
+{
+	/** Original O(n^2) selection by repeated search of max value, SelectKeywordIndexes() has to select the same keywords */
+	TArray<int32> SelectKeywordIndexes_Reference(TArray<float> Values)
+	{
+		TArray<int32> Result;
+		TArray<int32> Indexes;
+		for (int32 i = 0; i < Values.Num(); i++)
+		{
+			Indexes.Add(i);
+		}
+
+		// Find the max value of array
+		int32 IndexOfMaxValue = -1;
+		float ArrMaxValue = 0.f;
+		UKismetMathLibrary::MaxOfFloatArray(Values, IndexOfMaxValue, ArrMaxValue);
+
+		if (ArrMaxValue > 0 && Values.IsValidIndex(IndexOfMaxValue))
+		{
+			const float Precision = UKismetMathLibrary::MapRangeClamped(Values.Num(), 4, 10, 1.f, 0.5f);
+
+			Result.Add(Indexes[IndexOfMaxValue]);
+			Values.RemoveAt(IndexOfMaxValue);
+			Indexes.RemoveAt(IndexOfMaxValue);
+
+			const int32 NumOfRepeats = FMath::RoundToInt((Values.Num() * Precision) - 1);
+			for (int32 i = 0; i < NumOfRepeats; i++)
+			{
+				UKismetMathLibrary::MaxOfFloatArray(Values, IndexOfMaxValue, ArrMaxValue);
+				if (Values.IsValidIndex(IndexOfMaxValue) && (i <= MIN_KEYWORDS_COUNT || ArrMaxValue > 0))
+				{
+					Result.Add(Indexes[IndexOfMaxValue]);
+					Indexes.RemoveAt(IndexOfMaxValue);
+					Values.RemoveAt(IndexOfMaxValue);
+				}
+			}
+		}
+
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTf_idf_SelectKeywordIndexesTest, "NaturalDialogSystem.Tf_idf_PickerFunction.SelectKeywordIndexes",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTf_idf_SelectKeywordIndexesTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(0x4E445349);
+
+	const auto TestValues = [this](const TCHAR* What, const TArray<float>& Values)
+	{
+		const TArray<int32> Expected = Tf_idf_PickerFunctionTest::SelectKeywordIndexes_Reference(Values);
+		const TArray<int32> Selected = UTf_idf_PickerFunction::SelectKeywordIndexes(Values);
+		TestTrue(FString::Printf(TEXT("%s values (%d) select the same keywords"), What, Values.Num()), Selected == Expected);
+	};
+
+	for (int32 NumOfValues = 0; NumOfValues <= 40; NumOfValues++)
+	{
+		for (int32 Iteration = 0; Iteration < 25; Iteration++)
+		{
+			TArray<float> Values;
+
+			// Continuous values, ties are rare
+			for (int32 i = 0; i < NumOfValues; i++)
+			{
+				Values.Add(Random.FRand());
+			}
+			TestValues(TEXT("Random"), Values);
+
+			// Few distinct values with zeros, so most of keywords are tied and zero values decide the count of keywords
+			for (int32 i = 0; i < NumOfValues; i++)
+			{
+				Values[i] = Random.RandRange(0, 3) * 0.25f;
+			}
+			TestValues(TEXT("Tied"), Values);
+		}
+
+		TArray<float> Values;
+		Values.Init(0.f, NumOfValues);
+		TestValues(TEXT("Zero"), Values);
+
+		Values.Init(0.5f, NumOfValues);
+		TestValues(TEXT("Equal"), Values);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,171 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Core/PlayerNaturalDialogComponent.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "DialogReplyBatchSubsystem.generated.h"
+
+class FDialogReplyMatcher;
+class UNpcNaturalDialogComponent;
+
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDialogReplyBatchSubsystem, Log, All);
+
+/**
+ * Statistics of batched reply resolution, @see UDialogReplyBatchSubsystem
+ */
+USTRUCT(BlueprintType)
+struct FDialogReplyBatchStats
+{
+	GENERATED_BODY()
+
+	FDialogReplyBatchStats()
+		: NumOfRequests(0), NumOfSentences(0), NumOfQueries(0), MatchingTime(0.f), AverageQueueLatency(0.f), MaxQueueLatency(0.f), TotalRequests(0), TotalBatches(0) {}
+
+	/** Count of requests resolved by the last batch, it is throughput of the frame when batch was finished */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfRequests;
+
+	/** Count of sentences of all requests in the last batch */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfSentences;
+
+	/** Count of unique sentences, which were matched in the last batch, identical inputs are matched once */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfQueries;
+
+	/** Time in seconds of parallel matching of the last batch */
+	UPROPERTY(BlueprintReadOnly)
+	float MatchingTime;
+
+	/** Average time in seconds from request enqueue to its reply, for requests of the last batch */
+	UPROPERTY(BlueprintReadOnly)
+	float AverageQueueLatency;
+
+	/** Max time in seconds from request enqueue to its reply, for requests of the last batch */
+	UPROPERTY(BlueprintReadOnly)
+	float MaxQueueLatency;
+
+	/** Count of all resolved requests */
+	UPROPERTY(BlueprintReadOnly)
+	int32 TotalRequests;
+
+	/** Count of all resolved batches */
+	UPROPERTY(BlueprintReadOnly)
+	int32 TotalBatches;
+};
+
+/**
+ * Reply request waiting in batch queue
+ */
+struct FBatchedReplyRequest
+{
+	FBatchedReplyRequest()
+		: EnqueueTime(0.0) {}
+
+	TWeakObjectPtr<UPlayerNaturalDialogComponent> PlayerComponent;
+	TWeakObjectPtr<const UNpcNaturalDialogComponent> NpcComponent;
+	FText Input;
+	FOnDialogReplyGenerated OnReplyGenerated;
+	double EnqueueTime;
+
+	/** Sentences of input, filled when batch is built */
+	TArray<FString> Sentences;
+
+	/** Index of query in batch for every sentence */
+	TArray<int32> SentenceQueries;
+};
+
+/**
+ * Unique sentence of batch, matched once for all requests with the same input and matcher sharing key
+ * Sentences of players, which matchers can't be shared, are matched separately, @see FDialogReplyMatcher::GetSharingKey()
+ */
+struct FBatchedReplyQuery
+{
+	TSharedPtr<FDialogReplyMatcher, ESPMode::ThreadSafe> Matcher;
+	FString Sentence;
+	TArray<FReplyData> Candidates;
+};
+
+/**
+ * All requests gathered during one frame
+ */
+struct FDialogReplyBatch
+{
+	FDialogReplyBatch()
+		: MatchingTime(0.0) {}
+
+	TArray<FBatchedReplyRequest> Requests;
+	TArray<FBatchedReplyQuery> Queries;
+
+	/** Written by worker thread */
+	double MatchingTime;
+};
+
+/**
+ * Gathers reply requests of all players during frame and resolves them together
+ * Identical normalized sentences asked from the same npc table set are matched only once, if keywords don't depend on player
+ * Unique sentences are matched in parallel against shared dictionary snapshot, results are then resolved by reply function of every player on game thread
+ * Intended for dedicated servers, where replies of many players are generated in the same frame (e.g. near quest hubs)
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UDialogReplyBatchSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Waits for batch in progress */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Adds reply request into queue, requests are resolved in batch at the end of frame
+	 * @param PlayerComponent - Component of player, which asks for the reply
+	 * @param Input - Player text input
+	 * @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
+	 * @param OnReplyGenerated - Fired on game thread with NPC dialog responses
+	 */
+	void EnqueueReplyRequest(UPlayerNaturalDialogComponent* PlayerComponent, const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const FOnDialogReplyGenerated& OnReplyGenerated);
+
+	/**
+	 * Removes queued requests of player and waits for active batch, if it matches any request of player
+	 * Must be called before player component is destroyed, because matchers of batch read its reply function
+	 * @param PlayerComponent - Component of player, which is removed
+	 */
+	void CancelPlayerRequests(const UPlayerNaturalDialogComponent* PlayerComponent);
+
+	/** Returns statistics of resolved batches */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	FDialogReplyBatchStats GetBatchStats() const { return Stats; }
+
+	/** Returns count of requests waiting for next batch */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	int32 GetNumOfPendingRequests() const { return PendingRequests.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return PendingRequests.Num() > 0 && !ActiveBatch.IsValid(); }
+	virtual ETickableTickType GetTickableTickType() const override { return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional; }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogReplyBatchSubsystem, STATGROUP_Tickables); }
+
+private:
+	/** Splits requests into unique queries and starts parallel matching */
+	void StartBatch();
+
+	/** Resolves requests of matched batch and fires their delegates */
+	void FinishBatch(const TSharedRef<FDialogReplyBatch, ESPMode::ThreadSafe>& Batch);
+
+	/** Requests waiting for next batch */
+	TArray<FBatchedReplyRequest> PendingRequests;
+
+	/** Batch, which is matched on worker threads, only one batch is matched at time */
+	TSharedPtr<FDialogReplyBatch, ESPMode::ThreadSafe> ActiveBatch;
+
+	/** Worker task of active batch */
+	TFuture<void> ActiveBatchTask;
+
+	FDialogReplyBatchStats Stats;
+};
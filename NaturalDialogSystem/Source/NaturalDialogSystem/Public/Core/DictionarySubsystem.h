@@ -1,84 +1,278 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-#include "PlayerNaturalDialogComponent.h"
-#include "Subsystems/GameInstanceSubsystem.h"
-#include "DictionarySubsystem.generated.h"
-
-class UDictionaryWordPickerFunction;
-class UDictionaryRepresentation;
-class UKeywordPickerFunction;
-
-
-DECLARE_LOG_CATEGORY_EXTERN(LogDictSubsystem, Log, All);
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API UDictionarySubsystem : public UGameInstanceSubsystem
-{
-	GENERATED_BODY()
-
-public:
-	/**
-	 * Initialize all dictionary settings
-	 * Spawn friendly classes instances
-	 * Checks if all developer settings are set
-	 */
-	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
-
-	/**
-	 * Checks if all developers settings are set correctly in project settings
-	 * If no, shows message log for editor
-	 */
-	virtual void Deinitialize() override;
-
-	TArray<FString> GenerateKeywords(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText);
-
-	/**
-	 * Returns dictionary word data object
-	 * @return - Custom dictionary word object representation
-	 */
-	FORCEINLINE const UDictionaryRepresentation* GetDictionary() const { return DictionaryData; }
-
-	FORCEINLINE const UDictionaryWordPickerFunction* GetWordPickerFunction() const { return DictionaryWordPickerFunctionInstance; }
-	
-private:
-	/** Helper function for dictionary object construction */
-	void ConstructDictObject(const TSubclassOf<UDictionaryRepresentation> DictClass);
-
-	/** Helper function for keyword picker object construction */
-	void ConstructKeywordPickerObject(const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass);
-
-	/** Helper function for dictionary word picker object construction */
-	void ConstructDictionaryWordPickerFunctionObject(const TSubclassOf<UDictionaryWordPickerFunction> StringFunctionClass);
-
-
-	/**
-	 * Register all words from data table into dict subsystem
-	 * These words are later used for find game key words
-	 * @param InTable - table which is parsed
-	 */
-	void RegisterWordsFromTable(const UDataTable* InTable);
-
-private:
-	/** Cached all dialog tables in game */
-	UPROPERTY()
-	TSet<UDataTable*> GameNaturalDialogTables;
-
-	/** Strong ref for dictionary data, parsed from game data tables */
-	UPROPERTY()
-	UDictionaryRepresentation* DictionaryData;
-
-	/** Strong ref to word picker singleton function  */
-	UPROPERTY()
-	UDictionaryWordPickerFunction* DictionaryWordPickerFunctionInstance;
-
-	/** Strong ref to keyword picker singleton function  */
-	UPROPERTY()
-	UKeywordPickerFunction* KeywordPickerFunctionInstance;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Async/Future.h"
+#include "Containers/LruCache.h"
+#include "PlayerNaturalDialogComponent.h"
+#include "Misc/ScopeRWLock.h"
+#include "Resources/DictionarySnapshot.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "DictionarySubsystem.generated.h"
+
+class UDictionaryWordPickerFunction;
+class UDictionaryRepresentation;
+class UKeywordPickerFunction;
+
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDictSubsystem, Log, All);
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDictionarySnapshotChanged, const FDictionarySnapshotPtr& /*NewSnapshot*/);
+
+/**
+ * Statistics of word correction cache, @see UDictionarySubsystem::CorrectWord()
+ */
+USTRUCT(BlueprintType)
+struct FWordCorrectionCacheStats
+{
+	GENERATED_BODY()
+
+	FWordCorrectionCacheStats()
+		: NumOfHits(0), NumOfMisses(0), HitRate(0.f), NumOfEntries(0), AllocatedSize(0) {}
+
+	/** Count of words, which correction was found in cache */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfHits;
+
+	/** Count of words, which were searched in dictionary */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfMisses;
+
+	/** Ratio of hits to all corrections */
+	UPROPERTY(BlueprintReadOnly)
+	float HitRate;
+
+	/** Count of cached words */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfEntries;
+
+	/** Approximate memory used by cache entries in bytes, cached words together with entry and lookup overhead */
+	UPROPERTY(BlueprintReadOnly)
+	int64 AllocatedSize;
+};
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UDictionarySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Initialize all dictionary settings
+	 * Spawn friendly classes instances
+	 * Checks if all developer settings are set
+	 */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 * Checks if all developers settings are set correctly in project settings
+	 * If no, shows message log for editor
+	 */
+	virtual void Deinitialize() override;
+
+	TArray<FString> GenerateKeywords(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText);
+
+	/**
+	 * Corrects words of input text and picks keywords from them
+	 * Words are interned right after correction, so keyword picker works only with term ids
+	 * Can be called from worker thread, when EnsureFunctionInstances() was called before on game thread
+	 * @param DialogComponent - Player component, which is asking for keywords
+	 * @param InputText - Sentence from player input
+	 * @return - Term ids of keywords, ids are valid in current and all later snapshots, @see GetSnapshot()
+	 */
+	TArray<uint32> GenerateKeywordTerms(const UPlayerNaturalDialogComponent* DialogComponent, const FString& InputText);
+
+	/**
+	 * Corrects normalized word by word picker function, correction is remembered until new dictionary snapshot is published
+	 * Can be called from any thread, when EnsureFunctionInstances() was called before on game thread
+	 * @param NormalizedWord - Normalized word from player input
+	 * @return - Word from dictionary, or empty string if word was not recognized
+	 */
+	FString CorrectWord(const FString& NormalizedWord) const;
+
+	/**
+	 * Corrects normalized word, @see CorrectWord()
+	 * Memory of output string is reused, so cached corrections don't allocate memory
+	 * @param NormalizedWord - Normalized word from player input, e.g. view from FNormalizedText
+	 * @param OutFixedWord - Word from dictionary, or empty string if word was not recognized
+	 */
+	void CorrectWord(const FStringView& NormalizedWord, FString& OutFixedWord) const;
+
+	/** Returns hit rate and memory use of word correction cache */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	FWordCorrectionCacheStats GetWordCorrectionCacheStats() const;
+
+	/** Creates word and keyword picker instances, when they are not valid, must be called on game thread */
+	void EnsureFunctionInstances();
+
+	/** Returns true, if keywords of sentence are the same for all players, @see UKeywordPickerFunction::IsPlayerIndependent() */
+	bool IsKeywordPickingPlayerIndependent() const;
+
+	/**
+	 * Returns dictionary word data object of current snapshot, only for game thread
+	 * Worker threads have to hold the snapshot, @see GetSnapshot()
+	 * @return - Custom dictionary word object representation
+	 */
+	FORCEINLINE const UDictionaryRepresentation* GetDictionary() const { return CurrentSnapshot.IsValid() ? CurrentSnapshot->GetDictionary() : nullptr; }
+
+	/**
+	 * Returns currently published dictionary snapshot, can be called from any thread
+	 * Snapshot is immutable, so it can be read without locks, keep the pointer for the whole query
+	 */
+	FDictionarySnapshotPtr GetSnapshot() const;
+
+	/**
+	 * Adds dialog tables into dictionary
+	 * Published snapshot is never modified, so new snapshot is built and swapped with the current one
+	 * @param InTables - Dialog tables, already registered tables are ignored
+	 */
+	void AddDialogTables(const TArray<UDataTable*>& InTables);
+
+	/**
+	 * Adds words of dialog table into dictionary, e.g. table of streamed plugin or DLC
+	 * Only words of the table are registered into copy of current dictionary on worker thread, new snapshot is published when it is done
+	 * @param InTable - Dialog table, already registered table is ignored
+	 */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	void AddDialogTable(UDataTable* InTable);
+
+	/**
+	 * Removes words of dialog table from dictionary, e.g. when plugin or DLC content is unloaded
+	 * Word ids stay valid, removed words are only not found by word picker and keyword picker
+	 * @param InTable - Registered dialog table
+	 */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	void RemoveDialogTable(UDataTable* InTable);
+
+	/** Returns true, if words of table are in dictionary or they are waiting for update of dictionary */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	bool ContainsDialogTable(const UDataTable* InTable) const { return GameNaturalDialogTables.Contains(InTable); }
+
+	FORCEINLINE const UDictionaryWordPickerFunction* GetWordPickerFunction() const { return DictionaryWordPickerFunctionInstance; }
+
+	/** Fired on game thread, when new dictionary snapshot is published */
+	FOnDictionarySnapshotChanged OnSnapshotChanged;
+	
+private:
+	/**
+	 * Helper function for dictionary snapshot construction, dictionary object is created for the snapshot
+	 * @param DictClass - Class of dictionary representation
+	 * @param BaseSnapshot - Terms and tables of this snapshot are kept in the new one, can be nullptr
+	 */
+	TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe> CreateSnapshot(const TSubclassOf<UDictionaryRepresentation> DictClass, const FDictionarySnapshot* BaseSnapshot);
+
+	/** Swaps current snapshot with the new one, old snapshot is kept until no query holds it */
+	void PublishSnapshot(const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe>& NewSnapshot);
+
+	/** Releases dictionary objects of retired snapshots, which are not held by any query, timer repeats it while some snapshot is held */
+	void ReleaseRetiredSnapshots();
+
+	/** Parses words of table and queues them for dictionary update */
+	void QueueTableUpdate(const UDataTable* InTable, const bool bIsRemoved);
+
+	/**
+	 * Starts update of all queued tables on worker thread, only one update runs at time
+	 * Worker copies the current snapshot and registers only words of changed tables, the copy and term weights are still O(dictionary size),
+	 * because every table changes the dividers of all weights, but nothing of it blocks the game thread
+	 * Representation without incremental update is rebuilt from all tables on the worker thread
+	 */
+	void StartDictionaryUpdate();
+
+	/**
+	 * Publishes snapshot updated on worker thread and starts next update
+	 * @param NewSnapshot - Snapshot with applied table updates
+	 * @param bWasUpdated - False, if dictionary doesn't support incremental update, then whole dictionary was rebuilt
+	 */
+	void FinishDictionaryUpdate(const TSharedRef<FDictionarySnapshot, ESPMode::ThreadSafe>& NewSnapshot, const bool bWasUpdated);
+
+	/** Helper function for keyword picker object construction */
+	void ConstructKeywordPickerObject(const TSubclassOf<UKeywordPickerFunction> KeywordPickerClass);
+
+	/** Helper function for dictionary word picker object construction */
+	void ConstructDictionaryWordPickerFunctionObject(const TSubclassOf<UDictionaryWordPickerFunction> StringFunctionClass);
+
+private:
+	/** Cached all dialog tables in game */
+	UPROPERTY()
+	TSet<UDataTable*> GameNaturalDialogTables;
+
+	/**
+	 * Strong refs for dictionary data of current snapshot and of retired snapshots, which are still used by some query
+	 * Dictionary data are parsed from game data tables
+	 */
+	UPROPERTY()
+	TArray<UDictionaryRepresentation*> SnapshotDictionaries;
+
+	/** Currently published snapshot, @see GetSnapshot() */
+	FDictionarySnapshotPtr CurrentSnapshot;
+
+	/** Replaced snapshots, they are released when no query holds them */
+	TArray<FDictionarySnapshotPtr> RetiredSnapshots;
+
+	/** Timer of ReleaseRetiredSnapshots(), active only while RetiredSnapshots is not empty */
+	FTimerHandle RetiredSnapshotsHandle;
+
+	/** Seconds between checks of retired snapshots */
+	static constexpr float RetiredSnapshotsCheckInterval = 1.f;
+
+	/** Guards only swap and copy of CurrentSnapshot pointer */
+	mutable FRWLock SnapshotLock;
+
+	/** Added or removed table with its parsed words */
+	struct FDictionaryTableUpdate
+	{
+		const UDataTable* Table;
+		TArray<FString> Words;
+		bool bIsRemoved;
+	};
+
+	/** Table updates waiting for the next dictionary update */
+	TArray<FDictionaryTableUpdate> PendingTableUpdates;
+
+	/** Worker task of dictionary update in progress */
+	TFuture<void> DictionaryUpdateTask;
+
+	/** Strong refs for tables read by worker task, when the dictionary is rebuilt */
+	UPROPERTY()
+	TArray<UDataTable*> UpdatedTables;
+
+	bool bIsDictionaryUpdating = false;
+
+	/** Cleared when representation fails to copy or remove words, then updates rebuild the whole dictionary */
+	bool bSupportsIncrementalUpdate = true;
+
+	/** Corrected word with approximate memory of its cache entry, so size of cache is counted without iteration */
+	struct FWordCorrection
+	{
+		FString Word;
+		int32 EntrySize;
+	};
+
+	/** Normalized input word to corrected word, empty string for unrecognized word */
+	mutable TLruCache<FString, FWordCorrection> WordCorrections;
+
+	/** Sum of entry sizes of all cached corrections, updated with every added and evicted entry */
+	mutable int64 WordCorrectionsSize;
+
+	/** Version of snapshot, which corrections are cached, corrections made with older snapshot are not added */
+	mutable uint32 WordCorrectionsVersion;
+
+	mutable int32 NumOfCorrectionHits;
+	mutable int32 NumOfCorrectionMisses;
+
+	/** Guards word correction cache and its counters */
+	mutable FCriticalSection WordCorrectionsLock;
+
+	/** Strong ref to word picker singleton function  */
+	UPROPERTY()
+	UDictionaryWordPickerFunction* DictionaryWordPickerFunctionInstance;
+
+	/** Strong ref to keyword picker singleton function  */
+	UPROPERTY()
+	UKeywordPickerFunction* KeywordPickerFunctionInstance;
+};
@@ -0,0 +1,55 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "Resources/Resources.h"
+#include "GenerateDialogReplyAsyncAction.generated.h"
+
+class UNpcNaturalDialogComponent;
+class UPlayerNaturalDialogComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialogReplyAsyncResult, const TArray<FNaturalDialogAnswer>&, Answers);
+
+/**
+ * Latent blueprint node for UPlayerNaturalDialogComponent::GenerateDialogReplyAsync()
+ * Reply is matched on worker thread, so the game thread is not blocked by long player input
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UGenerateDialogReplyAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Fired when reply for player input is generated */
+	UPROPERTY(BlueprintAssignable)
+	FOnDialogReplyAsyncResult OnCompleted;
+
+	/** Fired when request is superseded by another request of the same player component, or cancelled */
+	UPROPERTY(BlueprintAssignable)
+	FOnDialogReplyAsyncResult OnCancelled;
+
+	/**
+	* Generates reply on player dialog input without blocking of game thread
+	* @param PlayerNaturalDialogComponent - Component of player, which asks for the reply
+	* @param Input - Player text input (e.g. from UI input text block)
+	* @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
+	*/
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", DisplayName = "Generate Dialog Reply (Async)"), Category="Natural Dialog Component")
+	static UGenerateDialogReplyAsyncAction* GenerateDialogReplyAsync(UPlayerNaturalDialogComponent* PlayerNaturalDialogComponent, const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/** Starts reply request on player component */
+	virtual void Activate() override;
+
+private:
+	void HandleReplyGenerated(const TArray<FNaturalDialogAnswer>& Answers, bool bWasCancelled);
+
+	UPROPERTY()
+	UPlayerNaturalDialogComponent* PlayerNaturalDialogComponent;
+
+	UPROPERTY()
+	const UNpcNaturalDialogComponent* NpcNaturalDialogComponent;
+
+	FText Input;
+};
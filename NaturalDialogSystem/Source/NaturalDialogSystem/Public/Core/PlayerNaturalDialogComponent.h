@@ -1,264 +1,390 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Components/ActorComponent.h"
-#include "FunctionalClasses/ReplyHelperFunction.h"
-#include "Resources/Resources.h"
-#include "PlayerNaturalDialogComponent.generated.h"
-
-class UReplyHelperFunction;
-class UDictionarySubsystem;
-class UDialogReplyFunction;
-class UNaturalDialogTask;
-class UNpcNaturalDialogComponent;
-
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDataTableChanged, const UDataTable*, DataTable);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNpcStateChanged, const FDialogTaskNPCData&, NpcData);
-
-/**
- *
- */
-USTRUCT(BlueprintType)
-struct FDialogTableHierarchy
-{
-	GENERATED_BODY()
-
-	FDialogTableHierarchy()
-		: OwnerNpcNaturalDialogComponent(nullptr) {}
-
-	FDialogTableHierarchy(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
-
-	bool operator==(const FDialogTableHierarchy& Other) const { return OwnerNpcNaturalDialogComponent == Other.OwnerNpcNaturalDialogComponent; }
-	bool operator==(const UNpcNaturalDialogComponent* Other) const { return OwnerNpcNaturalDialogComponent == Other; };
-
-	/**
-	 * Actor that owns dialog tables from variable DialogTables
-	 */
-	UPROPERTY(BlueprintReadOnly)
-	const UNpcNaturalDialogComponent* OwnerNpcNaturalDialogComponent;
-
-	/**
-	 * Held tables of the actor, which contains NpcNaturalDialogComponent
-	 */
-	UPROPERTY(BlueprintReadOnly)
-	TArray<UDataTable*> DialogTables;
-};
-
-
-DECLARE_LOG_CATEGORY_EXTERN(LogPlayerNaturalDialogComponent, Log, All);
-
-/**
- * Player natural dialog component handle all replies asked from player to NPC
- * Is closely related to UNpcNaturalDialogComponent, where are store initial tables for player
- * When player talks to new NPC, all initial tables are copied to this component into DialogData, which are replicated over network
- * Component generate reply using function GenerateDialogReply() and spawn potential dialog task, which are associated with dialog reply
- * These tasks are replicates over network and are executed on client and server site
- */
-UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
-class NATURALDIALOGSYSTEM_API UPlayerNaturalDialogComponent : public UActorComponent
-{
-	GENERATED_BODY()
-
-	friend class UNaturalDialogTask;
-
-public:
-	UPlayerNaturalDialogComponent();
-
-protected:
-	/**
-	* Function used for reply for input from function GenerateDialogReply()
-	* Constructed on BeginPlay()
-	*/
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Natural Dialog Component")
-	TSubclassOf<UDialogReplyFunction> ReplyFunctionClass;
-
-	/**
-	* Function used for help player to ask  for replies
-	* Constructed on BeginPlay()
-	*/
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Natural Dialog Component")
-	TSubclassOf<UReplyHelperFunction> ReplyHelperFunctionClass;
-
-public:
-	/**
-	* Fired, when new dialog data table is added to component
-	* Fires all initial data tables, set in BP child details panel
-	* Fired on server and client side
-	*/
-	UPROPERTY(BlueprintAssignable)
-	FOnDataTableChanged OnDataTableAdded;
-
-	/**
-	* Fired, when existing dialog data table is removed from component
-	* Fired on server and client side
-	*/
-	UPROPERTY(BlueprintAssignable)
-	FOnDataTableChanged OnDataTableRemoved;
-
-	/**
-	 * Fired, when player interact with npc first time
-	 * Fired on server and client side with prediction
-	 */
-	UPROPERTY(BlueprintAssignable)
-	FOnNpcStateChanged OnNewNpcInteract;
-	
-protected:
-	/** Initialize component properties (DictSubsystem and ReplyFunctionInstance) */
-	virtual void BeginPlay() override;
-
-	/** Allows a component to replicate other sub-object on the actor  */
-	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
-
-	/** Replication props of component */
-	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
-
-	/** Constructs reply object instance */
-	virtual void CreateReplyObjectInstance(const TSubclassOf<UDialogReplyFunction> InReplyFunctionClass);
-
-public:
-	/**
-	 * Function registers all initial tables from given NpcNaturalDialogComponent
-	 * All tables are registered automatically when player ask for first reply
-	 * but tables are registered on server site and because of replication delay,
-	 * there is a chance to get invalid response, because data are not prepared yet on client site
-	 * We recommend to use this function before start asking a reply for component
-	 * No checks are needed for this
-	 * @param NpcNaturalDialogComponent - Initial data tables are taken from this NPC component
-	 */
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	void RegisterInitialTables(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
-
-	/**
-	* Main function for generating reply on player dialog input
-	* Used to generate dialog with the controller owner (NPC) and player
-	* @param Input - Player text input (e.g. from UI input text block)
-	* @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
-	* @return - NPC dialog responses to player, we can show it in UI
-	*/
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	TArray<FNaturalDialogAnswer> GenerateDialogReply(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
-
-	/**
-	 * Function helps player to ask question from NPC
-	 * Uses DialogHelperFunction to generate possible options with using of input
-	 * @param Input - Text, which player has already typed
-	 * @param NpcNaturalDialogComponent - Component which we are asking for
-	 * @param Options - Found options, which can be used
-	 * @return - True, if we have found any possible option
-	 */
-	UFUNCTION(BlueprintCallable, Category= "Natural Dialog Component")
-	bool FindBestAskOptions(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSet<FString>& Options) const;
-
-	/**
-	 * Function helps player to ask question from NPC
-	 * Uses DialogHelperFunction to generate possible option with using of input
-	 * @param Input - Text, which player has already typed
-	 * @param NpcNaturalDialogComponent - Component which we are asking for
-	 * @param Option - Found option, which can be used
-	 * @return - True, if we have found any possible option
-	 */
-	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Find Best Ask Option (Single)"), Category= "Natural Dialog Component")
-	bool FindBestAskOption(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FText& Option) const;
-
-	// UFUNCTION(BlueprintCallable, Category= "Natural Dialog Component")
-	// void CommitLastUsedOption(const FText&Option);
-
-	/**
-	* Register new data table asset for NPC
-	* Allowed only data tables with row FNaturalDialogRow
-	* We can do this if we need register more information during the game
-	* Function does server request and client data adjustment, @see Server_RegisterDialogData() function for more info
-	* e.g. when we complete som quest and we need to add new quest info to NPC
-	* @param NpcNaturalDialogComponent - Npc which we are registering dialog data for
-	* @param DialogTable - Data for NPC registration
-	*/
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	void RegisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-
-	/**
-	* Remove registered data for the owner NPC if exists
-	* The data could be used for completed quest, when we dont need them anymore
-	* @param NpcNaturalDialogComponent - Npc which we are unregistering dialog data for
-	* @param DialogTable - Data which we want to remove from owner NPC dialog data tables 
-	*/
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	void UnregisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-
-	/** Returns all available dialog tables for npc communication */
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	TSet<UDataTable*> GetDialogTables(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) const;
-
-	/** Returns True, if player has already registered dialog table */
-	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
-	bool HasDialogDataRegistered(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable) const;
-
-	/** Returns all available const dialog tables for npc communication */
-	TSet<const UDataTable*> GetDialogTables_Const(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) const;
-
-protected:
-	/**
-	 * We have to divided request for dialog table registration
-	 * When we asking for reply, UPlayerNaturalDialogComponent has not yet replicated DialogData, so it cannot reply dialog
-	 * Because of this, we have server function Server_RegisterDialogData(), which sends request for table registration
-	 * But with this registration, we add temp dialog data into the component
-	 */
-	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_RegisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-
-	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_UnregisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-
-	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_ExecuteDialogTask(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSubclassOf<UNaturalDialogTask> Task);
-
-	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_FinishDialogTaskExecution(UNaturalDialogTask* Task);
-
-	UFUNCTION()
-	void OnRep_ActiveExecutionTasks();
-
-private:
-	void RegisterDialogTable_Internal(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-	void UnregisterDialogTable_Internal(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
-	APlayerController* GetOwnerPlayerController() const;
-	bool HasValidDialogTask(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSoftClassPtr<UNaturalDialogTask> Task) const;
-
-	/**
-	 * Cached dialog data for dialog replies
-	 * When player interact with UNpcNaturalDialogComponent, all initial tables are cached into this component
-	 * We can add or remove dialog tables data using server functions Server_RegisterDialogData and Server_RemoveRegisteredDialogData
-	 * Struct holds reference to the owner of the component and its tables
-	 */
-	UPROPERTY(Replicated)
-	TArray<FDialogTableHierarchy> DialogData;
-
-	/**
-	* All active tasks, executed by interaction with cached dialog tables
-	* After server replication to client, we execute these tasks on the owner client too in replication function OnRep_ActiveExecutionTasks
-	*/
-	UPROPERTY(ReplicatedUsing="OnRep_ActiveExecutionTasks")
-	TArray<UNaturalDialogTask*> ActiveExecutionTasks;
-
-	/**
-	* Cached dictionary subsystem
-	* Strong ref is in game instance
-	* Is set in BeginPlay() function
-	*/
-	TWeakObjectPtr<UDictionarySubsystem> DictSubsystem;
-
-	/**
-	* Cached reply function instance
-	* Created in BeginPlay() function
-	*/
-	UPROPERTY()
-	UDialogReplyFunction* ReplyFunctionInstance;
-
-	/**
-	 * Cached helper reply function instance
-	 * Created in BeginPlay() function
-	 */
-	UPROPERTY()
-	UReplyHelperFunction* DialogHelperFunction;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Components/ActorComponent.h"
+#include "HAL/ThreadSafeBool.h"
+#include "FunctionalClasses/ReplyHelperFunction.h"
+#include "Resources/Resources.h"
+#include "PlayerNaturalDialogComponent.generated.h"
+
+class FDialogReplyMatcher;
+class UReplyHelperFunction;
+class UDictionarySubsystem;
+class UDialogReplyFunction;
+class UNaturalDialogTask;
+class UNpcNaturalDialogComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDataTableChanged, const UDataTable*, DataTable);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNpcStateChanged, const FDialogTaskNPCData&, NpcData);
+DECLARE_DELEGATE_TwoParams(FOnDialogReplyGenerated, const TArray<FNaturalDialogAnswer>& /*Answers*/, bool /*bWasCancelled*/);
+
+/**
+ *
+ */
+USTRUCT(BlueprintType)
+struct FDialogTableHierarchy
+{
+	GENERATED_BODY()
+
+	FDialogTableHierarchy()
+		: OwnerNpcNaturalDialogComponent(nullptr) {}
+
+	FDialogTableHierarchy(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	bool operator==(const FDialogTableHierarchy& Other) const { return OwnerNpcNaturalDialogComponent == Other.OwnerNpcNaturalDialogComponent; }
+	bool operator==(const UNpcNaturalDialogComponent* Other) const { return OwnerNpcNaturalDialogComponent == Other; };
+
+	/**
+	 * Actor that owns dialog tables from variable DialogTables
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	const UNpcNaturalDialogComponent* OwnerNpcNaturalDialogComponent;
+
+	/**
+	 * Held tables of the actor, which contains NpcNaturalDialogComponent
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	TArray<UDataTable*> DialogTables;
+};
+
+/**
+ * Pending asynchronous reply request of player component, @see UPlayerNaturalDialogComponent::GenerateDialogReplyAsync()
+ */
+struct FDialogReplyRequest
+{
+	FDialogReplyRequest()
+		: RequestId(INDEX_NONE), ReplyStateHash(0) {}
+
+	FDialogReplyRequest(const int32 InRequestId, const UNpcNaturalDialogComponent* InNpcNaturalDialogComponent, const FOnDialogReplyGenerated& InOnReplyGenerated, const uint32 InReplyStateHash)
+		: RequestId(InRequestId), NpcNaturalDialogComponent(InNpcNaturalDialogComponent), OnReplyGenerated(InOnReplyGenerated), CancelFlag(MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false)), ReplyStateHash(InReplyStateHash) {}
+
+	bool IsValid() const { return RequestId != INDEX_NONE; }
+
+	/** Unique id of request, results of superseded requests are dropped */
+	int32 RequestId;
+
+	/** Npc which we asking for the reply */
+	TWeakObjectPtr<const UNpcNaturalDialogComponent> NpcNaturalDialogComponent;
+
+	/** Fired on game thread, when reply is generated or request is cancelled */
+	FOnDialogReplyGenerated OnReplyGenerated;
+
+	/** Shared with worker thread, so it can stop matching of remaining sentences */
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+
+	/** Dictionary snapshot and npc tables, which were matched on worker thread, @see UPlayerNaturalDialogComponent::ComputeReplyStateHash() */
+	uint32 ReplyStateHash;
+};
+
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPlayerNaturalDialogComponent, Log, All);
+
+/**
+ * Player natural dialog component handle all replies asked from player to NPC
+ * Is closely related to UNpcNaturalDialogComponent, where are store initial tables for player
+ * When player talks to new NPC, all initial tables are copied to this component into DialogData, which are replicated over network
+ * Component generate reply using function GenerateDialogReply() and spawn potential dialog task, which are associated with dialog reply
+ * These tasks are replicates over network and are executed on client and server site
+ */
+UCLASS(Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class NATURALDIALOGSYSTEM_API UPlayerNaturalDialogComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	friend class UNaturalDialogTask;
+	friend class UDialogReplyBatchSubsystem;
+
+public:
+	UPlayerNaturalDialogComponent();
+
+protected:
+	/**
+	* Function used for reply for input from function GenerateDialogReply()
+	* Constructed on BeginPlay()
+	*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Natural Dialog Component")
+	TSubclassOf<UDialogReplyFunction> ReplyFunctionClass;
+
+	/**
+	* Function used for help player to ask  for replies
+	* Constructed on BeginPlay()
+	*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Natural Dialog Component")
+	TSubclassOf<UReplyHelperFunction> ReplyHelperFunctionClass;
+
+	/**
+	* Sentences of player input are matched in parallel on worker threads
+	* Replies are still resolved and applied in sentence order, so the result is the same as for serial generation
+	* Used only when reply function supports reply matcher, @see UDialogReplyFunction::CreateReplyMatcher()
+	*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Natural Dialog Component")
+	bool bParallelSentenceMatching;
+
+	/** Min count of sentences in player input, when sentences are matched in parallel */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (EditCondition = "bParallelSentenceMatching", ClampMin = 2), Category="Natural Dialog Component")
+	int32 MinParallelSentences;
+
+public:
+	/**
+	* Fired, when new dialog data table is added to component
+	* Fires all initial data tables, set in BP child details panel
+	* Fired on server and client side
+	*/
+	UPROPERTY(BlueprintAssignable)
+	FOnDataTableChanged OnDataTableAdded;
+
+	/**
+	* Fired, when existing dialog data table is removed from component
+	* Fired on server and client side
+	*/
+	UPROPERTY(BlueprintAssignable)
+	FOnDataTableChanged OnDataTableRemoved;
+
+	/**
+	 * Fired, when player interact with npc first time
+	 * Fired on server and client side with prediction
+	 */
+	UPROPERTY(BlueprintAssignable)
+	FOnNpcStateChanged OnNewNpcInteract;
+	
+protected:
+	/** Initialize component properties (DictSubsystem and ReplyFunctionInstance) */
+	virtual void BeginPlay() override;
+
+	/** Cancels pending reply request and waits for its worker task */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Allows a component to replicate other sub-object on the actor  */
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	/** Replication props of component */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Constructs reply object instance */
+	virtual void CreateReplyObjectInstance(const TSubclassOf<UDialogReplyFunction> InReplyFunctionClass);
+
+public:
+	/**
+	 * Function registers all initial tables from given NpcNaturalDialogComponent
+	 * All tables are registered automatically when player ask for first reply
+	 * but tables are registered on server site and because of replication delay,
+	 * there is a chance to get invalid response, because data are not prepared yet on client site
+	 * We recommend to use this function before start asking a reply for component
+	 * No checks are needed for this
+	 * @param NpcNaturalDialogComponent - Initial data tables are taken from this NPC component
+	 */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	void RegisterInitialTables(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/**
+	* Main function for generating reply on player dialog input
+	* Used to generate dialog with the controller owner (NPC) and player
+	* @param Input - Player text input (e.g. from UI input text block)
+	* @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
+	* @return - NPC dialog responses to player, we can show it in UI
+	*/
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	TArray<FNaturalDialogAnswer> GenerateDialogReply(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/**
+	* Asynchronous variant of GenerateDialogReply()
+	* Keyword generation and reply matching run on worker thread, metric values, dialog tasks and dialog table actions are applied on game thread
+	* Only one request can be pending, new request cancels the previous one
+	* If reply function doesn't support asynchronous matching, reply is generated synchronously and delegate is fired immediately
+	* @param Input - Player text input (e.g. from UI input text block)
+	* @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
+	* @param OnReplyGenerated - Fired on game thread with NPC dialog responses, or with empty array when request is cancelled
+	* @return - Id of request, or INDEX_NONE if reply was generated synchronously
+	*/
+	int32 GenerateDialogReplyAsync(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const FOnDialogReplyGenerated& OnReplyGenerated);
+
+	/**
+	* Enqueues reply request into UDialogReplyBatchSubsystem, where requests of all players are resolved together
+	* Intended for dedicated servers, where many players ask for replies in the same frame
+	* @param Input - Player text input
+	* @param NpcNaturalDialogComponent - Defines component of npc which we asking for the reply
+	* @param OnReplyGenerated - Fired on game thread with NPC dialog responses
+	*/
+	void GenerateDialogReplyBatched(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const FOnDialogReplyGenerated& OnReplyGenerated);
+
+	/** Cancels pending asynchronous reply request, its delegate is fired as cancelled */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	void CancelDialogReply();
+
+	/**
+	 * Function helps player to ask question from NPC
+	 * Uses DialogHelperFunction to generate possible options with using of input
+	 * @param Input - Text, which player has already typed
+	 * @param NpcNaturalDialogComponent - Component which we are asking for
+	 * @param Options - Found options, which can be used
+	 * @return - True, if we have found any possible option
+	 */
+	UFUNCTION(BlueprintCallable, Category= "Natural Dialog Component")
+	bool FindBestAskOptions(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSet<FString>& Options) const;
+
+	/**
+	 * Function helps player to ask question from NPC
+	 * Uses DialogHelperFunction to generate possible option with using of input
+	 * @param Input - Text, which player has already typed
+	 * @param NpcNaturalDialogComponent - Component which we are asking for
+	 * @param Option - Found option, which can be used
+	 * @return - True, if we have found any possible option
+	 */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Find Best Ask Option (Single)"), Category= "Natural Dialog Component")
+	bool FindBestAskOption(const FText& Input, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FText& Option) const;
+
+	// UFUNCTION(BlueprintCallable, Category= "Natural Dialog Component")
+	// void CommitLastUsedOption(const FText&Option);
+
+	/**
+	* Register new data table asset for NPC
+	* Allowed only data tables with row FNaturalDialogRow
+	* We can do this if we need register more information during the game
+	* Function does server request and client data adjustment, @see Server_RegisterDialogData() function for more info
+	* e.g. when we complete som quest and we need to add new quest info to NPC
+	* @param NpcNaturalDialogComponent - Npc which we are registering dialog data for
+	* @param DialogTable - Data for NPC registration
+	*/
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	void RegisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+
+	/**
+	* Remove registered data for the owner NPC if exists
+	* The data could be used for completed quest, when we dont need them anymore
+	* @param NpcNaturalDialogComponent - Npc which we are unregistering dialog data for
+	* @param DialogTable - Data which we want to remove from owner NPC dialog data tables 
+	*/
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	void UnregisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+
+	/** Returns all available dialog tables for npc communication */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	TSet<UDataTable*> GetDialogTables(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) const;
+
+	/** Returns True, if player has already registered dialog table */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog Component")
+	bool HasDialogDataRegistered(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable) const;
+
+	/** Returns all available const dialog tables for npc communication */
+	TSet<const UDataTable*> GetDialogTables_Const(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) const;
+
+protected:
+	/**
+	 * We have to divided request for dialog table registration
+	 * When we asking for reply, UPlayerNaturalDialogComponent has not yet replicated DialogData, so it cannot reply dialog
+	 * Because of this, we have server function Server_RegisterDialogData(), which sends request for table registration
+	 * But with this registration, we add temp dialog data into the component
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_RegisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_UnregisterDialogData(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_ExecuteDialogTask(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSubclassOf<UNaturalDialogTask> Task);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_FinishDialogTaskExecution(UNaturalDialogTask* Task);
+
+	UFUNCTION()
+	void OnRep_ActiveExecutionTasks();
+
+private:
+	void RegisterDialogTable_Internal(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+	void UnregisterDialogTable_Internal(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, UDataTable* DialogTable);
+	APlayerController* GetOwnerPlayerController() const;
+	bool HasValidDialogTask(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TSoftClassPtr<UNaturalDialogTask> Task) const;
+
+	/**
+	 * Adds answer of reply result into Result array and fires dialog tasks and dialog table actions of the answer row
+	 * @return - True, if any dialog table was registered or unregistered by the answer
+	 */
+	bool ApplyDialogReplyResult(const bool bWasReplyFound, const FNaturalDialogResult& AnswerResult, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TArray<FNaturalDialogAnswer>& Result);
+
+	/**
+	 * Validates component and reply function and registers initial tables of npc
+	 * @return - False, if reply can't be generated, then default reply is used
+	 */
+	bool PrepareReplyGeneration(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/** Resolves reply candidates of all sentences, default reply is used when no answer is found */
+	TArray<FNaturalDialogAnswer> ResolveDialogReply(const TArray<FString>& Sentences, const TArray<TArray<FReplyData>>& SentenceCandidates, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/**
+	 * Computes hash of dictionary snapshot version and dialog tables of npc, reply candidates are valid only for the same state
+	 * @param NpcNaturalDialogComponent - Npc which we asking for the reply
+	 */
+	uint32 ComputeReplyStateHash(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) const;
+
+	/** Resolves reply candidates of asynchronous request on game thread, candidates matched with changed tables or dictionary are generated again */
+	void FinishDialogReplyRequest(const int32 RequestId, const TArray<FString>& Sentences, const TArray<TArray<FReplyData>>& SentenceCandidates);
+
+	/**
+	 * Resolves and applies replies in sentence order, sentences without candidates are generated by GenerateReply()
+	 * When answer changes dialog tables, next sentences are generated again, because their candidates were matched with old tables
+	 */
+	void ResolveSentenceReplies(const TArray<FString>& Sentences, const TArray<TArray<FReplyData>>& SentenceCandidates, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, TArray<FNaturalDialogAnswer>& Result);
+
+	/** Returns true, if sentences of input should be matched in parallel */
+	bool ShouldMatchSentencesInParallel(const int32 NumOfSentences) const;
+
+	/**
+	 * Finds reply candidates of all sentences, every sentence is matched independently
+	 * @param Matcher - Thread-safe matcher of reply function
+	 * @param Sentences - Sentences of player input
+	 * @param bParallel - Sentences are matched on worker threads
+	 * @param CancelFlag - Remaining sentences are skipped, when flag is set, can be nullptr
+	 * @return - Candidates in sentence order
+	 */
+	static TArray<TArray<FReplyData>> MatchSentences(const FDialogReplyMatcher& Matcher, const TArray<FString>& Sentences, const bool bParallel, const FThreadSafeBool* CancelFlag);
+
+	/**
+	 * Cached dialog data for dialog replies
+	 * When player interact with UNpcNaturalDialogComponent, all initial tables are cached into this component
+	 * We can add or remove dialog tables data using server functions Server_RegisterDialogData and Server_RemoveRegisteredDialogData
+	 * Struct holds reference to the owner of the component and its tables
+	 */
+	UPROPERTY(Replicated)
+	TArray<FDialogTableHierarchy> DialogData;
+
+	/**
+	* All active tasks, executed by interaction with cached dialog tables
+	* After server replication to client, we execute these tasks on the owner client too in replication function OnRep_ActiveExecutionTasks
+	*/
+	UPROPERTY(ReplicatedUsing="OnRep_ActiveExecutionTasks")
+	TArray<UNaturalDialogTask*> ActiveExecutionTasks;
+
+	/**
+	* Cached dictionary subsystem
+	* Strong ref is in game instance
+	* Is set in BeginPlay() function
+	*/
+	TWeakObjectPtr<UDictionarySubsystem> DictSubsystem;
+
+	/**
+	* Cached reply function instance
+	* Created in BeginPlay() function
+	*/
+	UPROPERTY()
+	UDialogReplyFunction* ReplyFunctionInstance;
+
+	/**
+	 * Cached helper reply function instance
+	 * Created in BeginPlay() function
+	 */
+	UPROPERTY()
+	UReplyHelperFunction* DialogHelperFunction;
+
+	/** Currently pending asynchronous reply request */
+	FDialogReplyRequest ActiveReplyRequest;
+
+	/** Id of last asynchronous reply request */
+	int32 LastReplyRequestId;
+
+	/** Worker tasks of asynchronous reply requests, we have to wait for them before component is destroyed */
+	TArray<TFuture<void>> PendingReplyTasks;
+};
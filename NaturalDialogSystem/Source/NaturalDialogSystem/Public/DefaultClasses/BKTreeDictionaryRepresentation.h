@@ -0,0 +1,75 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DefaultClasses/DefaultDictionaryRepresentation.h"
+#include "BKTreeDictionaryRepresentation.generated.h"
+
+/**
+ * Node of BK-tree, children are stored as linked list in flat nodes array
+ */
+struct FBKTreeNode
+{
+	FBKTreeNode()
+		: ParentDistance(0), FirstChild(INDEX_NONE), NextSibling(INDEX_NONE), bIsRemoved(false) {}
+
+	FBKTreeNode(const FString& InWord, const int32 InParentDistance)
+		: Word(InWord), ParentDistance(InParentDistance), FirstChild(INDEX_NONE), NextSibling(INDEX_NONE), bIsRemoved(false) {}
+
+	/** Dictionary word of the node */
+	FString Word;
+
+	/** Levenshtein distance to parent node word */
+	int32 ParentDistance;
+
+	/** Index of first child node, INDEX_NONE if node is leaf */
+	int32 FirstChild;
+
+	/** Index of next node with the same parent */
+	int32 NextSibling;
+
+	/** Word was removed from dictionary, node is kept, because its subtree depends on it */
+	bool bIsRemoved;
+
+	friend FArchive& operator<<(FArchive& Ar, FBKTreeNode& Node)
+	{
+		return Ar << Node.Word << Node.ParentDistance << Node.FirstChild << Node.NextSibling << Node.bIsRemoved;
+	}
+};
+
+/**
+ * Dictionary representation with BK-tree index built during words registration
+ * Word picker asks the tree for the nearest word, so only a small part of vocabulary is compared with input
+ * Tree uses Levenshtein distance, because lookup pruning requires metric with triangle inequality
+ * Words data are stored in the same buckets as in UDefaultDictionaryRepresentation
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UBKTreeDictionaryRepresentation : public UDefaultDictionaryRepresentation
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeDictionary() override;
+	virtual void RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool CopyDictionary(const UDictionaryRepresentation* Other) override;
+
+	virtual bool SupportsNearestWordLookup() const override { return true; }
+	virtual bool FindNearestWord(const FString& Word, const int32 MaxDistance, FString& OutWord, int32& OutDistance) const override;
+
+	virtual bool SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const override;
+	virtual bool LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+private:
+	/** Inserts new unique word into tree, removed node of the word is restored */
+	void InsertNode(const FString& Word);
+
+	/** Returns index of node with the word, or INDEX_NONE */
+	int32 FindNode(const FString& Word) const;
+
+private:
+	/** All tree nodes, root is at index 0 */
+	TArray<FBKTreeNode> Nodes;
+};
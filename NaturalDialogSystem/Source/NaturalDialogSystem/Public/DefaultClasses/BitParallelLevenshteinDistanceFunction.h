@@ -0,0 +1,34 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FunctionalClasses/StringDistanceFunction.h"
+#include "BitParallelLevenshteinDistanceFunction.generated.h"
+
+/**
+ * Levenshtein distance computed by Myers/Hyyro bit-parallel algorithm
+ * One column of DP matrix is processed as bit vectors, so strings up to 64 characters cost only a few instructions per character
+ * Longer strings are processed in blocks of 64 characters, all computation is done on stack without heap allocation
+ * Returns the same distances as ULevenshteinDistanceFunction
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UBitParallelLevenshteinDistanceFunction : public UStringDistanceFunction
+{
+	GENERATED_BODY()
+
+public:
+	virtual uint32 GetStringDistance(const FString& InputA, const FString& InputB) const override;
+	virtual uint32 GetStringDistanceBounded(const FString& InputA, const FString& InputB, const uint32 MaxDistance) const override;
+	virtual uint32 GetStringViewDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance) const override;
+	virtual bool IsEditDistance() const override { return true; }
+
+	/**
+	 * Computes Levenshtein distance of two strings
+	 * @param InputA - First string to measure with second param
+	 * @param InputB - Second string to measure with first param
+	 * @param MaxDistance - Computation stops once the distance exceeds this value
+	 * @return - Exact distance, if it is not greater than MaxDistance, otherwise MaxDistance + 1
+	 */
+	static uint32 ComputeDistance(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance = MAX_uint32);
+};
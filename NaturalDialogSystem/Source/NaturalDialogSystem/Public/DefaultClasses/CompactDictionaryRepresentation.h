@@ -0,0 +1,111 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "CompactDictionaryRepresentation.generated.h"
+
+/**
+ * Word of compact dictionary, characters of word are stored in string pool of dictionary
+ */
+struct FCompactDictionaryWord
+{
+	FCompactDictionaryWord()
+		: Offset(0), Len(0), TermId(INVALID_TERM_ID), DataIndex(INDEX_NONE) {}
+
+	FCompactDictionaryWord(const int32 InOffset, const int32 InLen, const uint32 InTermId, const int32 InDataIndex)
+		: Offset(InOffset), Len(InLen), TermId(InTermId), DataIndex(InDataIndex) {}
+
+	/** Index of the first character of word in string pool */
+	int32 Offset;
+
+	/** Num of characters of word */
+	int32 Len;
+
+	/** Id of word in subsystem term table, INVALID_TERM_ID if word was registered without id */
+	uint32 TermId;
+
+	/** Index of occurence data of word */
+	int32 DataIndex;
+};
+
+/**
+ * Dictionary representation with flat memory layout
+ * Characters of all words are stored in one string pool, bucket of words with the same len is sorted array of words in pool
+ * Occurence data are stored in separate array, so scan of bucket in word picker touches only words
+ * Words registered after the last FinalizeDictionary() are appended at the end of bucket, they are sorted before snapshot is published
+ * Uses less memory than UDefaultDictionaryRepresentation, words are found by binary search instead of hashing
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UCompactDictionaryRepresentation : public UDictionaryRepresentation
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeDictionary() override;
+	virtual void RegisterWord(const FString& Word, const UDataTable* FromDataTable) override;
+	virtual void RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool CopyDictionary(const UDictionaryRepresentation* Other) override;
+	virtual void FinalizeDictionary() override;
+
+	virtual TArray<FString> GetListOfWords() const override;
+	virtual TArray<FString> GetListOfWordsOfLen(const int32 WordLen) const override;
+	virtual void ForEachWordOfLen(const int32 WordLen, TFunctionRef<bool(const FStringView& Word)> Visitor) const override;
+
+	/** Signatures of bucket are filtered in blocks of 64 words by branchless pass, only candidates of block are visited */
+	virtual void ForEachCandidateOfLen(const int32 WordLen, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const override;
+	virtual int32 GetNumOfWordsOfLen(const int32 WordLen) const override;
+	virtual void ForEachCandidateInRange(const int32 WordLen, const int32 FirstWord, const int32 NumOfWords, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const override;
+	virtual const FDictionaryData* GetWordData(const FString& Word) const override;
+	virtual const FDictionaryData* GetTermData(const uint32 TermId) const override;
+	virtual bool SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const override;
+	virtual bool LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+	/** Returns characters of word in string pool */
+	FORCEINLINE FStringView GetWordView(const FCompactDictionaryWord& Word) const { return FStringView(StringPool.GetData() + Word.Offset, Word.Len); }
+
+protected:
+	/**
+	 * Finds word in bucket of its len
+	 * @return - Index of word in bucket, or INDEX_NONE
+	 */
+	int32 FindWord(const FStringView& Word) const;
+
+	/** Sets index of word data for term id, @see TermWords */
+	void MapTermToWord(const uint32 TermId, const int32 DataIndex);
+
+	/** Appends new word into string pool and bucket of its len, returns index of its data */
+	int32 AddWord(const FStringView& Word, const uint32 TermId);
+
+	/** Copies characters and data of words in buckets into new string pool and data array, so space of removed words is released */
+	void CompactWords();
+
+protected:
+	/** Characters of all registered words, characters of removed words stay here until CompactWords() */
+	TArray<TCHAR> StringPool;
+
+	/** Buckets of words with the same len, in first bucket are words with len == 1, at second with len == 2, ... */
+	TArray<TArray<FCompactDictionaryWord>> Buckets;
+
+	/** Letter masks of words in the same order as words in buckets, @see FDictionaryWordSignature */
+	TArray<TArray<uint64>> LetterMasks;
+
+	/** Num of words at the beginning of every bucket, which are sorted */
+	TArray<int32> NumOfSortedWords;
+
+	/** Occurence data of all registered words, data of removed words stay here until CompactWords() */
+	TArray<FDictionaryData> WordsData;
+
+	/** Index to WordsData for every interned term id, INDEX_NONE if term is not in dictionary */
+	TArray<int32> TermWords;
+
+	/** Num of removed words, which characters and data are still in StringPool and WordsData */
+	int32 NumOfRemovedWords;
+
+	/** Num of characters of removed words in StringPool */
+	int32 NumOfRemovedChars;
+};
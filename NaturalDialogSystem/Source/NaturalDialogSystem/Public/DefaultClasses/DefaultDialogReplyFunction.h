@@ -1,115 +1,362 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-#include "Core/DictionarySubsystem.h"
-#include "FunctionalClasses/DialogReplyFunction.h"
-#include "FunctionalClasses/StringDistanceFunction.h"
-#include "Resources/Resources.h"
-#include "DefaultDialogReplyFunction.generated.h"
-
-class UPlayerNaturalDialogComponent;
-class UNpcNaturalDialogComponent;
-
-
-DECLARE_LOG_CATEGORY_EXTERN(Log_DefaultDialogReplyFunction, Log, All);
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API UDefaultDialogReplyFunction : public UDialogReplyFunction
-{
-	GENERATED_BODY()
-
-public:
-	UDefaultDialogReplyFunction();
-	
-protected:
-	/**
-	 * Defines interval of calling function HandleMatrixWeariness()
-	 * If interval is 1, then every second will metric weariness value is increased
-	 * Weariness value is not increased for every answer in data tables (it's random)
-	 */
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Properties")
-	float MetricInterval;
-	
-	/**
-	* Curve is used for calculate metric values for reply function
-	* Time (horizontal) value tels current metric value and vertical the new target value
-	* If is not set, then is used basic algorithm to calculate new metric value
-	*/
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Properties")
-	UCurveFloat* MetricCurve;
-
-	UPROPERTY()
-	TSubclassOf<UStringDistanceFunction> StringDistanceFunctionClass;
-	
-	/**
-	* All invalid responses, when NPC doesnt recognize the answer
-	* If not set, is used default reply text, without answer wave
-	*/
-	UPROPERTY(EditDefaultsOnly, meta=(RequiredAssetDataTags = "RowStructure=NaturalDialogRow_Base"), Category="Natural Dialog Component")
-	UDataTable* DefaultResponses;
-
-public:
-	virtual void InitializeDialogReplyPicker() override;
-	virtual bool GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer) override;
-
-	virtual TSet<const UDataTable*> FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<FString>& Keywords) const;
-
-protected:
-	/** Handle case when input table is registered as new data table in owner component */
-	UFUNCTION()
-	void HandleNewTableRegistration(const UDataTable* NewTable);
-
-	/** Handle case when input table is removed from owner component */
-	UFUNCTION()
-	void HandleRegisteredTableRemoved(const UDataTable* NewTable);
-
-	UFUNCTION()
-	void HandleMatrixWeariness();
-	
-private:
-	FReplyData FindBestReply(const TArray<FReplyData>& AllReplies) const;
-	void ModifyMetricValue(const UDataTable* InTable, const FName InRow, const int32 AnswerIndex);
-	void LogMetricValues();
-	
-	// template<typename T>
-	// static TArray<TSet<T*>> FindCombination(const TSet<T*>& InArray, const int32 CombinationSize);
-	
-	TArray<TSet<const UDataTable*>> CombinationUtil(const TArray<FString>& InArray, TArray<FString> Data, const int32 Start, const int32 End, const int32 Index, const int32 CombinationSize) const;
-
-private:
-	/**
-	 * Initialized in function InitializeDialogReplyPicker()
-	 * Strong ref in game instance
-	 */
-	TWeakObjectPtr<UDictionarySubsystem> DictionarySubsystem;
-
-	/**
-	 * Initialized in function InitializeDialogReplyPicker()
-	 * Strong ref in game instance
-	 */
-	UPROPERTY()
-	UStringDistanceFunction* StringDistanceFunction;
-	
-	/**
-	 * Initialized in function InitializeDialogReplyPicker()
-	 * Strong ref is in UDictionarySubsystem
-	 */
-	TWeakObjectPtr<const UDictionaryRepresentation> DictionaryRepresentation;
-
-	TWeakObjectPtr<UPlayerNaturalDialogComponent> OwnerComponent;
-
-	/**
-	 * Metric is used to compute variations for NPC reply
-	 * Every data table and row is stored metric value which is decreased when the answer of the row is used
-	 * When we find correct reply of two answers, we use the one with greatest metric value
-	 */
-	FDialogMetric Metric;
-	
-	FTimerHandle MatrixWearinessHandler;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Containers/LruCache.h"
+#include "Core/DictionarySubsystem.h"
+#include "FunctionalClasses/DialogReplyFunction.h"
+#include "FunctionalClasses/StringDistanceFunction.h"
+#include "Resources/Resources.h"
+#include "DefaultDialogReplyFunction.generated.h"
+
+class UPlayerNaturalDialogComponent;
+class UNpcNaturalDialogComponent;
+
+
+DECLARE_LOG_CATEGORY_EXTERN(Log_DefaultDialogReplyFunction, Log, All);
+
+/**
+ * Keyword data of one table row, prepared for reply generation
+ */
+struct FKeywordIndexRow
+{
+	FKeywordIndexRow()
+		: NumOfAnswers(0), MinKeywordsMatch(0) {}
+
+	FName RowName;
+	int32 NumOfAnswers;
+	int32 MinKeywordsMatch;
+
+	/** Indexes to FTableKeywordIndex::Keywords, in the same order as keywords in row */
+	TArray<int32> Keywords;
+};
+
+/**
+ * Inverted index of table keywords, built once when table is registered
+ * Reply generation compares input keywords only with distinct normalized keywords of table
+ * and then touches only rows, which share at least one keyword with input
+ */
+struct FTableKeywordIndex
+{
+	/**
+	 * Builds index from rows of keyword table
+	 * @param InTable - Keyword table
+	 * @param TermTable - Term table of dictionary, keywords are interned by it
+	 */
+	void Build(const UDataTable* InTable, const FDictionaryTermTable* TermTable);
+
+	/**
+	 * Finds term ids of keywords, which were not in dictionary when index was built
+	 * Term ids are never changed in later snapshots, so only INVALID_TERM_ID are searched again
+	 * @param TermTable - Term table of the new dictionary snapshot
+	 * @return - Copy of index with the new term ids, or nullptr if no keyword was added into dictionary
+	 */
+	TSharedPtr<FTableKeywordIndex, ESPMode::ThreadSafe> ResolveNewTerms(const FDictionaryTermTable& TermTable) const;
+
+	/** Distinct normalized keywords of table */
+	TArray<FString> Keywords;
+
+	/** Term ids of Keywords, INVALID_TERM_ID if keyword is not in dictionary */
+	TArray<uint32> KeywordTerms;
+
+	/** Rows (indexes to Rows), where is the keyword used, in table order */
+	TArray<TArray<int32>> KeywordRows;
+
+	/** All rows of table in table order */
+	TArray<FKeywordIndexRow> Rows;
+};
+
+/**
+ * Statistics of reply candidate cache, @see FReplyCandidateCache
+ */
+USTRUCT(BlueprintType)
+struct FReplyCacheStats
+{
+	GENERATED_BODY()
+
+	FReplyCacheStats()
+		: NumOfHits(0), NumOfMisses(0), NumOfEntries(0) {}
+
+	/** Count of sentences, which candidates were found in cache */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfHits;
+
+	/** Count of sentences, which had to be matched */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfMisses;
+
+	/** Count of cached sentences */
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumOfEntries;
+};
+
+/**
+ * LRU cache of reply candidates, key is normalized term sequence of sentence and table set of NPC
+ * Candidates are stored before FindBestReply(), so the reply is still selected by current metric values
+ * Cache is shared with matchers, so it can be used from worker threads
+ */
+class NATURALDIALOGSYSTEM_API FReplyCandidateCache
+{
+public:
+	explicit FReplyCandidateCache(const int32 InCapacity)
+		: Entries(FMath::Max(InCapacity, 1)), Generation(0), NumOfHits(0), NumOfMisses(0) {}
+
+	/**
+	 * Makes key of sentence for table set
+	 * @param Sentence - Sentence from player input
+	 * @param NpcTables - Tables available for NPC, in the order of matching
+	 */
+	static FString MakeKey(const FString& Sentence, const TArray<const UDataTable*>& NpcTables);
+
+	/**
+	 * Finds cached candidates and marks them as the most recent
+	 * @param Key - Key made by MakeKey()
+	 * @param NpcTables - Tables of key, compared with tables of entry, because key contains only hash of table set
+	 * @param OutCandidates - Cached candidates
+	 * @return - True if candidates were found
+	 */
+	bool Find(const FString& Key, const TArray<const UDataTable*>& NpcTables, TArray<FReplyData>& OutCandidates);
+
+	/**
+	 * Adds matched candidates, candidates are ignored if cache was invalidated after InGeneration
+	 * @param InGeneration - Generation of cache, when matching started, @see GetGeneration()
+	 */
+	void Add(const FString& Key, const TArray<const UDataTable*>& NpcTables, const TArray<FReplyData>& Candidates, const uint32 InGeneration);
+
+	/** Removes all entries matched with the table */
+	void InvalidateTable(const UDataTable* InTable);
+
+	/** Removes all entries, e.g. when dictionary is changed */
+	void InvalidateAll();
+
+	uint32 GetGeneration() const;
+	FReplyCacheStats GetStats() const;
+
+private:
+	struct FEntry
+	{
+		TArray<const UDataTable*> NpcTables;
+		TArray<FReplyData> Candidates;
+	};
+
+	mutable FCriticalSection CacheLock;
+	TLruCache<FString, FEntry> Entries;
+
+	/** Increased by every invalidation, so matching started before it can't add outdated candidates */
+	uint32 Generation;
+
+	int32 NumOfHits;
+	int32 NumOfMisses;
+};
+
+/**
+ * Read only data for matching of reply candidates, prepared on game thread
+ * Matching doesn't touch state of reply function, so it can run on worker thread
+ */
+struct FReplyMatchingContext
+{
+	FReplyMatchingContext()
+		: DictionarySubsystem(nullptr), StringDistanceFunction(nullptr), OwnerComponent(nullptr), ReplyCacheGeneration(0) {}
+
+	/** Used for keywords generation of sentence */
+	UDictionarySubsystem* DictionarySubsystem;
+
+	/** Dictionary snapshot, which was current when context was made, keyword indexes are built from it */
+	FDictionarySnapshotPtr Snapshot;
+
+	const UStringDistanceFunction* StringDistanceFunction;
+
+	/** Player component, which is asking for reply */
+	const UPlayerNaturalDialogComponent* OwnerComponent;
+
+	/** Tables available for NPC, in the order of player component tables */
+	TArray<const UDataTable*> NpcTables;
+
+	/** Keyword index for every table of NpcTables, index is shared, so table can be removed during matching */
+	TArray<TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe>> NpcKeywordIndexes;
+
+	/** Cache of reply candidates of player, nullptr if cache is disabled */
+	TSharedPtr<FReplyCandidateCache, ESPMode::ThreadSafe> ReplyCache;
+
+	/** Generation of ReplyCache, when context was made */
+	uint32 ReplyCacheGeneration;
+};
+
+/**
+ * Reply matcher of UDefaultDialogReplyFunction, @see FDialogReplyMatcher
+ */
+class NATURALDIALOGSYSTEM_API FDefaultDialogReplyMatcher : public FDialogReplyMatcher
+{
+public:
+	explicit FDefaultDialogReplyMatcher(const FReplyMatchingContext& InContext)
+		: Context(InContext) {}
+
+	virtual TArray<FReplyData> FindReplyCandidates(const FString& Sentence) const override;
+
+	/** Candidates are shared only if keyword picker doesn't depend on player, key contains ordered tables, because their order breaks ties of replies */
+	virtual bool GetSharingKey(FString& OutKey) const override;
+
+private:
+	FReplyMatchingContext Context;
+};
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UDefaultDialogReplyFunction : public UDialogReplyFunction
+{
+	GENERATED_BODY()
+
+public:
+	UDefaultDialogReplyFunction();
+
+	/** Min count of keywords in combination, which tables are intersected, @see FindBestTableBits() */
+	static constexpr int32 MinCombination = 2;
+	
+protected:
+	/**
+	 * Defines interval of calling function HandleMatrixWeariness()
+	 * If interval is 1, then every second will metric weariness value is increased
+	 * Weariness value is not increased for every answer in data tables (it's random)
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Properties")
+	float MetricInterval;
+	
+	/**
+	* Curve is used for calculate metric values for reply function
+	* Time (horizontal) value tels current metric value and vertical the new target value
+	* If is not set, then is used basic algorithm to calculate new metric value
+	*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Properties")
+	UCurveFloat* MetricCurve;
+
+	/**
+	 * Max count of sentences, which reply candidates are cached
+	 * Repeated questions (greetings, quest questions) skip word correction, keyword picking and table matching
+	 * If is 0, then cache is disabled
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Properties", meta = (ClampMin = 0))
+	int32 ReplyCacheCapacity;
+
+	UPROPERTY()
+	TSubclassOf<UStringDistanceFunction> StringDistanceFunctionClass;
+	
+	/**
+	* All invalid responses, when NPC doesnt recognize the answer
+	* If not set, is used default reply text, without answer wave
+	*/
+	UPROPERTY(EditDefaultsOnly, meta=(RequiredAssetDataTags = "RowStructure=NaturalDialogRow_Base"), Category="Natural Dialog Component")
+	UDataTable* DefaultResponses;
+
+public:
+	virtual void InitializeDialogReplyPicker() override;
+	virtual bool GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer) override;
+	virtual bool GenerateReplyFromTerms(const TArray<uint32>& KeywordTerms, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer) override;
+	virtual TSharedPtr<FDialogReplyMatcher, ESPMode::ThreadSafe> CreateReplyMatcher(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) override;
+	virtual bool ResolveReply(const TArray<FReplyData>& Candidates, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer) override;
+
+	virtual TSet<const UDataTable*> FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<FString>& Keywords) const;
+	virtual TSet<const UDataTable*> FindBestTableSet(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, const TArray<uint32>& KeywordTerms) const;
+
+	/**
+	 * Finds reply candidates for keywords, uses only data of context, so it is thread-safe
+	 * @param Context - Matching data prepared on game thread, @see MakeMatchingContext()
+	 * @param KeywordTerms - Term ids of keywords
+	 * @return - Rows of tables, which match keywords the best
+	 */
+	static TArray<FReplyData> MatchReplyCandidates(const FReplyMatchingContext& Context, const TArray<uint32>& KeywordTerms);
+
+	/**
+	 * Finds reply candidates for sentence in reply cache of context, or generates keywords and matches them
+	 * @param Context - Matching data prepared on game thread, @see MakeMatchingContext()
+	 * @param Sentence - Sentence from player input
+	 * @return - Rows of tables, which match keywords of sentence the best
+	 */
+	static TArray<FReplyData> FindReplyCandidates(const FReplyMatchingContext& Context, const FString& Sentence);
+
+	/** Returns hit and miss counters of reply candidate cache */
+	UFUNCTION(BlueprintCallable, Category="Natural Dialog System")
+	FReplyCacheStats GetReplyCacheStats() const;
+
+	/**
+	 * Selects tables, where are the most of keyword pairs used
+	 * @param Context - Matching data, keyword indexes are not required
+	 * @param Keywords - Term ids of keywords
+	 * @return - Indexes to Context.NpcTables
+	 */
+	static TArray<int32> FindBestTables(const FReplyMatchingContext& Context, const TArray<uint32>& Keywords);
+
+	/**
+	 * Finds the biggest table set of all keyword combinations with at least MinCombination keywords, for equal sizes the first combination wins
+	 * @param KeywordTables - Table bitset of every keyword, bitsets are stored one after another
+	 * @param NumOfWords - Count of 64 bit words of one bitset
+	 * @param OutTables - Bitset of the best table set, NumOfWords words
+	 */
+	static void FindBestTableBits(const TArrayView<const uint64>& KeywordTables, const int32 NumOfWords, const TArrayView<uint64>& OutTables);
+
+protected:
+	/** Returns keyword index of table, index is built when it doesn't exist yet */
+	TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe> FindOrBuildKeywordIndex(const UDataTable* InTable);
+
+	/** Fills matching context without keyword indexes */
+	void FillMatchingContext(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FReplyMatchingContext& Context) const;
+
+	/** Prepares matching context with keyword indexes of all NPC tables, called on game thread */
+	FReplyMatchingContext MakeMatchingContext(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent);
+
+	/** Handle case when input table is registered as new data table in owner component */
+	UFUNCTION()
+	void HandleNewTableRegistration(const UDataTable* NewTable);
+
+	/** Handle case when input table is removed from owner component */
+	UFUNCTION()
+	void HandleRegisteredTableRemoved(const UDataTable* NewTable);
+
+	UFUNCTION()
+	void HandleMatrixWeariness();
+
+	/** Updates term ids of keyword indexes, because keywords can be new terms in the new dictionary snapshot */
+	void HandleDictionarySnapshotChanged(const FDictionarySnapshotPtr& NewSnapshot);
+	
+private:
+	/** Refreshes dictionary references, when they are not valid, @return - False, if dictionary is not available */
+	bool UpdateDictionaryReferences();
+
+	FReplyData FindBestReply(const TArray<FReplyData>& AllReplies) const;
+	void ModifyMetricValue(const UDataTable* InTable, const FName InRow, const int32 AnswerIndex);
+	void LogMetricValues();
+
+private:
+	/**
+	 * Initialized in function InitializeDialogReplyPicker()
+	 * Strong ref in game instance
+	 */
+	TWeakObjectPtr<UDictionarySubsystem> DictionarySubsystem;
+
+	/**
+	 * Initialized in function InitializeDialogReplyPicker()
+	 * Strong ref in game instance
+	 */
+	UPROPERTY()
+	UStringDistanceFunction* StringDistanceFunction;
+	
+	TWeakObjectPtr<UPlayerNaturalDialogComponent> OwnerComponent;
+
+	/**
+	 * Metric is used to compute variations for NPC reply
+	 * Every data table and row is stored metric value which is decreased when the answer of the row is used
+	 * When we find correct reply of two answers, we use the one with greatest metric value
+	 */
+	FDialogMetric Metric;
+
+	/** Keyword indexes of all registered tables, @see FTableKeywordIndex */
+	TMap<const UDataTable*, TSharedPtr<const FTableKeywordIndex, ESPMode::ThreadSafe>> KeywordIndexes;
+
+	/** Reply candidates of repeated sentences, created in InitializeDialogReplyPicker() if ReplyCacheCapacity is set */
+	TSharedPtr<FReplyCandidateCache, ESPMode::ThreadSafe> ReplyCache;
+	
+	FTimerHandle MatrixWearinessHandler;
+};
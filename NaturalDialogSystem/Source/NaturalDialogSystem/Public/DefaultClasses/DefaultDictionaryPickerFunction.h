@@ -1,29 +1,64 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-#include "Core/DictionarySubsystem.h"
-#include "FunctionalClasses/DictionaryWordPickerFunction.h"
-#include "DefaultDictionaryPickerFunction.generated.h"
-
-
-DECLARE_LOG_CATEGORY_EXTERN(Log_DefaultDictPickerFunction, Log, All);
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API UDefaultDictionaryPickerFunction : public UDictionaryWordPickerFunction
-{
-	GENERATED_BODY()
-
-public:
-	virtual void InitializeWordPicker() override;
-	virtual FString PickWordFromDictionary(const FString& Input) const override;
-	
-private:
-	/** Cached outer dictionary */
-	TWeakObjectPtr<const UDictionarySubsystem> CachedDictionarySubsystem;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Core/DictionarySubsystem.h"
+#include "FunctionalClasses/DictionaryWordPickerFunction.h"
+#include "DefaultDictionaryPickerFunction.generated.h"
+
+
+DECLARE_LOG_CATEGORY_EXTERN(Log_DefaultDictPickerFunction, Log, All);
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UDefaultDictionaryPickerFunction : public UDictionaryWordPickerFunction
+{
+	GENERATED_BODY()
+
+public:
+	UDefaultDictionaryPickerFunction();
+
+protected:
+	/**
+	 * Max distance of input and dictionary word
+	 * Used only if dictionary representation supports nearest word lookup (e.g. UBKTreeDictionaryRepresentation)
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Dictionary word picker")
+	int32 MaxNearestWordDistance;
+
+	/**
+	 * Words of large buckets are scanned in parallel on worker threads
+	 * Result is the same as for serial scan, between words with the same distance wins the first word of bucket
+	 * Used only if dictionary representation supports ranges of words (e.g. UCompactDictionaryRepresentation) and string distance function is thread-safe
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category= "Dictionary word picker")
+	bool bParallelCandidateScan;
+
+	/** Min count of words in scanned buckets, when words are scanned in parallel */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, meta = (EditCondition = "bParallelCandidateScan", ClampMin = 1), Category= "Dictionary word picker")
+	int32 MinParallelScanWords;
+
+public:
+	virtual void InitializeWordPicker() override;
+	virtual FString PickWordFromDictionary(const FString& Input) const override;
+	
+private:
+	/**
+	 * Scans words of buckets in parallel, only if parallel scan is enabled and buckets are large enough
+	 * @param DictionaryRepresentation - Dictionary of held snapshot
+	 * @param Input - Normalized input word
+	 * @param WordLens - Lens of scanned buckets, in order of serial scan
+	 * @param DistanceLimit - Only words closer than this value are picked
+	 * @param OutDistance - Distance of the best word, it is not changed if no word is closer than limit
+	 * @param OutWord - The best word, it is not changed if no word is closer than limit
+	 * @return - False, if words have to be scanned serially
+	 */
+	bool ScanWordsInParallel(const UDictionaryRepresentation* DictionaryRepresentation, const FString& Input, const TArray<int32, TInlineAllocator<2>>& WordLens, const int32 DistanceLimit, int32& OutDistance, FString& OutWord) const;
+
+	/** Cached outer dictionary */
+	TWeakObjectPtr<const UDictionarySubsystem> CachedDictionarySubsystem;
+};
@@ -1,30 +1,52 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Resources/DictionaryRepresentation.h"
-#include "DefaultDictionaryRepresentation.generated.h"
-
-struct FDictionaryData;
-
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API UDefaultDictionaryRepresentation : public UDictionaryRepresentation
-{
-	GENERATED_BODY()
-
-public:
-	virtual void InitializeDictionary() override;
-	virtual void RegisterWord(const FString& Word, const UDataTable* FromDataTable) override;
-	
-	virtual TArray<FString> GetListOfWords() const override;
-	virtual TArray<FString> GetListOfWordsOfLen(const int32 WordLen) const override;
-	virtual const FDictionaryData* GetWordData(const FString& Word) const override;
-	
-protected:
-	TArray<TMap<FString, FDictionaryData>> DictionaryData;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "DefaultDictionaryRepresentation.generated.h"
+
+struct FDictionaryData;
+
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UDefaultDictionaryRepresentation : public UDictionaryRepresentation
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeDictionary() override;
+	virtual void RegisterWord(const FString& Word, const UDataTable* FromDataTable) override;
+	virtual void RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) override;
+	virtual bool CopyDictionary(const UDictionaryRepresentation* Other) override;
+	
+	virtual TArray<FString> GetListOfWords() const override;
+	virtual TArray<FString> GetListOfWordsOfLen(const int32 WordLen) const override;
+	virtual void ForEachWordOfLen(const int32 WordLen, TFunctionRef<bool(const FStringView& Word)> Visitor) const override;
+	virtual const FDictionaryData* GetWordData(const FString& Word) const override;
+	virtual const FDictionaryData* GetTermData(const uint32 TermId) const override;
+	virtual bool SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const override;
+	virtual bool LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	
+protected:
+	/** Sets index of word data for term id, @see TermWords */
+	void MapTermToWord(const uint32 TermId, const int32 WordIndex);
+
+protected:
+	/** Buckets of words with the same len, value is index to WordsData */
+	TArray<TMap<FString, int32>> DictionaryData;
+
+	/** Data of all registered words, indexes are stable, data of removed word are reused by the next new word */
+	TArray<FDictionaryData> WordsData;
+
+	/** Index to WordsData for every interned term id, INDEX_NONE if term is not in dictionary */
+	TArray<int32> TermWords;
+
+	/** Indexes to WordsData of removed words */
+	TArray<int32> FreeWordsData;
+};
@@ -1,19 +1,30 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "FunctionalClasses/StringDistanceFunction.h"
-#include "LevenshteinDistanceFunction.generated.h"
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API ULevenshteinDistanceFunction : public UStringDistanceFunction
-{
-	GENERATED_BODY()
-
-public:
-	virtual uint32 GetStringDistance(const FString& InputA, const FString& InputB) const override;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FunctionalClasses/StringDistanceFunction.h"
+#include "LevenshteinDistanceFunction.generated.h"
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API ULevenshteinDistanceFunction : public UStringDistanceFunction
+{
+	GENERATED_BODY()
+
+public:
+	virtual uint32 GetStringDistance(const FString& InputA, const FString& InputB) const override;
+
+	/** Uses DP matrix limited to diagonal band of width (2 * MaxDistance + 1), so rejected strings cost O(MaxDistance * Len) */
+	virtual uint32 GetStringDistanceBounded(const FString& InputA, const FString& InputB, const uint32 MaxDistance) const override;
+	virtual uint32 GetStringViewDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance) const override;
+	virtual bool IsEditDistance() const override { return true; }
+
+	/** Computes Levenshtein distance of two strings, usable without function instance (e.g. in dictionary indexes) */
+	static uint32 ComputeDistance(const FStringView& InputA, const FStringView& InputB);
+
+	/** Computes Levenshtein distance of two strings in diagonal band, @see GetStringDistanceBounded() */
+	static uint32 ComputeDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance);
+};
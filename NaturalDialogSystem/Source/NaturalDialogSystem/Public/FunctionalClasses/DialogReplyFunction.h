@@ -1,41 +1,100 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Resources/Resources.h"
-#include "UObject/NoExportTypes.h"
-#include "DialogReplyFunction.generated.h"
-
-class UNpcNaturalDialogComponent;
-/**
- * Function trying to find the best answer for player dialog input
- * Instance is created every UNaturalDialogSystemComponent and active during game session
- * Takes keywords, returned from UDictionarySubsystem and make a reply for user using virtual function
- */
-UCLASS(Abstract, Blueprintable)
-class NATURALDIALOGSYSTEM_API UDialogReplyFunction : public UObject
-{
-	GENERATED_BODY()
-
-public:
-	/**
-	* Called from UPlayerNaturalDialogComponent after object creation
-	* Initialize object properties before trying pickup reply
-	*/
-	virtual void InitializeDialogReplyPicker() {};
-
-	/**
-	 * Picks the best answer for player input using found keywords
-	 * @param Sentence - Sentence from player input
-	 * @param NpcNaturalDialogComponent - Npc, we are asking for reply
-	 * @param ResultAnswer - Answer result from table
-	 * @return - Returns True, if was reply found, otherwise false, then is used default data table from NaturalDialogSystemComponent
-	 */
-	virtual bool GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
-	{
-		ResultAnswer = FNaturalDialogResult();
-		check(0 && "Must be overridden");
-		return false;
-	}
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Resources/Resources.h"
+#include "UObject/NoExportTypes.h"
+#include "DialogReplyFunction.generated.h"
+
+class UNpcNaturalDialogComponent;
+
+/**
+ * Thread-safe part of reply generation, created by UDialogReplyFunction::CreateReplyMatcher() on game thread
+ * Matcher holds only read only data, so reply candidates of sentence can be found on worker thread
+ * Candidates are then resolved on game thread by UDialogReplyFunction::ResolveReply()
+ */
+class NATURALDIALOGSYSTEM_API FDialogReplyMatcher
+{
+public:
+	virtual ~FDialogReplyMatcher() {}
+
+	/**
+	 * Finds all reply candidates for player sentence, called on worker thread
+	 * @param Sentence - Sentence from player input
+	 * @return - Reply candidates, the best one is selected by UDialogReplyFunction::ResolveReply()
+	 */
+	virtual TArray<FReplyData> FindReplyCandidates(const FString& Sentence) const = 0;
+
+	/**
+	 * Returns key of all data, which candidates depend on except of sentence, called on game thread
+	 * Matchers with the same key find the same candidates for the same sentence, so candidates can be found once for more players
+	 * @param OutKey - Key of matcher data
+	 * @return - False, if candidates depend on the player, then they are never shared with other players
+	 */
+	virtual bool GetSharingKey(FString& OutKey) const { return false; }
+};
+
+/**
+ * Function trying to find the best answer for player dialog input
+ * Instance is created every UNaturalDialogSystemComponent and active during game session
+ * Takes keywords, returned from UDictionarySubsystem and make a reply for user using virtual function
+ */
+UCLASS(Abstract, Blueprintable)
+class NATURALDIALOGSYSTEM_API UDialogReplyFunction : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	* Called from UPlayerNaturalDialogComponent after object creation
+	* Initialize object properties before trying pickup reply
+	*/
+	virtual void InitializeDialogReplyPicker() {};
+
+	/**
+	 * Picks the best answer for player input using found keywords
+	 * @param Sentence - Sentence from player input
+	 * @param NpcNaturalDialogComponent - Npc, we are asking for reply
+	 * @param ResultAnswer - Answer result from table
+	 * @return - Returns True, if was reply found, otherwise false, then is used default data table from NaturalDialogSystemComponent
+	 */
+	virtual bool GenerateReply(const FString& Sentence, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+	{
+		ResultAnswer = FNaturalDialogResult();
+		check(0 && "Must be overridden");
+		return false;
+	}
+
+	/**
+	 * Picks the best answer for already generated keywords
+	 * By default terms are joined into sentence for GenerateReply(), override to match keywords by term ids
+	 * @param KeywordTerms - Term ids of keywords, @see UDictionarySubsystem::GenerateKeywordTerms()
+	 * @param NpcNaturalDialogComponent - Npc, we are asking for reply
+	 * @param ResultAnswer - Answer result from table
+	 * @return - Returns True, if was reply found
+	 */
+	virtual bool GenerateReplyFromTerms(const TArray<uint32>& KeywordTerms, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer);
+
+	/**
+	 * Prepares read only matching of reply candidates for asynchronous reply, called on game thread
+	 * Override together with ResolveReply(), when function supports asynchronous reply generation
+	 * @param NpcNaturalDialogComponent - Npc, we are asking for reply
+	 * @return - Matcher used on worker thread, or nullptr if reply has to be generated on game thread by GenerateReply()
+	 */
+	virtual TSharedPtr<FDialogReplyMatcher, ESPMode::ThreadSafe> CreateReplyMatcher(const UNpcNaturalDialogComponent* NpcNaturalDialogComponent) { return nullptr; }
+
+	/**
+	 * Selects the best reply from candidates found by FDialogReplyMatcher, called on game thread
+	 * There can be updated state of function (e.g. metric values), which is not accessible from worker thread
+	 * @param Candidates - Reply candidates of one sentence
+	 * @param NpcNaturalDialogComponent - Npc, we are asking for reply
+	 * @param ResultAnswer - Answer result from table
+	 * @return - Returns True, if was reply found
+	 */
+	virtual bool ResolveReply(const TArray<FReplyData>& Candidates, const UNpcNaturalDialogComponent* NpcNaturalDialogComponent, FNaturalDialogResult& ResultAnswer)
+	{
+		ResultAnswer = FNaturalDialogResult();
+		return false;
+	}
+};
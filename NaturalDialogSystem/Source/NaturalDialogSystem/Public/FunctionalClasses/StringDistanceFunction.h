@@ -1,37 +1,69 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
-#include "StringDistanceFunction.generated.h"
-
-/**
- * Function takes two string and measure metric distance between them
- * You can create your own algorithm for measure string distances, by creating child class and set it into plugin settings
- * In plugin is created default algorithm (Levenshtein distance)
- */
-UCLASS(Abstract, Blueprintable)
-class NATURALDIALOGSYSTEM_API UStringDistanceFunction : public UObject
-{
-	GENERATED_BODY()
-
-public:
-	/**
-	* Called from UDictionaryWordPickerFunction after object creation
-	* Initialize object properties before trying pickup keywords
-	*/
-	virtual void InitializeDistFunction() {}
-
-	/**
-	 * Override this function to create your own algorithm for measure string distances
-	 * @param InputA - First string to measure with second param
-	 * @param InputB - Second string to measure with first param
-	 * @return - Result distance value between input strings
-	 */
-	virtual uint32 GetStringDistance(const FString& InputA, const FString& InputB) const
-	{
-		check(0 && "Must be overridden");
-		return 0;
-	}
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "UObject/NoExportTypes.h"
+#include "StringDistanceFunction.generated.h"
+
+/**
+ * Function takes two string and measure metric distance between them
+ * You can create your own algorithm for measure string distances, by creating child class and set it into plugin settings
+ * In plugin is created default algorithm (Levenshtein distance)
+ */
+UCLASS(Abstract, Blueprintable)
+class NATURALDIALOGSYSTEM_API UStringDistanceFunction : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	* Called from UDictionaryWordPickerFunction after object creation
+	* Initialize object properties before trying pickup keywords
+	*/
+	virtual void InitializeDistFunction() {}
+
+	/**
+	 * Override this function to create your own algorithm for measure string distances
+	 * @param InputA - First string to measure with second param
+	 * @param InputB - Second string to measure with first param
+	 * @return - Result distance value between input strings
+	 */
+	virtual uint32 GetStringDistance(const FString& InputA, const FString& InputB) const
+	{
+		check(0 && "Must be overridden");
+		return 0;
+	}
+
+	/**
+	 * Measures string distance, but only up to the given bound
+	 * Callers, which only compare distance with their current best value, should use this function
+	 * Override it to stop the computation early, default implementation computes the full distance
+	 * @param InputA - First string to measure with second param
+	 * @param InputB - Second string to measure with first param
+	 * @param MaxDistance - Max distance the caller is interested in
+	 * @return - Exact distance, if it is not greater than MaxDistance, otherwise MaxDistance + 1
+	 */
+	virtual uint32 GetStringDistanceBounded(const FString& InputA, const FString& InputB, const uint32 MaxDistance) const
+	{
+		const uint32 Distance = GetStringDistance(InputA, InputB);
+		return Distance > MaxDistance ? MaxDistance + 1 : Distance;
+	}
+
+	/**
+	 * Returns true, if distance is count of character insertions, deletions and substitutions
+	 * Then word picker can reject words by lower bound of this distance, @see FDictionaryWordSignature
+	 */
+	virtual bool IsEditDistance() const { return false; }
+
+	/**
+	 * Measures bounded string distance of string views, @see GetStringDistanceBounded()
+	 * Used for words, which are not stored as FString (e.g. words from UDictionaryRepresentation::ForEachWordOfLen())
+	 * Override it to measure views without copying, default implementation copies views to strings
+	 */
+	virtual uint32 GetStringViewDistanceBounded(const FStringView& InputA, const FStringView& InputB, const uint32 MaxDistance) const
+	{
+		return GetStringDistanceBounded(FString(InputA.Len(), InputA.GetData()), FString(InputB.Len(), InputB.GetData()), MaxDistance);
+	}
+};
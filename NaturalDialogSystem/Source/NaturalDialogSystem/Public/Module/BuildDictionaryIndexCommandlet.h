@@ -0,0 +1,26 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BuildDictionaryIndexCommandlet.generated.h"
+
+
+DECLARE_LOG_CATEGORY_EXTERN(LogBuildDictionaryIndexCommandlet, Log, All);
+
+/**
+ * Builds prebuilt dictionary index from all dialog tables in project content
+ * Run it before packaging, e.g.: UE4Editor-Cmd.exe Project.uproject -run=BuildDictionaryIndex
+ * Optional param -Output=<Path> overrides the index file path from project settings
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UBuildDictionaryIndexCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBuildDictionaryIndexCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
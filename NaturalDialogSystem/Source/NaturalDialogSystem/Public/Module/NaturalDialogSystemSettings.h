@@ -1,54 +1,95 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "DeveloperSettings/Public/Engine/DeveloperSettings.h"
-
-#include "FunctionalClasses/DictionaryWordPickerFunction.h"
-#include "FunctionalClasses/KeywordPickerFunction.h"
-#include "Resources/DictionaryRepresentation.h"
-#include "NaturalDialogSystemSettings.generated.h"
-
-
-/**
- * 
- */
-UCLASS(Config = Engine, DefaultConfig)
-class NATURALDIALOGSYSTEM_API UNaturalDialogSystemSettings : public UDeveloperSettings
-{
-	GENERATED_BODY()
-
-public:
-	UNaturalDialogSystemSettings();
-
-protected:
-	/** If true, UDictionarySubsystem will log more info into output log */
-	UPROPERTY(EditAnywhere, config, Category = "Debug")
-	uint8 bDebugDictionary : 1;
-
-	/** Defines string metric function class, for evaluate distance of two strings in UDictionarySubsystem */
-	UPROPERTY(EditAnywhere, config, Category = "Functions")
-	TSubclassOf<UDictionaryWordPickerFunction> DictionaryWordPickerFunctionClass;
-
-	/** Defines keyword function class, which evaluate input sentence and picks keywords for response */
-	UPROPERTY(EditAnywhere, config, Category = "Functions")
-	TSubclassOf<UKeywordPickerFunction> KeywordPickerFunctionClass;
-
-	/** Defines dictionary representation of words */
-	UPROPERTY(EditAnywhere, config, Category = "Functions")
-	TSubclassOf<UDictionaryRepresentation> DictionaryRepresentationClass;
-
-public:
-	/** Returns true, if dictionary debug is enabled  */
-	FORCEINLINE bool GetDebugDictionary() const { return bDebugDictionary; }
-
-	/** Returns string distance function class */
-	FORCEINLINE TSubclassOf<UDictionaryWordPickerFunction> GetDictionaryWordPickerFunctionClass() const { return DictionaryWordPickerFunctionClass; }
-
-	/** Returns keyword picker function class */
-	FORCEINLINE TSubclassOf<UKeywordPickerFunction> GetKeywordPickerFunctionClass() const { return KeywordPickerFunctionClass; }
-
-	/** Returns dictionary representation class */
-	FORCEINLINE TSubclassOf<UDictionaryRepresentation> GetDictionaryRepresentationClass() const { return DictionaryRepresentationClass; }
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DeveloperSettings/Public/Engine/DeveloperSettings.h"
+
+#include "FunctionalClasses/DictionaryWordPickerFunction.h"
+#include "FunctionalClasses/KeywordPickerFunction.h"
+#include "Resources/DictionaryRepresentation.h"
+#include "NaturalDialogSystemSettings.generated.h"
+
+
+/**
+ * 
+ */
+UCLASS(Config = Engine, DefaultConfig)
+class NATURALDIALOGSYSTEM_API UNaturalDialogSystemSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UNaturalDialogSystemSettings();
+
+protected:
+	/** If true, UDictionarySubsystem will log more info into output log */
+	UPROPERTY(EditAnywhere, config, Category = "Debug")
+	uint8 bDebugDictionary : 1;
+
+	/** Defines string metric function class, for evaluate distance of two strings in UDictionarySubsystem */
+	UPROPERTY(EditAnywhere, config, Category = "Functions")
+	TSubclassOf<UDictionaryWordPickerFunction> DictionaryWordPickerFunctionClass;
+
+	/** Defines keyword function class, which evaluate input sentence and picks keywords for response */
+	UPROPERTY(EditAnywhere, config, Category = "Functions")
+	TSubclassOf<UKeywordPickerFunction> KeywordPickerFunctionClass;
+
+	/** Defines dictionary representation of words */
+	UPROPERTY(EditAnywhere, config, Category = "Functions")
+	TSubclassOf<UDictionaryRepresentation> DictionaryRepresentationClass;
+
+	/**
+	 * If true, UDictionarySubsystem loads dictionary from prebuilt index file instead of words registration from all dialog tables
+	 * Index is built by commandlet (-run=BuildDictionaryIndex) and in editor, when dialog tables have changed
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Dictionary")
+	uint8 bUsePrebuiltDictionary : 1;
+
+	/**
+	 * Path of prebuilt dictionary index file, relative to project content directory
+	 * Add the directory into "Additional Non-Asset Directories To Copy" to package the index with game
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Dictionary", meta = (EditCondition = "bUsePrebuiltDictionary"))
+	FString PrebuiltDictionaryPath;
+
+	/**
+	 * Max count of corrected words, which are remembered by UDictionarySubsystem
+	 * Misspellings are repeated by players, so their correction is not searched in dictionary again
+	 * If is 0, then cache is disabled
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Dictionary", meta = (ClampMin = 0))
+	int32 WordCorrectionCacheCapacity;
+
+	/**
+	 * If true, letters with diacritics are normalized to base letters, e.g. U+00E1 -> a, so players can write without diacritics
+	 * Dictionary has to be rebuilt after change, prebuilt index is rebuilt automatically
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Dictionary")
+	uint8 bFoldDiacritics : 1;
+
+public:
+	/** Returns true, if dictionary debug is enabled  */
+	FORCEINLINE bool GetDebugDictionary() const { return bDebugDictionary; }
+
+	/** Returns string distance function class */
+	FORCEINLINE TSubclassOf<UDictionaryWordPickerFunction> GetDictionaryWordPickerFunctionClass() const { return DictionaryWordPickerFunctionClass; }
+
+	/** Returns keyword picker function class */
+	FORCEINLINE TSubclassOf<UKeywordPickerFunction> GetKeywordPickerFunctionClass() const { return KeywordPickerFunctionClass; }
+
+	/** Returns dictionary representation class */
+	FORCEINLINE TSubclassOf<UDictionaryRepresentation> GetDictionaryRepresentationClass() const { return DictionaryRepresentationClass; }
+
+	/** Returns true, if prebuilt dictionary index is used */
+	FORCEINLINE bool GetUsePrebuiltDictionary() const { return bUsePrebuiltDictionary; }
+
+	/** Returns max count of cached word corrections */
+	FORCEINLINE int32 GetWordCorrectionCacheCapacity() const { return WordCorrectionCacheCapacity; }
+
+	/** Returns true, if diacritics are removed from letters in normalization */
+	FORCEINLINE bool GetFoldDiacritics() const { return bFoldDiacritics; }
+
+	/** Returns absolute path of prebuilt dictionary index file */
+	FString GetPrebuiltDictionaryFilePath() const;
+};
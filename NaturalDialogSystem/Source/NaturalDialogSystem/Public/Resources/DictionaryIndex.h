@@ -0,0 +1,58 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDataTable;
+struct FDictionarySnapshot;
+
+/** Increase, when format of index or words normalization is changed, old index files are then rebuilt */
+#define DICTIONARY_INDEX_VERSION 5
+
+#define DICTIONARY_INDEX_MAGIC 0x4E445349
+
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDictionaryIndex, Log, All);
+
+/**
+ * Prebuilt dictionary index, which is stored as binary file
+ * File is built by commandlet (-run=BuildDictionaryIndex) or by editor game session, when dictionary was rebuilt
+ * UDictionarySubsystem loads the file at startup instead of words registration from all dialog tables
+ * Index is valid only for the same list of dialog tables, the same content hash of tables and the same dictionary representation class
+ * Cooked game checks only list of tables, texts of cooked tables can't change without new package, which contains rebuilt index
+ */
+struct NATURALDIALOGSYSTEM_API FDictionaryIndex
+{
+	/** Returns tables sorted by path name, index is independent on order of asset discovery */
+	static TArray<const UDataTable*> GetSortedTables(const TSet<UDataTable*>& Tables);
+
+	/** Computes hash of index version, normalization settings, current culture and path names of tables, it doesn't read content of tables */
+	static uint32 ComputeTableListHash(const TArray<const UDataTable*>& SortedTables);
+
+	/**
+	 * Computes hash of all texts in dialog tables, which are used for words registration
+	 * It is much cheaper than words registration, because texts are not split and normalized, but it still reads all texts
+	 */
+	static uint32 ComputeContentHash(const TArray<const UDataTable*>& SortedTables);
+
+	/**
+	 * Writes dictionary into index file
+	 * @param FilePath - Absolute path of index file
+	 * @param Snapshot - Dictionary snapshot with registered words of all tables
+	 * @param SortedTables - Tables, which were used for words registration, @see GetSortedTables()
+	 * @param ContentHash - Hash of the tables, @see ComputeContentHash()
+	 * @return - True, if index file was written
+	 */
+	static bool Save(const FString& FilePath, const FDictionarySnapshot& Snapshot, const TArray<const UDataTable*>& SortedTables, const uint32 ContentHash);
+
+	/**
+	 * Reads dictionary from index file
+	 * @param FilePath - Absolute path of index file
+	 * @param Snapshot - Snapshot with empty dictionary, which is filled by index data
+	 * @param SortedTables - Currently discovered dialog tables, @see GetSortedTables()
+	 * @param ContentHash - Hash of currently discovered tables, when differs from index, the index is not used, if not set, content is not checked
+	 * @return - True, if dictionary was loaded from index
+	 */
+	static bool Load(const FString& FilePath, FDictionarySnapshot& Snapshot, const TArray<const UDataTable*>& SortedTables, const TOptional<uint32>& ContentHash);
+};
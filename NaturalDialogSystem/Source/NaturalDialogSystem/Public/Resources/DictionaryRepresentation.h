@@ -1,61 +1,237 @@
-﻿// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-#include "Resources.h"
-#include "UObject/Object.h"
-#include "DictionaryRepresentation.generated.h"
-
-/**
- * Custom representation of data in dictionary
- * Any representation is OK for any solution
- * E.g. you can split words in buckets, where one bucket is for words of length == 1, next bucket is for words of length == 2, ...
- * By this representation we can optimize selection of words to check in string metrics, or when we trying to find keywords, etc.
- * You can create your representation for custom optimization and select it in project settings
- */
-UCLASS(Abstract)
-class NATURALDIALOGSYSTEM_API UDictionaryRepresentation : public UObject
-{
-	GENERATED_BODY()
-
-public:
-	/**
-	 * Is called after object creation
-	 * Initialize dictionary properties before words registration
-	 */
-	virtual void InitializeDictionary() {};
-
-	/**
-	 * Function called from UDictionarySubsystem
-	 * There are processing all words from game content
-	 * @param Word - registered word from data tables or your custom word for the dictionary
-	 * @param FromDataTable - Data table, where is word used
-	 */
-	virtual void RegisterWord(const FString& Word, const UDataTable* FromDataTable)
-	{
-		check(0 && "Set a valid dictionary representation");
-	}
-
-	/** Return list of all words in dictionary */
-	virtual TArray<FString> GetListOfWords() const
-	{
-		check(0 && "Set a valid dictionary representation");
-		return {};
-	}
-
-	virtual TArray<FString> GetListOfWordsOfLen(const int32 WordLen) const
-	{
-		check(0 && "Set a valid dictionary representation");
-		return {};
-	}
-
-	/** Return word data */
-	virtual const FDictionaryData* GetWordData(const FString& Word) const
-	{
-		check(0 && "Set a valid dictionary representation");
-		return nullptr;
-	}
-
-};
+﻿// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+#include "Resources.h"
+#include "UObject/Object.h"
+#include "DictionaryRepresentation.generated.h"
+
+/**
+ * Cheap signature of word, used to reject dictionary words without measuring of string distance
+ * Every character sets one bit of letter mask, so words, which differ in many characters, have distant masks
+ */
+struct FDictionaryWordSignature
+{
+	/** Returns letter mask of word, bit (Character % 64) is set for every character */
+	static uint64 MakeLetterMask(const FStringView& Word)
+	{
+		uint64 Mask = 0;
+		for (int32 Index = 0; Index < Word.Len(); Index++)
+		{
+			Mask |= 1ull << (static_cast<uint32>(Word[Index]) & 63);
+		}
+		return Mask;
+	}
+
+	/**
+	 * Returns lower bound of edit distance of two words
+	 * Every character with bit missing in the other mask has to be substituted or deleted, one edit fixes at most one such bit in every word
+	 */
+	static FORCEINLINE int32 GetDistanceLowerBound(const uint64 LetterMaskA, const int32 LenA, const uint64 LetterMaskB, const int32 LenB)
+	{
+		return FMath::Max3(FMath::Abs(LenA - LenB), static_cast<int32>(FMath::CountBits(LetterMaskA & ~LetterMaskB)), static_cast<int32>(FMath::CountBits(LetterMaskB & ~LetterMaskA)));
+	}
+};
+
+/**
+ * Custom representation of data in dictionary
+ * Any representation is OK for any solution
+ * E.g. you can split words in buckets, where one bucket is for words of length == 1, next bucket is for words of length == 2, ...
+ * By this representation we can optimize selection of words to check in string metrics, or when we trying to find keywords, etc.
+ * You can create your representation for custom optimization and select it in project settings
+ */
+UCLASS(Abstract)
+class NATURALDIALOGSYSTEM_API UDictionaryRepresentation : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Is called after object creation
+	 * Initialize dictionary properties before words registration
+	 */
+	virtual void InitializeDictionary() {};
+
+	/**
+	 * Function called from UDictionarySubsystem
+	 * There are processing all words from game content
+	 * @param Word - registered word from data tables or your custom word for the dictionary
+	 * @param FromDataTable - Data table, where is word used
+	 */
+	virtual void RegisterWord(const FString& Word, const UDataTable* FromDataTable)
+	{
+		check(0 && "Set a valid dictionary representation");
+	}
+
+	/**
+	 * Function called from UDictionarySubsystem for words with interned term id
+	 * Override to store data by id, so they can be found without hashing of word, @see GetTermData()
+	 * @param Word - Normalized registered word
+	 * @param TermId - Id of word in subsystem term table
+	 * @param FromDataTable - Data table, where is word used
+	 */
+	virtual void RegisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable)
+	{
+		RegisterWord(Word, FromDataTable);
+	}
+
+	/**
+	 * Removes one occurence of word registered by RegisterTerm(), word is removed from dictionary with its last occurence
+	 * Override together with CopyDictionary() to allow incremental update of dictionary, @see UDictionarySubsystem::RemoveDialogTable()
+	 * @param Word - Normalized registered word
+	 * @param TermId - Id of word in subsystem term table
+	 * @param FromDataTable - Data table, where was word used
+	 * @return - False, if representation doesn't support removing of words
+	 */
+	virtual bool UnregisterTerm(const FString& Word, const uint32 TermId, const UDataTable* FromDataTable) { return false; }
+
+	/**
+	 * Copies all words data from other dictionary of the same class
+	 * New dictionary snapshot starts from copy of current one, so only words of changed table are registered
+	 * @param Other - Dictionary of current snapshot
+	 * @return - False, if representation doesn't support copy, then all words are registered again
+	 */
+	virtual bool CopyDictionary(const UDictionaryRepresentation* Other) { return false; }
+
+	/**
+	 * Called before snapshot of dictionary is published, dictionary is not modified after this call
+	 * Override to build lookup data, which would be expensive to update with every registered word
+	 */
+	virtual void FinalizeDictionary() {}
+
+	/** Return list of all words in dictionary */
+	virtual TArray<FString> GetListOfWords() const
+	{
+		check(0 && "Set a valid dictionary representation");
+		return {};
+	}
+
+	virtual TArray<FString> GetListOfWordsOfLen(const int32 WordLen) const
+	{
+		check(0 && "Set a valid dictionary representation");
+		return {};
+	}
+
+	/**
+	 * Calls visitor for every word of len, used by word picker to scan words without copying of them
+	 * Override to visit words directly in representation storage, default implementation visits words from GetListOfWordsOfLen()
+	 * @param WordLen - Len of visited words
+	 * @param Visitor - Called for every word, view is valid only during the call, returns false to stop enumeration
+	 */
+	virtual void ForEachWordOfLen(const int32 WordLen, TFunctionRef<bool(const FStringView& Word)> Visitor) const
+	{
+		for (const FString& Word : GetListOfWordsOfLen(WordLen))
+		{
+			if (!Visitor(Word))
+			{
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Calls visitor for words of len, which can be closer to the input than the distance limit
+	 * Other words are rejected by lower bound of distance, @see FDictionaryWordSignature
+	 * Override to filter words by precomputed signatures, default implementation computes signatures of words from ForEachWordOfLen()
+	 * @param WordLen - Len of visited words
+	 * @param Input - Word, to which is distance measured
+	 * @param DistanceLimit - Only words with lower bound of distance less than this value are visited
+	 * @param Visitor - Called for every candidate word, view is valid only during the call, returns new distance limit, 0 stops enumeration
+	 */
+	virtual void ForEachCandidateOfLen(const int32 WordLen, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const
+	{
+		const uint64 InputMask = FDictionaryWordSignature::MakeLetterMask(Input);
+		int32 Limit = DistanceLimit;
+
+		ForEachWordOfLen(WordLen, [&Input, InputMask, &Limit, &Visitor](const FStringView& Word)
+		{
+			if (FDictionaryWordSignature::GetDistanceLowerBound(FDictionaryWordSignature::MakeLetterMask(Word), Word.Len(), InputMask, Input.Len()) < Limit)
+			{
+				Limit = Visitor(Word);
+			}
+			return Limit > 0;
+		});
+	}
+
+	/**
+	 * Returns num of words of len, when words of bucket can be visited by index ranges, @see ForEachCandidateInRange()
+	 * Word picker splits large buckets into ranges, which are scanned in parallel
+	 * @return - INDEX_NONE, if representation doesn't support ranges
+	 */
+	virtual int32 GetNumOfWordsOfLen(const int32 WordLen) const { return INDEX_NONE; }
+
+	/**
+	 * Calls visitor for candidate words from range of bucket, @see ForEachCandidateOfLen()
+	 * Order of words in bucket is the same as in ForEachCandidateOfLen(), can be called from any thread
+	 * @param FirstWord - Index of the first word of range
+	 * @param NumOfWords - Num of words in range
+	 */
+	virtual void ForEachCandidateInRange(const int32 WordLen, const int32 FirstWord, const int32 NumOfWords, const FStringView& Input, const int32 DistanceLimit, TFunctionRef<int32(const FStringView& Word)> Visitor) const
+	{
+		check(0 && "Override together with GetNumOfWordsOfLen()");
+	}
+
+	/** Return word data */
+	virtual const FDictionaryData* GetWordData(const FString& Word) const
+	{
+		check(0 && "Set a valid dictionary representation");
+		return nullptr;
+	}
+
+	/** Return word data of interned term, by default the term is converted to word, @see GetWordData() */
+	virtual const FDictionaryData* GetTermData(const uint32 TermId) const
+	{
+		return TermTable && TermTable->IsValidId(TermId) ? GetWordData(TermTable->GetTerm(TermId)) : nullptr;
+	}
+
+	/** Called from FDictionarySnapshot after object creation, term table is owned by snapshot */
+	void SetTermTable(const FDictionaryTermTable* InTermTable) { TermTable = InTermTable; }
+
+	/** Called from FDictionarySnapshot after object creation, table registry is owned by snapshot */
+	void SetTableRegistry(FDictionaryTableRegistry* InTableRegistry) { TableRegistry = InTableRegistry; }
+
+	/** Returns true, if representation has own index for nearest word lookup, @see FindNearestWord() */
+	virtual bool SupportsNearestWordLookup() const { return false; }
+
+	/**
+	 * Finds the nearest dictionary word to the input word
+	 * Used by word picker instead of scanning all words of similar length
+	 * @param Word - Normalized input word
+	 * @param MaxDistance - Words with greater distance are ignored
+	 * @param OutWord - Found nearest word
+	 * @param OutDistance - Distance between input and found word
+	 * @return - True, if word within max distance was found
+	 */
+	virtual bool FindNearestWord(const FString& Word, const int32 MaxDistance, FString& OutWord, int32& OutDistance) const { return false; }
+
+	/**
+	 * Writes all dictionary data into prebuilt dictionary index
+	 * Override together with LoadDictionary() to allow loading of dictionary without words registration
+	 * @param Ar - Saving archive
+	 * @param Tables - Dialog tables of the index, tables are stored as index to this array
+	 * @return - False, if representation doesn't support prebuilt dictionary index
+	 */
+	virtual bool SaveDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) const { return false; }
+
+	/**
+	 * Reads all dictionary data from prebuilt dictionary index
+	 * @param Ar - Loading archive
+	 * @param Tables - Dialog tables of the index, in the same order as they were saved
+	 * @return - False, if representation doesn't support prebuilt dictionary index or data are corrupted
+	 */
+	virtual bool LoadDictionary(FArchive& Ar, const TArray<const UDataTable*>& Tables) { return false; }
+
+protected:
+	/** Returns dense index of table for FDictionaryData, new table is registered */
+	int32 RegisterTable(const UDataTable* Table) const { return TableRegistry ? TableRegistry->Register(Table) : INDEX_NONE; }
+
+protected:
+	/** Term table of owning snapshot, @see SetTermTable() */
+	const FDictionaryTermTable* TermTable = nullptr;
+
+	/** Table registry of owning snapshot, @see SetTableRegistry() */
+	FDictionaryTableRegistry* TableRegistry = nullptr;
+};
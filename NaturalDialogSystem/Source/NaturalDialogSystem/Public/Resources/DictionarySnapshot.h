@@ -0,0 +1,141 @@
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Resources/Resources.h"
+
+class UDataTable;
+class UDictionaryRepresentation;
+
+/**
+ * Keyword weights of one dictionary term, stored in snapshot by term id
+ * Counts are updated with every registered or removed table, weights are computed when snapshot is built
+ */
+struct FDictionaryTermWeight
+{
+	FDictionaryTermWeight()
+		: NumOfOccurences(0), NumOfTables(0), Tf(0.f), Idf(0.f), TfIdf(0.f) {}
+
+	/** Occurences of term in all tables */
+	int32 NumOfOccurences;
+
+	/** Count of tables, where is term used */
+	int32 NumOfTables;
+
+	/** Term frequency, occurences divided by count of all words */
+	float Tf;
+
+	/** Inverse document frequency, log of count of all tables divided by count of term tables */
+	float Idf;
+
+	float TfIdf;
+
+	/** Returns true, if term is used in any table */
+	bool IsValid() const { return NumOfTables > 0; }
+};
+
+/**
+ * Immutable state of dictionary, shared by all dictionary queries
+ * Snapshot is built on game thread by UDictionarySubsystem and it is never modified after it is published
+ * so any number of threads can correct words and pick keywords from it without locks
+ * When dictionary changes, new snapshot is built and swapped with the old one (copy-on-write)
+ * Queries hold the snapshot pointer for whole query, so they always see consistent data
+ */
+struct NATURALDIALOGSYSTEM_API FDictionarySnapshot
+{
+	FDictionarySnapshot()
+		: Dictionary(nullptr), NumOfWords(0), NumOfTables(0), Version(0) {}
+
+	/** Representation points to term table and table registry of snapshot, so the snapshot can't be copied */
+	FDictionarySnapshot(const FDictionarySnapshot&) = delete;
+	FDictionarySnapshot& operator=(const FDictionarySnapshot&) = delete;
+
+	/**
+	 * Starts building of snapshot, which continues after the base snapshot
+	 * Terms and tables of base are kept, so their ids stay valid in the new snapshot
+	 * Bound dictionary is kept, so it can be called on worker thread after BindDictionary(), or again to restart the build
+	 * @param BaseSnapshot - Currently published snapshot, can be nullptr
+	 */
+	void InitializeFrom(const FDictionarySnapshot* BaseSnapshot);
+
+	/** Binds empty dictionary representation to term table and table registry of snapshot */
+	void BindDictionary(UDictionaryRepresentation* InDictionary);
+
+	/**
+	 * Registers all words of table into snapshot dictionary, allowed only before snapshot is published
+	 * @param InTable - table which is parsed
+	 */
+	void RegisterWordsFromTable(const UDataTable* InTable);
+
+	/**
+	 * Copies words data of base snapshot dictionary, so only changed tables have to be registered
+	 * Must be called after InitializeFrom() with the same base and BindDictionary()
+	 * @return - False, if dictionary representation doesn't support copy
+	 */
+	bool CopyDictionaryFrom(const FDictionarySnapshot* BaseSnapshot);
+
+	/**
+	 * Registers already parsed words of table, allowed only before snapshot is published
+	 * @param InTable - Table of words
+	 * @param Words - Normalized terms of table, @see UNaturalDialogSystemLibrary::GetTableTerms()
+	 */
+	void RegisterTableTerms(const UDataTable* InTable, const TArray<FString>& Words);
+
+	/**
+	 * Removes words of table from snapshot dictionary, allowed only before snapshot is published
+	 * Terms and table index stay registered, so already generated ids are still valid
+	 * @param InTable - Table of words
+	 * @param Words - The same terms of table, which were registered
+	 * @return - False, if dictionary representation doesn't support removing of words
+	 */
+	bool UnregisterTableTerms(const UDataTable* InTable, const TArray<FString>& Words);
+
+	/** Counts term occurences of all terms from dictionary, used when dictionary was loaded without words registration */
+	void RebuildTermCounts();
+
+	/** Computes Tf, Idf and TfIdf of all terms from current counts, must be called before snapshot is published */
+	void UpdateTermWeights();
+
+	/** Finalizes dictionary representation and computes term weights, must be called before snapshot is published */
+	void FinishBuild();
+
+	/** Returns precomputed weights of term, nullptr if term is not used in any table */
+	const FDictionaryTermWeight* GetTermWeight(const uint32 TermId) const
+	{
+		const int32 TermIndex = static_cast<int32>(TermId);
+		return TermWeights.IsValidIndex(TermIndex) && TermWeights[TermIndex].IsValid() ? &TermWeights[TermIndex] : nullptr;
+	}
+
+	/** Returns dictionary representation of snapshot */
+	const UDictionaryRepresentation* GetDictionary() const { return Dictionary; }
+
+	/** Returns count of all registered words, at least 1, so it can be used as divider */
+	int32 GetNumOfWords() const { return FMath::Max(NumOfWords, 1); }
+
+	/** Returns count of tables from which the dictionary was built */
+	int32 GetNumOfTables() const { return NumOfTables; }
+
+	/** Every registered word gets dense id in this table */
+	FDictionaryTermTable TermTable;
+
+	/** Every table with registered words gets dense index in this registry */
+	FDictionaryTableRegistry TableRegistry;
+
+	/** Dictionary data of snapshot, lifetime of the object is handled by UDictionarySubsystem */
+	UDictionaryRepresentation* Dictionary;
+
+	/** Count of all registered words (with repetitions), used as term frequency divider */
+	int32 NumOfWords;
+
+	/** Count of tables from which the dictionary was built */
+	int32 NumOfTables;
+
+	/** Keyword weights for every term id, @see GetTermWeight() */
+	TArray<FDictionaryTermWeight> TermWeights;
+
+	/** Incremented with every published snapshot */
+	uint32 Version;
+};
+
+typedef TSharedPtr<const FDictionarySnapshot, ESPMode::ThreadSafe> FDictionarySnapshotPtr;
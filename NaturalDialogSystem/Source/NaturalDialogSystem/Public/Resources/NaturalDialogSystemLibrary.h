@@ -1,114 +1,177 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Kismet/BlueprintFunctionLibrary.h"
-#include "NaturalDialogSystemLibrary.generated.h"
-
-#define NULL_CHARACTER 0
-#define SPACE_CHARACTER 32
-#define TAG_CHARACTER 36
-#define A_CHARACTER 65
-
-/**
- * 
- */
-UCLASS()
-class NATURALDIALOGSYSTEM_API UNaturalDialogSystemLibrary : public UBlueprintFunctionLibrary
-{
-	GENERATED_BODY()
-
-
-public:
-	/**
-	 * Returns list of all data tables in a game, with dialog struct
-	 * @warning - for optimization, cache this data, because this list all assets in project content, that's mean this is slow operation
-	 */
-	static TSet<UDataTable*> GetListOfDialogDataTables();
-
-	static TArray<FString> SplitSentenceIntoNormalizedTerms(const FString& Input);
-	
-	static FString NormalizeTerm(const FString& Input);
-
-	static TArray<FString> SplitToSentences(const FString& Input);
-
-	UFUNCTION(BlueprintCallable, BlueprintPure)
-	static FString NormalizeWord(const FString& Input);
-	
-private:
-	static CHAR NormalizeCharacter(CHAR Character);
-	
-	/** Returns true, if character equals to any special character */
-	FORCEINLINE static bool IsSpecialChar(const TCHAR Character) { return Character < A_CHARACTER; }
-	/** Returns true, if character equals to any special character */
-	FORCEINLINE static bool IsSpaceChar(const TCHAR Character) { return Character == SPACE_CHARACTER; }
-	/** Returns true, if character equals to $ */
-	FORCEINLINE static bool IsTagCharacter(const TCHAR Character) { return Character == TAG_CHARACTER; }
-	/** Returns true, if character equals to .!? */
-	FORCEINLINE static bool IsSentenceSeparator(const TCHAR Character) { return Character == 33 || Character == 46 || Character == 63; }
-	
-	/**
-	 * Find all assets of the given type recursively in project content folder
-	 * @return - List of found assets references (like data tables, materials, textures, ...)
-	 */
-	template<typename T>
-	static TArray<T*> GetListOfContentObjects_Recursive();
-
-	/**
-	 * Find asset by given file in project content folder
-	 * @param File - File which we want to find in assets in format (Path/File)
-	 * @return - Find result of assets reference (like data table, material, texture, ...)
-	 */
-	template<class T>
-	static T* GetElementDataTable(const FString& File);
-};
-
-template<typename T>
-TArray<T*> UNaturalDialogSystemLibrary::GetListOfContentObjects_Recursive()
-{
-	TArray<T*> Result;
-	Result.Reserve(10);
-
-	const FString ElementsDir = FPaths::ProjectContentDir();
-
-	TArray<FString> OutAssets;
-	IFileManager::Get().FindFilesRecursive(OutAssets, *ElementsDir, TEXT("*"), true, false);
-
-	for (const FString& AssetName : OutAssets)
-	{
-		T* LoadedAsset = GetElementDataTable<T>(AssetName);
-		if (LoadedAsset)
-		{
-			Result.Add(LoadedAsset);
-		}
-	}
-
-	return Result;
-}
-
-template<class T>
-T* UNaturalDialogSystemLibrary::GetElementDataTable(const FString& File)
-{
-	FString FileName;
-	FString FilePath;
-
-	int32 DotPosition = -1;
-	if (File.FindLastChar('/', DotPosition))
-	{
-		FilePath = File.Left(DotPosition);
-		FileName = File.Right(File.Len() - DotPosition - 1);
-	}
-
-	const int32 Index = FilePath.Find(TEXT("Content"));
-	FilePath.RightInline(FilePath.Len() - Index - 8);
-
-	if (FileName.FindChar('.', DotPosition))
-	{
-		FileName.LeftInline(DotPosition);
-	}
-
-	const FString FullName = FPaths::Combine(TEXT("/Game"), FilePath, FileName) + TEXT(".") + FileName;
-	UObject* Object = StaticLoadObject(UObject::StaticClass(), nullptr, *FullName);
-	return Cast<T>(Object);
-}
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "NaturalDialogSystemLibrary.generated.h"
+
+#define NULL_CHARACTER 0
+#define SPACE_CHARACTER 32
+#define TAG_CHARACTER 36
+#define A_CHARACTER 65
+
+/**
+ * Word of normalized text, @see UNaturalDialogSystemLibrary::NormalizeIntoBuffer()
+ */
+struct FNormalizedWord
+{
+	/** Index of the first character of word in buffer of normalized characters */
+	int32 Start;
+
+	/** Num of characters of word */
+	int32 Len;
+};
+
+/**
+ * Normalized text split into words, characters of all words are stored in one contiguous buffer
+ * Words are returned as views into this buffer, so they are valid until text is normalized again or reset
+ */
+struct NATURALDIALOGSYSTEM_API FNormalizedText
+{
+	/** Replaces content by normalized input, memory of previous content is reused */
+	void Normalize(const FStringView& Input);
+
+	/** Appends normalized words of input after the current words */
+	void Append(const FStringView& Input);
+
+	/**
+	 * Removes all words, memory is kept for the next normalization
+	 * @param MaxKeptChars - When buffer of characters is larger, memory is released
+	 */
+	void Reset(const int32 MaxKeptChars = MAX_int32);
+
+	/** Returns num of normalized words */
+	FORCEINLINE int32 Num() const { return Words.Num(); }
+
+	/** Returns word at index, view is valid until text is changed */
+	FORCEINLINE FStringView GetWord(const int32 Index) const { return FStringView(Chars.GetData() + Words[Index].Start, Words[Index].Len); }
+
+	/** Returns all words without separators, this is the same as UNaturalDialogSystemLibrary::NormalizeTerm() */
+	FORCEINLINE FStringView GetText() const { return FStringView(Chars.GetData(), Chars.Num()); }
+
+	/** Appends all words separated by separator to output string */
+	void JoinTo(FString& Output, const TCHAR Separator) const;
+
+	/** Returns allocated memory in bytes */
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return Chars.GetAllocatedSize() + Words.GetAllocatedSize(); }
+
+private:
+	TArray<TCHAR> Chars;
+	TArray<FNormalizedWord> Words;
+};
+
+/**
+ * Normalized text borrowed from per thread pool of scratch buffers
+ * Buffer is returned to pool at the end of scope, so the next normalization on the same thread doesn't allocate memory
+ * Scopes can be nested, every nested scope takes its own buffer
+ */
+class NATURALDIALOGSYSTEM_API FScopedNormalizedText
+{
+public:
+	explicit FScopedNormalizedText(const FStringView& Input);
+	~FScopedNormalizedText();
+
+	FORCEINLINE const FNormalizedText& operator*() const { return *Text; }
+	FORCEINLINE const FNormalizedText* operator->() const { return Text; }
+
+private:
+	UE_NONCOPYABLE(FScopedNormalizedText);
+
+	/** Buffer owned by pool of the current thread */
+	FNormalizedText* Text;
+};
+
+/**
+ * 
+ */
+UCLASS()
+class NATURALDIALOGSYSTEM_API UNaturalDialogSystemLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+
+public:
+	/**
+	 * Returns list of all data tables in a game, with dialog struct
+	 * @warning - for optimization, cache this data, because this queries all data tables in project content from asset registry
+	 */
+	static TSet<UDataTable*> GetListOfDialogDataTables();
+
+	/**
+	 * Returns list of all data tables in a game, with dialog struct
+	 * Tables are found by row structure tag in asset registry, so only dialog tables are loaded into memory
+	 * @param OutNumOfScannedAssets - Num of data table assets, which were checked in asset registry
+	 * @param OutNumOfLoadedAssets - Num of assets, which had to be loaded (dialog tables and tables without row structure tag)
+	 */
+	static TSet<UDataTable*> GetListOfDialogDataTables(int32& OutNumOfScannedAssets, int32& OutNumOfLoadedAssets);
+
+	/**
+	 * Returns all normalized terms of the dialog table (asks, answers and keywords of all rows)
+	 * These terms are registered into dictionary representation
+	 * @param InTable - Dialog table, which is parsed
+	 */
+	static TArray<FString> GetTableTerms(const UDataTable* InTable);
+
+	/**
+	 * Normalizes input and splits it into words, words are not allocated
+	 * ASCII characters are processed in blocks of 16 characters by SSE2 or NEON, other characters are normalized one by one
+	 * @param Input - Text to normalize
+	 * @param InputLen - Num of characters of input
+	 * @param OutChars - Normalized characters of all words are appended into this buffer, words are not separated
+	 * @param OutWords - Position of every word in OutChars is appended into this buffer
+	 */
+	static void NormalizeIntoBuffer(const TCHAR* Input, const int32 InputLen, TArray<TCHAR>& OutChars, TArray<FNormalizedWord>& OutWords);
+
+	static TArray<FString> SplitSentenceIntoNormalizedTerms(const FString& Input);
+	
+	static FString NormalizeTerm(const FString& Input);
+
+	static TArray<FString> SplitToSentences(const FString& Input);
+
+	/**
+	 * Splits input into sentences, @see SplitToSentences()
+	 * @param Input - Text to split, sentences are views into this text
+	 * @param OutSentences - Sentences are appended into this array, separator .!? is the last character of sentence
+	 */
+	static void SplitToSentences(const FStringView& Input, TArray<FStringView>& OutSentences);
+
+	/**
+	 * Splits input by spaces, empty words are skipped, the same as UKismetStringLibrary::ParseIntoArray(Input, TEXT(" "), true)
+	 * @param Input - Text to split, words are views into this text
+	 * @param OutWords - Words are appended into this array
+	 */
+	static void SplitToWords(const FStringView& Input, TArray<FStringView>& OutWords);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	static FString NormalizeWord(const FString& Input);
+	
+private:
+	/**
+	 * Normalizes one character, the same rules are used for all languages
+	 * ASCII characters < 'A' except of $ are removed, letters are lowercased, spaces and sentence separators of any script split words
+	 * Numbers, punctuation, symbols and control characters of other scripts are removed too, marks stay part of word
+	 * @param Character - Character to normalize
+	 * @return - Lowercased character of word, SPACE_CHARACTER if character splits words, or NULL_CHARACTER if character is removed
+	 */
+	static TCHAR NormalizeCharacter(const TCHAR Character);
+
+	/**
+	 * Returns lookup table of NormalizeCharacter() results for all 64K UTF-16 code units, so normalization is one load per character
+	 * Table is built at first use, letters are folded to base letters without diacritics (e.g. U+00E1 -> a), if it is enabled in settings
+	 */
+	static const TCHAR* GetNormalizationTable();
+	
+	/** Returns true, if character equals to any special character */
+	FORCEINLINE static bool IsSpecialChar(const TCHAR Character) { return Character < A_CHARACTER; }
+	/** Returns true, if character equals to any special character */
+	FORCEINLINE static bool IsSpaceChar(const TCHAR Character) { return Character == SPACE_CHARACTER; }
+	/** Returns true, if character equals to $ */
+	FORCEINLINE static bool IsTagCharacter(const TCHAR Character) { return Character == TAG_CHARACTER; }
+	/** Returns true, if character equals to .!? */
+	FORCEINLINE static bool IsSentenceSeparator(const TCHAR Character) { return Character == 33 || Character == 46 || Character == 63; }
+
+	/** Returns names of all row structs, which are child of FNaturalDialogRow */
+	static TSet<FName> GetDialogRowStructNames();
+};
@@ -1,403 +1,661 @@
-// Created by Michal Chamula. All rights reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Engine/DataTable.h"
-#include "Sound/DialogueWave.h"
-#include "Resources.generated.h"
-
-class AController;
-class UNaturalDialogTask;
-class UPlayerNaturalDialogComponent;
-class UNpcNaturalDialogComponent;
-
-#define MAX_MATRIX_SPARSE_VALUE 0.15f
-#define MAX_LEN_DIFF 3
-
-// For more information see #FDialogMetricRow definition
-#define CREATE_MATRIX_VECTOR { 1.f, FMath::FRandRange(1.f - MAX_MATRIX_SPARSE_VALUE, 1.f + MAX_MATRIX_SPARSE_VALUE) }
-
-/**
-* @Key - Data table where is keyword found
-*/
-using FKeywordsData = TMap<const UDataTable*, TArray<FName>>;
-
-
-//using FDialogMetricRow = TMap<FName, TArray<float>>;
-using FDialogMetric = TMap<const UDataTable*, struct FDialogMetricRow>;
-
-
-#define MIN_KEYWORDS_COUNT 3
-
-struct FDialogMetricRow
-{
-	FDialogMetricRow()
-		: Dummy(0)
-	{
-		Values.Reserve(20);
-	}
-
-	void Add(const FName InNewRowName, const int32 NumOfAnswers)
-	{
-		Values.SetNum(NumOfAnswers);
-		for (int32 i = 0; i < NumOfAnswers; i++)
-		{
-			Values[i].Add(InNewRowName, CREATE_MATRIX_VECTOR);
-		}
-	}
-
-	/**
-	 * Returns eval value of the table replies data
-	 * #todo ... improve the algorithm !!!
-	 */
-	float GetEvalValue(const FName EvalName, const int32 AnswerIndex) const
-	{
-		if (Values.IsValidIndex(AnswerIndex))
-		{
-			float Result = 1.f;
-
-			const TArray<float>* FoundRow = Values[AnswerIndex].Find(EvalName);
-			if (FoundRow)
-			{
-				for (const float InValue : *FoundRow)
-				{
-					Result *= InValue;
-				}
-			}
-
-			return Result;
-		}
-
-		return Dummy;
-	}
-
-	TArray<float*> GetAllWearinessValues()
-	{
-		TArray<float*> Result;
-		for (int32 i = 0; i < Values.Num(); i++)
-		{
-			for (TPair<FName, TArray<float>>& InPair : Values[i])
-			{
-				Result.Add(&InPair.Value[0]);
-			}
-		}
-		return Result;
-	}
-
-	float& GetWearinessValueRef(const FName RowName, const int32 AnswerIndex)
-	{
-		if (Values.IsValidIndex(AnswerIndex))
-		{
-			TArray<float>* FoundRow = Values[AnswerIndex].Find(RowName);
-			return FoundRow ? (*FoundRow)[0] : Dummy;
-		}
-
-		return Dummy;
-	}
-
-	int32 GetNumOfAnswers() const
-	{
-		return Values.Num();
-	}
-
-private:
-	/**
-	 * Used for metric presentation
-	 * Map values is a vector of properties
-	 * 
-	 * Elements explanation:
-	 * 1. Array of answers with properties:
-	 * -------------------------
-	 * 1. element - weariness value (the more is answer used, the smaller the value is)
-	 * 2. element - randomize value (should be changed in every response)
-	 * 3. ...
-	 */
-	TArray<TMap<FName, TArray<float>>> Values;
-
-	float Dummy;
-};
-
-USTRUCT(BlueprintType, Blueprintable)
-struct FNaturalDialogResult
-{
-	GENERATED_BODY()
-
-	FNaturalDialogResult()
-		: Table(nullptr), AnswerIndex(0) {}
-
-	FNaturalDialogResult(const UDataTable* InTable, const FName InRowName, const int32 InAnswerIndex)
-		: Table(InTable), RowName(InRowName), AnswerIndex(InAnswerIndex) {}
-	
-	const UDataTable* Table;
-	FName RowName;
-	int32 AnswerIndex;
-};
-
-USTRUCT(BlueprintType, Blueprintable)
-struct FNaturalDialogAnswer
-{
-	GENERATED_BODY()
-
-	FNaturalDialogAnswer() {}
-
-	FNaturalDialogAnswer(const FText& InText)
-		: Answer(InText) {}
-
-	/** Text answer representation for player question */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	FText Answer;
-
-	/**
-	* When answer is used, the sound is played as dialog wave
-	* Dialog can be used for many NPCs in game with different voices
-	* Key - Define the actor of voice
-	* Value - The voice of an actor, which is used
-	*/
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TMap<TSoftClassPtr<AActor>, TSoftObjectPtr<UDialogueWave>> AnswerWave;
-};
-
-/**
-* Struct used for table data with only answer
-* It is used in NaturalDialogSystemComponent
-* May contains data with invalid replies
-*/
-USTRUCT(Blueprintable, BlueprintType)
-struct FNaturalDialogRow_Base : public FTableRowBase
-{
-	GENERATED_BODY()
-
-	FNaturalDialogRow_Base() {};
-
-	FNaturalDialogRow_Base(const FText& InText)
-	{
-		Answer.Add(InText);
-	}
-
-	/** Define answer to ask, which can be replied to player */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FNaturalDialogAnswer> Answer;
-};
-
-UENUM(BlueprintType)
-enum class EDialogTableAction : uint8
-{
-	Add,
-	Remove
-};
-
-USTRUCT(BlueprintType)
-struct FNaturalDialogTableAction
-{
-	GENERATED_BODY()
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	EDialogTableAction Action;
-	
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	UDataTable* DialogTable;
-};
-
-/**
- * Struct used for table data for natural dialog system
- * Use for data table asset, to make new dialog data library for NPC
- */
-USTRUCT(Blueprintable, BlueprintType)
-struct FNaturalDialogRow : public FNaturalDialogRow_Base
-{
-	GENERATED_BODY()
-
-	FNaturalDialogRow() {};
-
-	FNaturalDialogRow(const FText& InText);
-
-	FNaturalDialogRow(const FNaturalDialogRow_Base& Other);
-
-	/** Define the ask, which is known for NPCs */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	FText Ask;
-
-	/** Tasks will be executed, when NPC reply row answer */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<TSoftClassPtr<UNaturalDialogTask>> DialogTasks;
-	
-	/** When row is used as answer, these dialog tables are registered in UPlayerNaturalDialogComponent */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FNaturalDialogTableAction> DialogTables;
-};
-
-USTRUCT(Blueprintable)
-struct FNaturalDialogRow_Keyword : public FNaturalDialogRow
-{
-	GENERATED_BODY()
-
-	/** Keywords to match with ask */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FText> Keywords;
-	
-	/** To avoid wrong replies define how many keywords are needed to match this reply */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	int32 MinKeywordsMatch = 3;
-};
-
-/**
- * Used in dictionary subsystem, it holds all data of one word
- */
-USTRUCT()
-struct FDictionaryData
-{
-	GENERATED_BODY()
-
-	FDictionaryData() {}
-
-	FDictionaryData(const UDataTable* InDataTable)
-	{
-		AddOccurence(InDataTable);
-	}
-
-	void AddOccurence(const UDataTable* InDataTable)
-	{
-		NumOfWords++;
-
-		int32* TableOccurenceValue = TableOccurence.Find(InDataTable);
-		if (TableOccurenceValue)
-		{
-			*TableOccurenceValue += 1;
-		}
-		else
-		{
-			TableOccurence.Add(InDataTable, 1);
-		}
-	}
-
-	/** Get num of all tables where term is found */
-	int32 GetTableOccurenceCount() const { return TableOccurence.Num(); }
-
-	/** Return count of all words in system */
-	static int32 GetNumOfWords() { return FDictionaryData::NumOfWords; }
-
-	/** Returns set of tables where term is found */
-	TSet<const UDataTable*> GetTables() const
-	{
-		TArray<const UDataTable*> Result;
-		TableOccurence.GetKeys(Result);
-		return TSet<const UDataTable*>(Result);
-	}
-
-	/** Returns term occurence in data table */
-	int32 GetOccurenceCount(const UDataTable* InDataTable) const
-	{
-		const int32* TableOccurenceValue = TableOccurence.Find(InDataTable);
-		if (TableOccurenceValue)
-		{
-			return *TableOccurenceValue;
-		}
-		return 0;
-	}
-
-	/** Used for UDictionarySubsystem, after game restarts */
-	static void ResetNumOfWords() { FDictionaryData::NumOfWords = 0; }
-
-private:
-	UPROPERTY()
-	TMap<const UDataTable*, int32> TableOccurence;
-
-	static int32 NumOfWords;
-};
-
-struct FReplyData
-{
-	FReplyData()
-		: NumOfMatchedKeywords(0), InTable(nullptr), AnswerIndex(0), AbsoluteError(0) {}
-
-	FReplyData(const UDataTable* InDataTable)
-		: NumOfMatchedKeywords(0), InTable(InDataTable), AnswerIndex(0), AbsoluteError(0) {}
-
-	FReplyData(const int32 KeywordsMatchCount, const UDataTable* InDataTable, const FName InRow, int32 InAnswerIndex, int32 InAbsoluteError)
-		: NumOfMatchedKeywords(KeywordsMatchCount), InTable(InDataTable), RowName(InRow), AnswerIndex(InAnswerIndex), AbsoluteError(InAbsoluteError) {};
-
-	int NumOfMatchedKeywords;
-	const UDataTable* InTable;
-	FName RowName;
-	int32 AnswerIndex;
-	int32 AbsoluteError;
-
-
-	inline bool operator==(const FReplyData& Other) const { return InTable == Other.InTable; }
-
-	inline bool operator<(const FReplyData& Other) const { return NumOfMatchedKeywords < Other.NumOfMatchedKeywords; }
-
-	__forceinline bool IsValid() const
-	{
-		return InTable && !RowName.IsNone();
-	}
-	// void operator=(const FReplyData& Other)
-	// {
-	// 	NumOfMatchedKeywords = Other.NumOfMatchedKeywords;
-	// 	InTable = Other.InTable;
-	// 	RowName = Other.RowName;
-	// }
-};
-
-/**
- * Struct contains data about player character data
- * Used as param in dialog task, there are stored important references for function ExecuteTask()
- * Can be get from NaturalDialogTask object using function GetPlayerData()
- */
-USTRUCT(BlueprintType)
-struct FDialogTaskPlayerData
-{
-	GENERATED_BODY()
-
-	FDialogTaskPlayerData();
-
-	explicit FDialogTaskPlayerData(APlayerController* InPlayerController);
-
-	/** Reference to the player character, which is asking for reply */
-	UPROPERTY(BlueprintReadOnly)
-	APawn* PlayerPawn;
-
-	/** Reference to the player natural dialog component, which is asking for reply */
-	UPROPERTY(BlueprintReadOnly)
-	UPlayerNaturalDialogComponent* NaturalDialogSystemComponent;
-
-	/** Reference to the player controller, which is asking for reply */
-	UPROPERTY(BlueprintReadOnly)
-	APlayerController* PlayerController;
-
-	/** Reference to the player state, which is asking for reply */
-	UPROPERTY(BlueprintReadOnly)
-	APlayerState* PlayerState;
-
-	bool IsValid() const;
-};
-
-/**
- * Struct contains data about task owner character
- * Used as param in dialog task, there are stored important references for function ExecuteTask()
- * Can be get from NaturalDialogTask object using function GetNPCData()
- */
-USTRUCT(BlueprintType)
-struct FDialogTaskNPCData
-{
-	GENERATED_BODY()
-
-	FDialogTaskNPCData();
-
-	explicit FDialogTaskNPCData(AActor* InOwningActor);
-
-	/** Reference to the task creator */
-	UPROPERTY(BlueprintReadOnly)
-	AActor* OwningActor;
-
-	/** Reference to the task creator */
-	UPROPERTY(BlueprintReadOnly)
-	AController* OwningController;
-
-	/** Reference to the task component, where task was created from */
-	UPROPERTY(BlueprintReadOnly)
-	UNpcNaturalDialogComponent* NaturalDialogSystemComponent;
-
-	bool IsValid() const;
-};
+// Created by Michal Chamula. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Sound/DialogueWave.h"
+#include "Resources.generated.h"
+
+class AController;
+class UNaturalDialogTask;
+class UPlayerNaturalDialogComponent;
+class UNpcNaturalDialogComponent;
+
+#define MAX_MATRIX_SPARSE_VALUE 0.15f
+#define MAX_LEN_DIFF 3
+
+// For more information see #FDialogMetricRow definition
+#define CREATE_MATRIX_VECTOR { 1.f, FMath::FRandRange(1.f - MAX_MATRIX_SPARSE_VALUE, 1.f + MAX_MATRIX_SPARSE_VALUE) }
+
+/**
+* @Key - Data table where is keyword found
+*/
+using FKeywordsData = TMap<const UDataTable*, TArray<FName>>;
+
+
+//using FDialogMetricRow = TMap<FName, TArray<float>>;
+using FDialogMetric = TMap<const UDataTable*, struct FDialogMetricRow>;
+
+
+#define MIN_KEYWORDS_COUNT 3
+
+/** Term id of word, which is not registered in dictionary term table */
+#define INVALID_TERM_ID MAX_uint32
+
+struct FDialogMetricRow
+{
+	FDialogMetricRow()
+		: Dummy(0)
+	{
+		Values.Reserve(20);
+	}
+
+	void Add(const FName InNewRowName, const int32 NumOfAnswers)
+	{
+		Values.SetNum(NumOfAnswers);
+		for (int32 i = 0; i < NumOfAnswers; i++)
+		{
+			Values[i].Add(InNewRowName, CREATE_MATRIX_VECTOR);
+		}
+	}
+
+	/**
+	 * Returns eval value of the table replies data
+	 * #todo ... improve the algorithm !!!
+	 */
+	float GetEvalValue(const FName EvalName, const int32 AnswerIndex) const
+	{
+		if (Values.IsValidIndex(AnswerIndex))
+		{
+			float Result = 1.f;
+
+			const TArray<float>* FoundRow = Values[AnswerIndex].Find(EvalName);
+			if (FoundRow)
+			{
+				for (const float InValue : *FoundRow)
+				{
+					Result *= InValue;
+				}
+			}
+
+			return Result;
+		}
+
+		return Dummy;
+	}
+
+	TArray<float*> GetAllWearinessValues()
+	{
+		TArray<float*> Result;
+		for (int32 i = 0; i < Values.Num(); i++)
+		{
+			for (TPair<FName, TArray<float>>& InPair : Values[i])
+			{
+				Result.Add(&InPair.Value[0]);
+			}
+		}
+		return Result;
+	}
+
+	float& GetWearinessValueRef(const FName RowName, const int32 AnswerIndex)
+	{
+		if (Values.IsValidIndex(AnswerIndex))
+		{
+			TArray<float>* FoundRow = Values[AnswerIndex].Find(RowName);
+			return FoundRow ? (*FoundRow)[0] : Dummy;
+		}
+
+		return Dummy;
+	}
+
+	int32 GetNumOfAnswers() const
+	{
+		return Values.Num();
+	}
+
+private:
+	/**
+	 * Used for metric presentation
+	 * Map values is a vector of properties
+	 * 
+	 * Elements explanation:
+	 * 1. Array of answers with properties:
+	 * -------------------------
+	 * 1. element - weariness value (the more is answer used, the smaller the value is)
+	 * 2. element - randomize value (should be changed in every response)
+	 * 3. ...
+	 */
+	TArray<TMap<FName, TArray<float>>> Values;
+
+	float Dummy;
+};
+
+USTRUCT(BlueprintType, Blueprintable)
+struct FNaturalDialogResult
+{
+	GENERATED_BODY()
+
+	FNaturalDialogResult()
+		: Table(nullptr), AnswerIndex(0) {}
+
+	FNaturalDialogResult(const UDataTable* InTable, const FName InRowName, const int32 InAnswerIndex)
+		: Table(InTable), RowName(InRowName), AnswerIndex(InAnswerIndex) {}
+	
+	const UDataTable* Table;
+	FName RowName;
+	int32 AnswerIndex;
+};
+
+USTRUCT(BlueprintType, Blueprintable)
+struct FNaturalDialogAnswer
+{
+	GENERATED_BODY()
+
+	FNaturalDialogAnswer() {}
+
+	FNaturalDialogAnswer(const FText& InText)
+		: Answer(InText) {}
+
+	/** Text answer representation for player question */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FText Answer;
+
+	/**
+	* When answer is used, the sound is played as dialog wave
+	* Dialog can be used for many NPCs in game with different voices
+	* Key - Define the actor of voice
+	* Value - The voice of an actor, which is used
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TMap<TSoftClassPtr<AActor>, TSoftObjectPtr<UDialogueWave>> AnswerWave;
+};
+
+/**
+* Struct used for table data with only answer
+* It is used in NaturalDialogSystemComponent
+* May contains data with invalid replies
+*/
+USTRUCT(Blueprintable, BlueprintType)
+struct FNaturalDialogRow_Base : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	FNaturalDialogRow_Base() {};
+
+	FNaturalDialogRow_Base(const FText& InText)
+	{
+		Answer.Add(InText);
+	}
+
+	/** Define answer to ask, which can be replied to player */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FNaturalDialogAnswer> Answer;
+};
+
+UENUM(BlueprintType)
+enum class EDialogTableAction : uint8
+{
+	Add,
+	Remove
+};
+
+USTRUCT(BlueprintType)
+struct FNaturalDialogTableAction
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	EDialogTableAction Action;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	UDataTable* DialogTable;
+};
+
+/**
+ * Struct used for table data for natural dialog system
+ * Use for data table asset, to make new dialog data library for NPC
+ */
+USTRUCT(Blueprintable, BlueprintType)
+struct FNaturalDialogRow : public FNaturalDialogRow_Base
+{
+	GENERATED_BODY()
+
+	FNaturalDialogRow() {};
+
+	FNaturalDialogRow(const FText& InText);
+
+	FNaturalDialogRow(const FNaturalDialogRow_Base& Other);
+
+	/** Define the ask, which is known for NPCs */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FText Ask;
+
+	/** Tasks will be executed, when NPC reply row answer */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<TSoftClassPtr<UNaturalDialogTask>> DialogTasks;
+	
+	/** When row is used as answer, these dialog tables are registered in UPlayerNaturalDialogComponent */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FNaturalDialogTableAction> DialogTables;
+};
+
+USTRUCT(Blueprintable)
+struct FNaturalDialogRow_Keyword : public FNaturalDialogRow
+{
+	GENERATED_BODY()
+
+	/** Keywords to match with ask */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FText> Keywords;
+	
+	/** To avoid wrong replies define how many keywords are needed to match this reply */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 MinKeywordsMatch = 3;
+};
+
+/**
+ * Used in dictionary subsystem, it holds all data of one word
+ * Tables are stored as bitset of dense table indexes, @see FDictionaryTableRegistry
+ * Occurence counts are stored only for set bits, in the order of table indexes
+ */
+USTRUCT()
+struct FDictionaryData
+{
+	GENERATED_BODY()
+
+	FDictionaryData() {}
+
+	explicit FDictionaryData(const int32 InTableIndex)
+	{
+		AddOccurence(InTableIndex);
+	}
+
+	FDictionaryData(const uint32 InTermId, const int32 InTableIndex)
+		: TermId(InTermId)
+	{
+		AddOccurence(InTableIndex);
+	}
+
+	/** Adds one occurence of term in table with dense index */
+	void AddOccurence(const int32 TableIndex)
+	{
+		AddTableOccurences(TableIndex, 1);
+	}
+
+	/**
+	 * Removes occurences of term in table with dense index
+	 * When the last occurence is removed, table is removed from term tables
+	 */
+	void RemoveOccurences(const int32 TableIndex, const int32 Count)
+	{
+		if (!IsInTable(TableIndex))
+		{
+			return;
+		}
+
+		const int32 Rank = GetTableRank(TableIndex);
+		TableCounts[Rank] -= Count;
+
+		if (TableCounts[Rank] <= 0)
+		{
+			TableBits[TableIndex / 64] &= ~(1ull << (TableIndex % 64));
+			TableCounts.RemoveAt(Rank);
+		}
+	}
+
+	/** Returns true, if term has no occurence in any table */
+	bool IsEmpty() const { return TableCounts.Num() == 0; }
+
+	/** Returns memory allocated by occurence data */
+	SIZE_T GetAllocatedSize() const { return TableBits.GetAllocatedSize() + TableCounts.GetAllocatedSize(); }
+
+	/** Returns id of term in dictionary term table, @see FDictionaryTermTable */
+	uint32 GetTermId() const { return TermId; }
+
+	/** Used by dictionary representation, when term id is known after data creation */
+	void SetTermId(const uint32 InTermId) { TermId = InTermId; }
+
+	/** Get num of all tables where term is found */
+	int32 GetTableOccurenceCount() const { return TableCounts.Num(); }
+
+	/** Returns true, if term is found in table with dense index */
+	bool IsInTable(const int32 TableIndex) const
+	{
+		const int32 WordIndex = TableIndex / 64;
+		return TableIndex >= 0 && WordIndex < TableBits.Num() && (TableBits[WordIndex] & (1ull << (TableIndex % 64))) != 0;
+	}
+
+	/** Returns term occurence in table with dense index */
+	int32 GetOccurenceCount(const int32 TableIndex) const
+	{
+		return IsInTable(TableIndex) ? TableCounts[GetTableRank(TableIndex)] : 0;
+	}
+
+	/** Returns term occurence in all tables */
+	int32 GetTotalOccurenceCount() const
+	{
+		int32 Result = 0;
+		for (const int32 Count : TableCounts)
+		{
+			Result += Count;
+		}
+		return Result;
+	}
+
+	/**
+	 * Returns bitset of tables where term is found, bit index is dense table index
+	 * Bitset can be shorter than count of registered tables, missing words are zero
+	 */
+	const TArray<uint64>& GetTableBits() const { return TableBits; }
+
+	/** Calls function with dense table index and occurence count for every table where term is found */
+	template <typename FunctionType>
+	void ForEachTable(FunctionType Function) const
+	{
+		int32 Rank = 0;
+		for (int32 WordIndex = 0; WordIndex < TableBits.Num(); WordIndex++)
+		{
+			for (uint64 Bits = TableBits[WordIndex]; Bits != 0; Bits &= Bits - 1)
+			{
+				const int32 TableIndex = WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Bits));
+				Function(TableIndex, TableCounts[Rank++]);
+			}
+		}
+	}
+
+	/**
+	 * Writes table occurences into prebuilt dictionary index
+	 * Tables are stored as index into tables of index, because it is independent on loaded objects
+	 * @param TableRemap - Index into tables of index for every dense table index
+	 */
+	void SaveOccurences(FArchive& Ar, const TArray<int32>& TableRemap) const
+	{
+		int32 NumOfTables = TableCounts.Num();
+		Ar << NumOfTables;
+
+		ForEachTable([&Ar, &TableRemap](const int32 TableIndex, int32 Count)
+		{
+			int32 IndexTableIndex = TableRemap.IsValidIndex(TableIndex) ? TableRemap[TableIndex] : INDEX_NONE;
+			Ar << IndexTableIndex << Count;
+		});
+	}
+
+	/**
+	 * Reads table occurences from prebuilt dictionary index, @see SaveOccurences()
+	 * @param TableRemap - Dense table index for every table of index
+	 */
+	void LoadOccurences(FArchive& Ar, const TArray<int32>& TableRemap)
+	{
+		int32 NumOfTables = 0;
+		Ar << NumOfTables;
+
+		TableBits.Reset();
+		TableCounts.Reset(NumOfTables);
+
+		for (int32 i = 0; i < NumOfTables && !Ar.IsError(); i++)
+		{
+			int32 IndexTableIndex = INDEX_NONE;
+			int32 Count = 0;
+			Ar << IndexTableIndex << Count;
+
+			if (TableRemap.IsValidIndex(IndexTableIndex))
+			{
+				AddTableOccurences(TableRemap[IndexTableIndex], Count);
+			}
+		}
+	}
+
+private:
+	/** Returns count of set bits before table index, it is index to TableCounts */
+	int32 GetTableRank(const int32 TableIndex) const
+	{
+		const int32 WordIndex = TableIndex / 64;
+		const int32 NumOfFullWords = FMath::Min(WordIndex, TableBits.Num());
+
+		int32 Rank = 0;
+		for (int32 i = 0; i < NumOfFullWords; i++)
+		{
+			Rank += FMath::CountBits(TableBits[i]);
+		}
+
+		if (WordIndex < TableBits.Num())
+		{
+			Rank += FMath::CountBits(TableBits[WordIndex] & ((1ull << (TableIndex % 64)) - 1));
+		}
+
+		return Rank;
+	}
+
+	void AddTableOccurences(const int32 TableIndex, const int32 Count)
+	{
+		if (TableIndex < 0)
+		{
+			return;
+		}
+
+		const int32 Rank = GetTableRank(TableIndex);
+		if (IsInTable(TableIndex))
+		{
+			TableCounts[Rank] += Count;
+			return;
+		}
+
+		const int32 WordIndex = TableIndex / 64;
+		if (TableBits.Num() <= WordIndex)
+		{
+			TableBits.SetNumZeroed(WordIndex + 1);
+		}
+
+		TableBits[WordIndex] |= 1ull << (TableIndex % 64);
+		TableCounts.Insert(Count, Rank);
+	}
+
+private:
+	/** Bit per dense table index, bit is set if term is found in table */
+	TArray<uint64> TableBits;
+
+	/** Occurence count for every set bit of TableBits, in the order of table indexes */
+	TArray<int32> TableCounts;
+
+	uint32 TermId = INVALID_TERM_ID;
+};
+
+/**
+ * Registry of dialog tables used by dictionary, owned by FDictionarySnapshot
+ * Every table gets dense index, which is used as bit index in FDictionaryData table bitsets
+ */
+struct FDictionaryTableRegistry
+{
+	/** Returns dense index of table, table is added when it is not registered yet */
+	int32 Register(const UDataTable* Table)
+	{
+		if (!Table)
+		{
+			return INDEX_NONE;
+		}
+
+		if (const int32* FoundIndex = TableIndexes.Find(Table))
+		{
+			return *FoundIndex;
+		}
+
+		const int32 NewIndex = Tables.Add(Table);
+		TableIndexes.Add(Table, NewIndex);
+		return NewIndex;
+	}
+
+	/** Returns dense index of table or INDEX_NONE, when table is not registered */
+	int32 Find(const UDataTable* Table) const
+	{
+		const int32* FoundIndex = TableIndexes.Find(Table);
+		return FoundIndex ? *FoundIndex : INDEX_NONE;
+	}
+
+	const UDataTable* GetTable(const int32 TableIndex) const { return Tables[TableIndex]; }
+
+	int32 Num() const { return Tables.Num(); }
+
+	/** Returns count of uint64 words of bitset, which can hold all registered tables */
+	int32 GetNumOfBitsetWords() const { return FMath::DivideAndRoundUp(Tables.Num(), 64); }
+
+	void Reset()
+	{
+		TableIndexes.Reset();
+		Tables.Reset();
+	}
+
+private:
+	TMap<const UDataTable*, int32> TableIndexes;
+	TArray<const UDataTable*> Tables;
+};
+
+/**
+ * Interning table of normalized dictionary terms, owned by FDictionarySnapshot
+ * Every term gets dense id at registration time, so after word correction
+ * keywords are compared as integers and their data are found by array indexing
+ */
+struct FDictionaryTermTable
+{
+	/** Returns id of term, term is added when it is not in table yet */
+	uint32 Intern(const FString& Term)
+	{
+		if (const uint32* FoundId = TermIds.Find(Term))
+		{
+			return *FoundId;
+		}
+
+		const uint32 NewId = Terms.Add(Term);
+		TermIds.Add(Term, NewId);
+		return NewId;
+	}
+
+	/** Returns id of term or INVALID_TERM_ID, when term is not registered */
+	uint32 Find(const FString& Term) const
+	{
+		const uint32* FoundId = TermIds.Find(Term);
+		return FoundId ? *FoundId : INVALID_TERM_ID;
+	}
+
+	bool IsValidId(const uint32 TermId) const { return TermId < static_cast<uint32>(Terms.Num()); }
+
+	/** Returns term of valid id, @see IsValidId() */
+	const FString& GetTerm(const uint32 TermId) const { return Terms[TermId]; }
+
+	int32 Num() const { return Terms.Num(); }
+
+	void Reset()
+	{
+		TermIds.Reset();
+		Terms.Reset();
+	}
+
+	/** Terms are stored in id order, so ids are the same after loading */
+	friend FArchive& operator<<(FArchive& Ar, FDictionaryTermTable& TermTable)
+	{
+		Ar << TermTable.Terms;
+
+		if (Ar.IsLoading())
+		{
+			TermTable.TermIds.Reset();
+			TermTable.TermIds.Reserve(TermTable.Terms.Num());
+
+			for (int32 i = 0; i < TermTable.Terms.Num(); i++)
+			{
+				TermTable.TermIds.Add(TermTable.Terms[i], i);
+			}
+		}
+
+		return Ar;
+	}
+
+private:
+	TMap<FString, uint32> TermIds;
+	TArray<FString> Terms;
+};
+
+struct FReplyData
+{
+	FReplyData()
+		: NumOfMatchedKeywords(0), InTable(nullptr), AnswerIndex(0), AbsoluteError(0) {}
+
+	FReplyData(const UDataTable* InDataTable)
+		: NumOfMatchedKeywords(0), InTable(InDataTable), AnswerIndex(0), AbsoluteError(0) {}
+
+	FReplyData(const int32 KeywordsMatchCount, const UDataTable* InDataTable, const FName InRow, int32 InAnswerIndex, int32 InAbsoluteError)
+		: NumOfMatchedKeywords(KeywordsMatchCount), InTable(InDataTable), RowName(InRow), AnswerIndex(InAnswerIndex), AbsoluteError(InAbsoluteError) {};
+
+	int NumOfMatchedKeywords;
+	const UDataTable* InTable;
+	FName RowName;
+	int32 AnswerIndex;
+	int32 AbsoluteError;
+
+
+	inline bool operator==(const FReplyData& Other) const { return InTable == Other.InTable; }
+
+	inline bool operator<(const FReplyData& Other) const { return NumOfMatchedKeywords < Other.NumOfMatchedKeywords; }
+
+	__forceinline bool IsValid() const
+	{
+		return InTable && !RowName.IsNone();
+	}
+	// void operator=(const FReplyData& Other)
+	// {
+	// 	NumOfMatchedKeywords = Other.NumOfMatchedKeywords;
+	// 	InTable = Other.InTable;
+	// 	RowName = Other.RowName;
+	// }
+};
+
+/**
+ * Struct contains data about player character data
+ * Used as param in dialog task, there are stored important references for function ExecuteTask()
+ * Can be get from NaturalDialogTask object using function GetPlayerData()
+ */
+USTRUCT(BlueprintType)
+struct FDialogTaskPlayerData
+{
+	GENERATED_BODY()
+
+	FDialogTaskPlayerData();
+
+	explicit FDialogTaskPlayerData(APlayerController* InPlayerController);
+
+	/** Reference to the player character, which is asking for reply */
+	UPROPERTY(BlueprintReadOnly)
+	APawn* PlayerPawn;
+
+	/** Reference to the player natural dialog component, which is asking for reply */
+	UPROPERTY(BlueprintReadOnly)
+	UPlayerNaturalDialogComponent* NaturalDialogSystemComponent;
+
+	/** Reference to the player controller, which is asking for reply */
+	UPROPERTY(BlueprintReadOnly)
+	APlayerController* PlayerController;
+
+	/** Reference to the player state, which is asking for reply */
+	UPROPERTY(BlueprintReadOnly)
+	APlayerState* PlayerState;
+
+	bool IsValid() const;
+};
+
+/**
+ * Struct contains data about task owner character
+ * Used as param in dialog task, there are stored important references for function ExecuteTask()
+ * Can be get from NaturalDialogTask object using function GetNPCData()
+ */
+USTRUCT(BlueprintType)
+struct FDialogTaskNPCData
+{
+	GENERATED_BODY()
+
+	FDialogTaskNPCData();
+
+	explicit FDialogTaskNPCData(AActor* InOwningActor);
+
+	/** Reference to the task creator */
+	UPROPERTY(BlueprintReadOnly)
+	AActor* OwningActor;
+
+	/** Reference to the task creator */
+	UPROPERTY(BlueprintReadOnly)
+	AController* OwningController;
+
+	/** Reference to the task component, where task was created from */
+	UPROPERTY(BlueprintReadOnly)
+	UNpcNaturalDialogComponent* NaturalDialogSystemComponent;
+
+	bool IsValid() const;
+};